@@ -0,0 +1,213 @@
+#ifndef BENCHHARNESS_HPP
+#define BENCHHARNESS_HPP
+
+// Minimal Google Benchmark-style harness, so the benchmarks build with
+// nothing but the project's own sources.
+//
+//   static void BM_Push(BenchState &state) {
+//       ...setup...
+//       for (auto _ : state) { ...timed body... }
+//       state.setBytesProcessed(state.iterations() * bytesPerIteration);
+//   }
+//   BENCHMARK(BM_Push);
+//   int main(int argc, char *argv[]) { return runBenchmarks(argc, argv); }
+//
+// Each benchmark is rerun with a growing iteration count until one run
+// takes at least --min-time seconds; only the loop is timed. Results go to
+// stdout as a table and, with --json <path>, to a JSON file.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BENCH_UNUSED __attribute__((unused))
+#else
+#define BENCH_UNUSED
+#endif
+
+class BenchState {
+    public:
+        explicit BenchState(uint64_t iterations) : iterations_(iterations), bytes_(0), items_(0) {}
+
+        // Loop variable type; marked unused so `for (auto _ : state)` does
+        // not warn.
+        struct BENCH_UNUSED Value {};
+
+        struct Iterator {
+            BenchState *state;
+            uint64_t left;
+            bool operator!=(const Iterator &) {
+                if (left != 0)
+                    return true;
+                state->stop_ = std::chrono::steady_clock::now();
+                return false;
+            }
+            void operator++() { left--; }
+            Value operator*() const { return Value(); }
+        };
+
+        Iterator begin() {
+            start_ = std::chrono::steady_clock::now();
+            return Iterator{this, iterations_};
+        }
+        Iterator end() { return Iterator{this, 0}; }
+
+        uint64_t iterations() const { return iterations_; }
+        double seconds() const { return std::chrono::duration<double>(stop_ - start_).count(); }
+        void setBytesProcessed(uint64_t bytes) { bytes_ = bytes; }
+        void setItemsProcessed(uint64_t items) { items_ = items; }
+        uint64_t bytesProcessed() const { return bytes_; }
+        uint64_t itemsProcessed() const { return items_; }
+    private:
+        uint64_t iterations_;
+        uint64_t bytes_;
+        uint64_t items_;
+        std::chrono::steady_clock::time_point start_;
+        std::chrono::steady_clock::time_point stop_;
+};
+
+using BenchFunction = void (*)(BenchState &);
+
+struct BenchEntry {
+    const char *name;
+    BenchFunction fn;
+};
+
+inline std::vector<BenchEntry> &benchRegistry() {
+    static std::vector<BenchEntry> entries;
+    return entries;
+}
+
+struct BenchRegistrar {
+    BenchRegistrar(const char *name, BenchFunction fn) { benchRegistry().push_back({name, fn}); }
+};
+
+#define BENCHMARK(fn) static BenchRegistrar fn##_registrar(#fn, fn)
+
+// Peak resident set size of the process in bytes.
+inline uint64_t peakRssBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return static_cast<uint64_t>(pmc.PeakWorkingSetSize);
+    return 0;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+inline std::string jsonEscape(const std::string &s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        if (static_cast<unsigned char>(c) < 0x20)
+            continue;
+        out += c;
+    }
+    return out;
+}
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations = 0;
+    double nsPerOp = 0.0;
+    double bytesPerSecond = 0.0;
+    double itemsPerSecond = 0.0;
+};
+
+inline int runBenchmarks(int argc, char *argv[]) {
+    std::string jsonPath;
+    std::string filter;
+    double minTime = 0.5;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (arg == "--filter" && i + 1 < argc)
+            filter = argv[++i];
+        else if (arg == "--min-time" && i + 1 < argc)
+            minTime = std::max(0.01, std::atof(argv[++i]));
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter <substring>] [--min-time <s>] [--json <path>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    std::printf("%-36s %14s %14s %14s\n", "benchmark", "iterations", "ns/op", "MB/s | items/s");
+    for (const BenchEntry &entry : benchRegistry()) {
+        if (!filter.empty() && std::strstr(entry.name, filter.c_str()) == nullptr)
+            continue;
+        uint64_t iterations = 1;
+        for (;;) {
+            BenchState state(iterations);
+            entry.fn(state);
+            double seconds = state.seconds();
+            if (seconds >= minTime || iterations >= 1000000000ull) {
+                BenchResult r;
+                r.name = entry.name;
+                r.iterations = iterations;
+                r.nsPerOp = seconds * 1e9 / static_cast<double>(iterations);
+                r.bytesPerSecond = seconds > 0.0 ? state.bytesProcessed() / seconds : 0.0;
+                r.itemsPerSecond = seconds > 0.0 ? state.itemsProcessed() / seconds : 0.0;
+                results.push_back(r);
+                break;
+            }
+            // Aim 40% past the target so the next run is normally the last.
+            double scale = seconds > 0.0 ? minTime * 1.4 / seconds : 100.0;
+            iterations = static_cast<uint64_t>(iterations * std::min(100.0, std::max(2.0, scale)));
+        }
+        const BenchResult &r = results.back();
+        char rate[32] = "";
+        if (r.bytesPerSecond > 0.0)
+            std::snprintf(rate, sizeof(rate), "%.1f MB/s", r.bytesPerSecond / 1e6);
+        else if (r.itemsPerSecond > 0.0)
+            std::snprintf(rate, sizeof(rate), "%.3g/s", r.itemsPerSecond);
+        std::printf("%-36s %14llu %14.1f %14s\n", r.name.c_str(), static_cast<unsigned long long>(r.iterations),
+                    r.nsPerOp, rate);
+    }
+
+    if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        if (!out.is_open()) {
+            std::cerr << "Failed to write " << jsonPath << std::endl;
+            return 1;
+        }
+        out << "{\n  \"peak_rss_bytes\": " << peakRssBytes() << ",\n  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchResult &r = results[i];
+            out << (i ? ",\n" : "\n") << "    {\"name\": \"" << jsonEscape(r.name) << "\", \"iterations\": "
+                << r.iterations << ", \"ns_per_op\": " << r.nsPerOp << ", \"bytes_per_second\": "
+                << r.bytesPerSecond << ", \"items_per_second\": " << r.itemsPerSecond << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+    return 0;
+}
+
+#endif // BENCHHARNESS_HPP
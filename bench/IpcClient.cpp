@@ -0,0 +1,281 @@
+// Transcript event latency through the IPC server.
+//
+//   ipc_client --socket <path> [--device <n|name>]... [--partial-ms <ms>]
+//              [--seconds <s>] [--json <path>]
+//
+// Connects to a running `AudioTranscriptionTool --serve <path>`, subscribes
+// to partial and final events, starts a session on the given devices (the
+// default input without --device), collects events for --seconds and stops
+// the session. Reports per event type the delivery latency (text ready in
+// the server to received here: framing, coalescing and the socket) and the
+// end-to-end latency (last decoded sample captured to received), plus how
+// many events arrived per read. Both processes read the same steady clock,
+// so this only works on one machine.
+
+// Winsock before the harness pulls in windows.h.
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <afunix.h>
+#else
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "BenchHarness.hpp"
+
+#include "IpcServer.hpp"
+#include "Metrics.hpp"
+
+using Clock = std::chrono::steady_clock;
+using Socket = IpcServer::Socket;
+
+static const Socket kNoSocket = -1;
+static const int kReplyTimeoutMs = 10000;   // Opening devices can take a while.
+
+struct EventStats {
+    Histogram delivery;
+    Histogram endToEnd;
+    uint64_t count = 0;
+};
+
+static void closeSocket(Socket socket) {
+#ifdef _WIN32
+    closesocket(static_cast<SOCKET>(socket));
+#else
+    close(static_cast<int>(socket));
+#endif
+}
+
+static bool sendFrame(Socket socket, const std::string &json) {
+    std::string frame;
+    IpcServer::appendFrame(frame, json);
+    size_t sent = 0;
+    while (sent < frame.size()) {
+        int n = static_cast<int>(send(socket, frame.data() + sent, static_cast<int>(frame.size() - sent), 0));
+        if (n <= 0)
+            return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Value of a top-level numeric field, for replies that are not flat.
+static long long findNumber(const std::string &json, const std::string &key) {
+    size_t at = json.find("\"" + key + "\":");
+    return at == std::string::npos ? -1 : std::atoll(json.c_str() + at + key.size() + 3);
+}
+
+class Connection {
+    public:
+        explicit Connection(Socket socket) : socket_(socket) {}
+
+        // Waits up to `timeoutMs` for the next frame.
+        bool next(std::string &frame, int timeoutMs) {
+            Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+            while (!takeFrame(frame)) {
+                long left = static_cast<long>(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count());
+                if (left <= 0 || !fill(left))
+                    return false;
+            }
+            return true;
+        }
+
+        // Waits for the reply to request `id`, counting events that arrive first.
+        bool reply(long long id, std::string &frame, const std::function<void(const std::string &)> &onEvent) {
+            Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(kReplyTimeoutMs);
+            while (Clock::now() < deadline) {
+                if (!next(frame, kReplyTimeoutMs))
+                    return false;
+                if (findNumber(frame, "id") == id)
+                    return true;
+                onEvent(frame);
+            }
+            return false;
+        }
+
+        uint64_t reads() const { return reads_; }
+        Clock::time_point lastRead() const { return lastRead_; }
+    private:
+        bool fill(long timeoutMs) {
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(socket_, &readable);
+            timeval timeout;
+            timeout.tv_sec = timeoutMs / 1000;
+            timeout.tv_usec = (timeoutMs % 1000) * 1000;
+            int ready = select(static_cast<int>(socket_ + 1), &readable, nullptr, nullptr, &timeout);
+            if (ready < 0)
+                return false;
+            if (ready == 0)
+                return true;
+            char buffer[16384];
+            int got = static_cast<int>(recv(socket_, buffer, sizeof(buffer), 0));
+            if (got <= 0)
+                return false;
+            lastRead_ = Clock::now();
+            reads_++;
+            input_.append(buffer, static_cast<size_t>(got));
+            return true;
+        }
+
+        bool takeFrame(std::string &frame) {
+            if (input_.size() < 4)
+                return false;
+            const unsigned char *h = reinterpret_cast<const unsigned char *>(input_.data());
+            size_t length = (static_cast<size_t>(h[0]) << 24) | (static_cast<size_t>(h[1]) << 16) |
+                            (static_cast<size_t>(h[2]) << 8) | static_cast<size_t>(h[3]);
+            if (input_.size() < 4 + length)
+                return false;
+            frame.assign(input_, 4, length);
+            input_.erase(0, 4 + length);
+            return true;
+        }
+
+        Socket socket_;
+        std::string input_;
+        uint64_t reads_ = 0;
+        Clock::time_point lastRead_;
+};
+
+int main(int argc, char *argv[]) {
+    std::string socketPath;
+    std::string jsonPath;
+    std::vector<std::string> devices;
+    double seconds = 30.0;
+    int partialMs = 1000;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc)
+            socketPath = argv[++i];
+        else if (arg == "--device" && i + 1 < argc)
+            devices.push_back(argv[++i]);
+        else if (arg == "--partial-ms" && i + 1 < argc)
+            partialMs = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--seconds" && i + 1 < argc)
+            seconds = std::max(1.0, std::atof(argv[++i]));
+        else if (arg == "--json" && i + 1 < argc)
+            jsonPath = argv[++i];
+        else {
+            socketPath.clear();
+            break;
+        }
+    }
+    if (socketPath.empty()) {
+        std::cerr << "Usage: " << argv[0] << " --socket <path> [--device <n|name>]... [--partial-ms <ms>]"
+                  << " [--seconds <s>] [--json <path>]" << std::endl;
+        return 1;
+    }
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+        return 1;
+#endif
+    Socket fd = static_cast<Socket>(socket(AF_UNIX, SOCK_STREAM, 0));
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (fd == kNoSocket || socketPath.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Cannot create a socket for " << socketPath << std::endl;
+        return 1;
+    }
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    if (connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "Cannot connect to " << socketPath << std::endl;
+        closeSocket(fd);
+        return 1;
+    }
+    Connection connection(fd);
+
+    EventStats partial;
+    EventStats final;
+    std::string lastText;
+    auto onEvent = [&](const std::string &frame) {
+        IpcRequest event;
+        if (!IpcRequest::parse(frame.data(), frame.size(), event))
+            return;
+        const std::string type = event.get("type");
+        EventStats *stats = type == "partial" ? &partial : type == "final" ? &final : nullptr;
+        if (!stats)
+            return;
+        const double received = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::microseconds>(connection.lastRead().time_since_epoch()).count());
+        stats->delivery.record((received - event.number("ready_us", received)) / 1000.0);
+        stats->endToEnd.record((received - event.number("captured_us", received)) / 1000.0);
+        stats->count++;
+        if (type == "final")
+            lastText = event.get("text");
+    };
+
+    std::string frame;
+    std::string request = "{\"type\":\"subscribe\",\"id\":1,\"events\":[\"partial\",\"final\"]}";
+    if (!sendFrame(fd, request) || !connection.reply(1, frame, onEvent)) {
+        std::cerr << "No reply to subscribe." << std::endl;
+        return 1;
+    }
+    request = "{\"type\":\"start\",\"id\":2,\"partial_ms\":" + std::to_string(partialMs) + ",\"devices\":[";
+    for (size_t i = 0; i < devices.size(); i++)
+        request += (i ? ",\"" : "\"") + jsonEscape(devices[i]) + "\"";
+    request += "]}";
+    if (!sendFrame(fd, request) || !connection.reply(2, frame, onEvent) || findNumber(frame, "session") < 0) {
+        std::cerr << "Session did not start: " << frame << std::endl;
+        return 1;
+    }
+    const long long session = findNumber(frame, "session");
+    std::cout << "Session " << session << " started; collecting events for " << seconds << " s" << std::endl;
+
+    const uint64_t readsBefore = connection.reads();
+    Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                               std::chrono::duration<double>(seconds));
+    while (Clock::now() < end) {
+        int left = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(end - Clock::now()).count());
+        if (connection.next(frame, std::max(1, left)))
+            onEvent(frame);
+    }
+    const uint64_t reads = connection.reads() - readsBefore;
+
+    request = "{\"type\":\"stop\",\"id\":3,\"session\":" + std::to_string(session) + "}";
+    if (!sendFrame(fd, request) || !connection.reply(3, frame, onEvent))
+        std::cerr << "No reply to stop." << std::endl;
+    closeSocket(fd);
+#ifdef _WIN32
+    WSACleanup();
+#endif
+
+    HistogramSnapshot rows[4] = {partial.delivery.snapshot(), partial.endToEnd.snapshot(),
+                                 final.delivery.snapshot(), final.endToEnd.snapshot()};
+    const char *names[4] = {"partial_delivery", "partial_end_to_end", "final_delivery", "final_end_to_end"};
+    std::printf("%-20s %8s %10s %10s %10s %10s\n", "latency", "events", "p50 ms", "p95 ms", "p99 ms", "max ms");
+    for (int i = 0; i < 4; i++) {
+        std::printf("%-20s %8llu %10.3f %10.3f %10.3f %10.3f\n", names[i], static_cast<unsigned long long>(rows[i].count),
+                    rows[i].p50Ms, rows[i].p95Ms, rows[i].p99Ms, rows[i].maxMs);
+    }
+    const uint64_t events = partial.count + final.count;
+    const double perRead = reads > 0 ? static_cast<double>(events) / static_cast<double>(reads) : 0.0;
+    std::printf("%llu events in %llu reads (%.2f per read)\n", static_cast<unsigned long long>(events),
+                static_cast<unsigned long long>(reads), perRead);
+    if (!lastText.empty())
+        std::printf("last final: %s\n", lastText.c_str());
+
+    if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        if (!out.is_open()) {
+            std::cerr << "Failed to write " << jsonPath << std::endl;
+            return 1;
+        }
+        out << "{\n  \"seconds\": " << seconds << ",\n  \"partial_ms\": " << partialMs
+            << ",\n  \"events\": " << events << ",\n  \"reads\": " << reads << ",\n  \"latency\": [";
+        for (int i = 0; i < 4; i++) {
+            out << (i ? ",\n" : "\n") << "    {\"name\": \"" << names[i] << "\", \"count\": " << rows[i].count
+                << ", \"p50_ms\": " << rows[i].p50Ms << ", \"p95_ms\": " << rows[i].p95Ms << ", \"p99_ms\": "
+                << rows[i].p99Ms << ", \"max_ms\": " << rows[i].maxMs << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+    return 0;
+}
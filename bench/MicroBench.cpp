@@ -0,0 +1,340 @@
+// Microbenchmarks of the per-chunk hot paths.
+//
+//   micro_bench [--filter <substring>] [--min-time <s>] [--json <path>]
+//
+// Inputs are synthetic and generated once per benchmark: 48 kHz stereo
+// int16 for the capture side, 16 kHz mono float for VAD and the WAV writer,
+// and token windows with a one-second overlap for the transcript stitcher.
+// The BM_MutexRing cases run the ring buffer main.cpp used before the
+// lock-free RingBuffer, as a baseline.
+
+#include "BenchHarness.hpp"
+
+#include "ChunkAssembler.hpp"
+#include "Resampler.hpp"
+#include "RingBuffer.hpp"
+#include "TranscriptStitcher.hpp"
+#include "UtteranceSegmenter.hpp"
+#include "VoiceActivityDetector.hpp"
+#include "WavWriter.hpp"
+
+#include <cmath>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+static const double kPi = 3.14159265358979323846;
+static const int kDeviceRate = 48000;
+static const int kChannels = 2;
+static const size_t kPeriod = 256;          // Frames per PortAudio callback.
+static const size_t kChunk = 4800;          // 100 ms at 48 kHz.
+
+// Speech-like test signal: a 150 Hz harmonic series that is on for 1.5 s
+// and off for 1 s, over a low noise floor.
+static std::vector<float> speechLike(size_t samples, int rate) {
+    std::vector<float> out(samples);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < samples; i++) {
+        double t = static_cast<double>(i) / rate;
+        bool voiced = std::fmod(t, 2.5) < 1.5;
+        double v = 0.0;
+        if (voiced) {
+            for (int h = 1; h <= 8; h++)
+                v += 0.3 / h * std::sin(2.0 * kPi * 150.0 * h * t);
+        }
+        seed = seed * 1664525u + 1013904223u;
+        v += 0.001 * (static_cast<int32_t>(seed) / 2147483648.0);
+        out[i] = static_cast<float>(v);
+    }
+    return out;
+}
+
+static std::vector<int16_t> interleaved(size_t frames) {
+    std::vector<float> mono = speechLike(frames, kDeviceRate);
+    std::vector<int16_t> out(frames * kChannels);
+    for (size_t i = 0; i < frames; i++) {
+        int16_t s = static_cast<int16_t>(mono[i] * 32767.0f);
+        for (int c = 0; c < kChannels; c++)
+            out[i * kChannels + c] = s;
+    }
+    return out;
+}
+
+//---------------------------------------------------------------------------
+// Ring buffer
+//---------------------------------------------------------------------------
+// The old main.cpp ring: one mutex around per-sample copies with a modulo,
+// counted in samples rather than frames.
+class MutexRing {
+    public:
+        explicit MutexRing(size_t capacity)
+            : buffer_(capacity), capacity_(capacity), head_(0), tail_(0), count_(0) {}
+
+        void push(const int16_t *data, size_t num) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (num > capacity_ - count_) {
+                size_t toDrop = num - (capacity_ - count_);
+                tail_ = (tail_ + toDrop) % capacity_;
+                count_ -= toDrop;
+            }
+            for (size_t i = 0; i < num; i++) {
+                buffer_[head_] = data[i];
+                head_ = (head_ + 1) % capacity_;
+            }
+            count_ += num;
+        }
+
+        bool pop(size_t num, std::vector<int16_t> &out) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (count_ < num)
+                return false;
+            out.resize(num);
+            for (size_t i = 0; i < num; i++) {
+                out[i] = buffer_[tail_];
+                tail_ = (tail_ + 1) % capacity_;
+            }
+            count_ -= num;
+            return true;
+        }
+
+        size_t available() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return count_;
+        }
+    private:
+        std::vector<int16_t> buffer_;
+        size_t capacity_;
+        size_t head_;
+        size_t tail_;
+        size_t count_;
+        std::mutex mutex_;
+};
+
+static void BM_RingPushPop(BenchState &state) {
+    RingBuffer ring(kDeviceRate, kChannels);
+    std::vector<int16_t> in = interleaved(kPeriod);
+    std::vector<int16_t> out(kPeriod * kChannels);
+    for (auto _ : state) {
+        ring.push(in.data(), kPeriod);
+        ring.pop(kPeriod, out.data());
+    }
+    state.setBytesProcessed(state.iterations() * kPeriod * kChannels * sizeof(int16_t));
+}
+BENCHMARK(BM_RingPushPop);
+
+static void BM_RingPeekConsume(BenchState &state) {
+    RingBuffer ring(kDeviceRate, kChannels);
+    std::vector<int16_t> in = interleaved(kPeriod);
+    RingBufferView view;
+    for (auto _ : state) {
+        ring.push(in.data(), kPeriod);
+        ring.peek(kPeriod, view);
+        ring.consume(view);
+    }
+    state.setBytesProcessed(state.iterations() * kPeriod * kChannels * sizeof(int16_t));
+}
+BENCHMARK(BM_RingPeekConsume);
+
+// Producer and consumer on separate threads, as with a real capture stream.
+static void BM_RingThreaded(BenchState &state) {
+    RingBuffer ring(kDeviceRate, kChannels);
+    std::vector<int16_t> in = interleaved(kPeriod);
+    std::vector<int16_t> out(kPeriod * kChannels);
+    const uint64_t total = state.iterations();
+    std::thread producer([&]() {
+        for (uint64_t pushed = 0; pushed < total;) {
+            if (ring.capacity() - ring.available() >= kPeriod) {
+                ring.push(in.data(), kPeriod);
+                pushed++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (auto _ : state) {
+        while (!ring.pop(kPeriod, out.data()))
+            std::this_thread::yield();
+    }
+    producer.join();
+    state.setBytesProcessed(state.iterations() * kPeriod * kChannels * sizeof(int16_t));
+}
+BENCHMARK(BM_RingThreaded);
+
+static void BM_MutexRingPushPop(BenchState &state) {
+    MutexRing ring(kDeviceRate * kChannels);
+    std::vector<int16_t> in = interleaved(kPeriod);
+    std::vector<int16_t> out;
+    for (auto _ : state) {
+        ring.push(in.data(), kPeriod * kChannels);
+        ring.pop(kPeriod * kChannels, out);
+    }
+    state.setBytesProcessed(state.iterations() * kPeriod * kChannels * sizeof(int16_t));
+}
+BENCHMARK(BM_MutexRingPushPop);
+
+static void BM_MutexRingThreaded(BenchState &state) {
+    const size_t capacity = kDeviceRate * kChannels;
+    MutexRing ring(capacity);
+    std::vector<int16_t> in = interleaved(kPeriod);
+    std::vector<int16_t> out;
+    const uint64_t total = state.iterations();
+    std::thread producer([&]() {
+        for (uint64_t pushed = 0; pushed < total;) {
+            if (capacity - ring.available() >= kPeriod * kChannels) {
+                ring.push(in.data(), kPeriod * kChannels);
+                pushed++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (auto _ : state) {
+        while (!ring.pop(kPeriod * kChannels, out))
+            std::this_thread::yield();
+    }
+    producer.join();
+    state.setBytesProcessed(state.iterations() * kPeriod * kChannels * sizeof(int16_t));
+}
+BENCHMARK(BM_MutexRingThreaded);
+
+//---------------------------------------------------------------------------
+// Downmix + resample to 16 kHz mono (the old downsample_mono_16k)
+//---------------------------------------------------------------------------
+static void BM_Resample48kStereo(BenchState &state) {
+    Resampler resampler(kDeviceRate, 16000, kChannels);
+    std::vector<int16_t> in = interleaved(kChunk);
+    std::vector<float> out(resampler.maxOutput(kChunk));
+    for (auto _ : state)
+        resampler.process(in.data(), kChunk, out.data());
+    state.setItemsProcessed(state.iterations() * kChunk);
+}
+BENCHMARK(BM_Resample48kStereo);
+
+static void BM_Resample44kStereo(BenchState &state) {
+    Resampler resampler(44100, 16000, kChannels);
+    std::vector<int16_t> in = interleaved(4410);
+    std::vector<float> out(resampler.maxOutput(4410));
+    for (auto _ : state)
+        resampler.process(in.data(), 4410, out.data());
+    state.setItemsProcessed(state.iterations() * 4410);
+}
+BENCHMARK(BM_Resample44kStereo);
+
+// The same with the scalar inner loop, to see what the SIMD kernel buys.
+static void BM_Resample48kStereoScalar(BenchState &state) {
+    Resampler resampler(kDeviceRate, 16000, kChannels);
+    resampler.setKernel(ResamplerKernel::Scalar);
+    std::vector<int16_t> in = interleaved(kChunk);
+    std::vector<float> out(resampler.maxOutput(kChunk));
+    for (auto _ : state)
+        resampler.process(in.data(), kChunk, out.data());
+    state.setItemsProcessed(state.iterations() * kChunk);
+}
+BENCHMARK(BM_Resample48kStereoScalar);
+
+// Ring read plus resample into the chunk window, as the capture loop does.
+static void BM_ChunkAssemble(BenchState &state) {
+    RingBuffer ring(kDeviceRate, kChannels);
+    ChunkAssembler assembler(kChunk, 0, kChannels, kDeviceRate, 16000);
+    std::vector<int16_t> in = interleaved(kChunk);
+    for (auto _ : state) {
+        ring.push(in.data(), kChunk);
+        assembler.assemble(ring);
+        assembler.advance();
+    }
+    state.setItemsProcessed(state.iterations() * kChunk);
+}
+BENCHMARK(BM_ChunkAssemble);
+
+//---------------------------------------------------------------------------
+// VAD (the old simpleVAD) and utterance segmentation
+//---------------------------------------------------------------------------
+static void BM_Vad(BenchState &state) {
+    VoiceActivityDetector vad;
+    std::vector<float> audio = speechLike(16000 * 5, 16000);
+    std::vector<VadFrame> frames;
+    std::vector<SpeechSegment> segments;
+    const size_t block = 1600;
+    size_t offset = 0;
+    for (auto _ : state) {
+        frames.clear();
+        segments.clear();
+        vad.process(audio.data() + offset, block, frames, segments);
+        offset = (offset + block) % audio.size();
+    }
+    state.setItemsProcessed(state.iterations() * block);
+}
+BENCHMARK(BM_Vad);
+
+static void BM_Segmenter(BenchState &state) {
+    UtteranceSegmenter segmenter;
+    std::vector<float> audio = speechLike(16000 * 5, 16000);
+    Utterance utterance;
+    const size_t block = 1600;
+    size_t offset = 0;
+    for (auto _ : state) {
+        segmenter.push(audio.data() + offset, block);
+        while (segmenter.pop(utterance)) {
+        }
+        offset = (offset + block) % audio.size();
+    }
+    state.setItemsProcessed(state.iterations() * block);
+}
+BENCHMARK(BM_Segmenter);
+
+//---------------------------------------------------------------------------
+// Transcript stitching: 5 s windows with 1 s overlap, 4 tokens per second
+//---------------------------------------------------------------------------
+static void BM_Stitch(BenchState &state) {
+    static const char *const kWords[] = {" over", " and", " again", " until", " the", " lights", " go", " out"};
+    const int tokensPerWindow = 20;
+    const int overlapTokens = 4;
+    TranscriptStitcher stitcher;
+    std::string committed;
+    committed.reserve(1024);
+    int first = 0;      // index of the window's first word in the running text
+    size_t sink = 0;
+    for (auto _ : state) {
+        stitcher.beginWindow(first * 0.25, overlapTokens * 0.25);
+        for (int i = 0; i < tokensPerWindow; i++) {
+            int word = (first + i) % 8;
+            stitcher.addToken(word, i * 25, i * 25 + 25, kWords[word]);
+        }
+        committed.clear();
+        sink += stitcher.commit(committed);
+        first += tokensPerWindow - overlapTokens;
+    }
+    state.setItemsProcessed(state.iterations() * tokensPerWindow);
+    if (sink == 1)
+        std::printf("\n");
+}
+BENCHMARK(BM_Stitch);
+
+//---------------------------------------------------------------------------
+// Debug WAV writer (the old save_wav_16bit): sustained 1 s chunks to disk
+//---------------------------------------------------------------------------
+static void BM_WavWriterSession(BenchState &state) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "micro_bench_wav";
+    WavWriterConfig config;
+    config.directory = dir.string();
+    config.prefix = "session";
+    config.mode = WavWriterMode::Session;
+    std::vector<float> chunk = speechLike(16000, 16000);
+    {
+        WavWriter writer(config);
+        writer.start();
+        for (auto _ : state) {
+            while (!writer.write(chunk.data(), chunk.size()))
+                std::this_thread::yield();
+        }
+        writer.stop();
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    state.setBytesProcessed(state.iterations() * chunk.size() * sizeof(int16_t));
+}
+BENCHMARK(BM_WavWriterSession);
+
+int main(int argc, char *argv[]) {
+    return runBenchmarks(argc, argv);
+}
@@ -0,0 +1,290 @@
+// End-to-end benchmark of the live VAD pipeline.
+//
+//   pipeline_bench --model <ggml-tiny.bin> --corpus <dir|file|glob>
+//                  [--speed <x>] [--threads <n>] [--json <path>]
+//
+// Each WAV in the corpus is played through a VirtualCaptureDevice at
+// --speed times real time (default 1) into the same ring buffer, chunk
+// assembler, utterance segmenter and whisper_full path the application
+// uses. Reports the real-time factor (Whisper time over audio time),
+// capture-to-transcript latency percentiles, per-utterance Whisper time,
+// ring overruns and peak RSS, as a table and optionally as JSON. The model
+// is loaded and warmed up like the application does, and its load times
+// are reported separately from the run. Heap allocations are counted per
+// decode (Whisper's own included) to keep the session's result handling
+// allocation-free.
+
+#include "BenchHarness.hpp"
+
+#include "BatchTranscriber.hpp"
+#include "ChunkAssembler.hpp"
+#include "Metrics.hpp"
+#include "ModelManager.hpp"
+#include "RingBuffer.hpp"
+#include "UtteranceSegmenter.hpp"
+#include "VirtualCaptureDevice.hpp"
+#include "WhisperSession.hpp"
+
+#include "whisper.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <thread>
+
+// Every heap allocation in the process, for the per-decode counts.
+static std::atomic<uint64_t> allocationCount(0);
+
+void *operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+static const int kWhisperRate = 16000;
+static const double kChunkSeconds = 0.1;
+
+struct PipelineTotals {
+    size_t files = 0;
+    uint64_t utterances = 0;
+    double audioSeconds = 0.0;
+    double whisperSeconds = 0.0;
+    double wallSeconds = 0.0;
+    uint64_t ringOverruns = 0;
+    uint64_t ringDroppedFrames = 0;
+    uint64_t allocations = 0;       // During decodes after the first.
+    uint64_t maxAllocations = 0;
+    uint64_t firstAllocations = 0;  // The first decode sizes the session's buffers.
+};
+
+struct PipelineStages {
+    Histogram vad;          // Segmenter push per chunk.
+    Histogram whisper;      // whisper_full per utterance.
+    Histogram latency;      // Capture of an utterance's last sample to its transcript.
+};
+
+static bool runFile(const std::string &path, WhisperSession &session, double speed,
+                    PipelineTotals &totals, PipelineStages &stages) {
+    using Clock = std::chrono::steady_clock;
+
+    VirtualDeviceConfig deviceConfig;
+    deviceConfig.source = path;
+    deviceConfig.speed = speed;
+    deviceConfig.tailSeconds = 1.0;
+    VirtualCaptureDevice device;
+    if (!device.open(deviceConfig))
+        return false;
+
+    const double deviceRate = device.sampleRate();
+    const size_t chunkFrames = static_cast<size_t>(deviceRate * kChunkSeconds);
+    RingBuffer ring(chunkFrames * 20, device.channels());
+    RingBufferSink sink(ring);
+    ChunkAssembler assembler(chunkFrames, 0, device.channels(), deviceRate, kWhisperRate);
+
+    SegmenterConfig segmenterConfig;
+    segmenterConfig.sampleRate = kWhisperRate;
+    UtteranceSegmenter segmenter(segmenterConfig);
+    Utterance utterance;
+    uint64_t segmentedSamples = 0;
+
+    // With a paced device, 16 kHz sample n was captured at start + n / rate / speed.
+    Clock::time_point started = Clock::now();
+    device.start(&sink);
+    auto capturedAt = [&](uint64_t sample) {
+        return started + std::chrono::duration_cast<Clock::duration>(
+                             std::chrono::duration<double>(sample / static_cast<double>(kWhisperRate) / speed));
+    };
+
+    auto transcribe = [&]() -> bool {
+        uint64_t allocations = allocationCount.load(std::memory_order_relaxed);
+        Clock::time_point t0 = Clock::now();
+        if (!session.decode(utterance.samples.data(), utterance.samples.size())) {
+            std::cerr << "whisper_full() failed on " << path << std::endl;
+            return false;
+        }
+        Clock::time_point t1 = Clock::now();
+        allocations = allocationCount.load(std::memory_order_relaxed) - allocations;
+        if (totals.utterances == 0) {
+            totals.firstAllocations = allocations;
+        } else {
+            totals.allocations += allocations;
+            totals.maxAllocations = std::max(totals.maxAllocations, allocations);
+        }
+        stages.whisper.record(t1 - t0);
+        stages.latency.record(t1 - capturedAt(utterance.start + utterance.samples.size()));
+        totals.whisperSeconds += std::chrono::duration<double>(t1 - t0).count();
+        totals.utterances++;
+        return true;
+    };
+
+    bool ok = true;
+    while (ok) {
+        if (segmenter.pending() == 0) {
+            if (!assembler.assemble(ring)) {
+                if (device.finished())
+                    break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                continue;
+            }
+            {
+                ScopedTimer timer(stages.vad);
+                segmenter.push(assembler.data(), assembler.size());
+            }
+            segmentedSamples += assembler.size();
+            assembler.advance();
+        }
+        if (segmenter.pop(utterance))
+            ok = transcribe();
+    }
+    device.stop();
+    segmenter.flush();
+    while (ok && segmenter.pop(utterance))
+        ok = transcribe();
+
+    totals.files++;
+    totals.audioSeconds += static_cast<double>(segmentedSamples) / kWhisperRate;
+    totals.wallSeconds += std::chrono::duration<double>(Clock::now() - started).count();
+    totals.ringOverruns += ring.overruns();
+    totals.ringDroppedFrames += ring.droppedFrames();
+    return ok;
+}
+
+static void printUsage(const char *program) {
+    std::cerr << "Usage: " << program << " --model <path> --corpus <dir|file|glob>"
+              << " [--speed <x>] [--threads <n>] [--json <path>]" << std::endl;
+}
+
+static void writeSnapshot(std::ostream &out, const char *name, const HistogramSnapshot &s) {
+    out << "    \"" << name << "\": {\"count\": " << s.count << ", \"p50\": " << s.p50Ms << ", \"p95\": "
+        << s.p95Ms << ", \"p99\": " << s.p99Ms << ", \"max\": " << s.maxMs << "}";
+}
+
+int main(int argc, char *argv[]) {
+    std::string modelPath;
+    std::string corpus;
+    std::string jsonPath;
+    double speed = 1.0;
+    int threads = std::min(4, static_cast<int>(std::thread::hardware_concurrency()));
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--model" && i + 1 < argc)
+            modelPath = argv[++i];
+        else if (arg == "--corpus" && i + 1 < argc)
+            corpus = argv[++i];
+        else if (arg == "--json" && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (arg == "--speed" && i + 1 < argc)
+            speed = std::atof(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = std::max(1, std::atoi(argv[++i]));
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (modelPath.empty() || corpus.empty() || speed <= 0.0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::vector<std::string> files = BatchTranscriber::collectInputs(corpus);
+    if (files.empty()) {
+        std::cerr << "No WAV files found in " << corpus << std::endl;
+        return 1;
+    }
+
+    ModelManager models;
+    whisper_context_params cparams = whisper_context_default_params();
+    whisper_context *ctx = models.get(modelPath, cparams);
+    if (!ctx) {
+        std::cerr << "Failed to init Whisper model" << std::endl;
+        return 1;
+    }
+    ModelLoadStats load = models.stats(modelPath);
+    whisper_state *state = whisper_init_state(ctx);
+    if (!state) {
+        std::cerr << "Failed to allocate whisper_state" << std::endl;
+        return 1;
+    }
+
+    WhisperSessionConfig sessionConfig;
+    sessionConfig.threads = threads;
+    WhisperSession session(ctx, state, sessionConfig);
+
+    PipelineTotals totals;
+    PipelineStages stages;
+    bool ok = true;
+    for (const std::string &file : files) {
+        std::cout << "Playing " << file << std::endl;
+        if (!runFile(file, session, speed, totals, stages)) {
+            ok = false;
+            break;
+        }
+    }
+    whisper_free_state(state);
+    if (!ok)
+        return 1;
+
+    HistogramSnapshot latency = stages.latency.snapshot();
+    HistogramSnapshot whisper = stages.whisper.snapshot();
+    HistogramSnapshot vad = stages.vad.snapshot();
+    double rtf = totals.audioSeconds > 0.0 ? totals.whisperSeconds / totals.audioSeconds : 0.0;
+    uint64_t rss = peakRssBytes();
+
+    std::printf("files %zu, audio %.1f s, utterances %llu, speed %.2gx, %d threads\n", totals.files,
+                totals.audioSeconds, static_cast<unsigned long long>(totals.utterances), speed, threads);
+    std::printf("model %.1f MB %s: map %.1f ms, init %.1f ms, warmup %.1f ms\n", load.bytes / 1e6,
+                load.mapped ? "mapped" : "read", load.mapMs, load.initMs, load.warmupMs);
+    std::printf("real-time factor %.3f (whisper %.2f s)\n", rtf, totals.whisperSeconds);
+    std::printf("%-10s %10s %10s %10s %10s\n", "ms", "p50", "p95", "p99", "max");
+    std::printf("%-10s %10.1f %10.1f %10.1f %10.1f\n", "latency", latency.p50Ms, latency.p95Ms, latency.p99Ms,
+                latency.maxMs);
+    std::printf("%-10s %10.1f %10.1f %10.1f %10.1f\n", "whisper", whisper.p50Ms, whisper.p95Ms, whisper.p99Ms,
+                whisper.maxMs);
+    std::printf("%-10s %10.3f %10.3f %10.3f %10.3f\n", "vad", vad.p50Ms, vad.p95Ms, vad.p99Ms, vad.maxMs);
+    double allocationsPerDecode = totals.utterances > 1 ? static_cast<double>(totals.allocations) / (totals.utterances - 1) : 0.0;
+    std::printf("allocations per decode %.1f (max %llu, first %llu)\n", allocationsPerDecode,
+                static_cast<unsigned long long>(totals.maxAllocations),
+                static_cast<unsigned long long>(totals.firstAllocations));
+    std::printf("ring overruns %llu (%llu frames), peak RSS %.1f MB\n",
+                static_cast<unsigned long long>(totals.ringOverruns),
+                static_cast<unsigned long long>(totals.ringDroppedFrames), rss / 1e6);
+
+    if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        if (!out.is_open()) {
+            std::cerr << "Failed to write " << jsonPath << std::endl;
+            return 1;
+        }
+        out << "{\n  \"model\": \"" << jsonEscape(modelPath) << "\",\n  \"files\": " << totals.files
+            << ",\n  \"model_bytes\": " << load.bytes << ",\n  \"model_mapped\": " << (load.mapped ? "true" : "false")
+            << ",\n  \"model_map_ms\": " << load.mapMs << ",\n  \"model_init_ms\": " << load.initMs
+            << ",\n  \"model_warmup_ms\": " << load.warmupMs
+            << ",\n  \"speed\": " << speed << ",\n  \"threads\": " << threads
+            << ",\n  \"audio_seconds\": " << totals.audioSeconds
+            << ",\n  \"whisper_seconds\": " << totals.whisperSeconds
+            << ",\n  \"wall_seconds\": " << totals.wallSeconds << ",\n  \"real_time_factor\": " << rtf
+            << ",\n  \"utterances\": " << totals.utterances << ",\n  \"ring_overruns\": " << totals.ringOverruns
+            << ",\n  \"ring_dropped_frames\": " << totals.ringDroppedFrames << ",\n  \"peak_rss_bytes\": " << rss
+            << ",\n  \"allocations_per_decode\": " << allocationsPerDecode
+            << ",\n  \"allocations_max\": " << totals.maxAllocations
+            << ",\n  \"allocations_first\": " << totals.firstAllocations
+            << ",\n  \"stages_ms\": {\n";
+        writeSnapshot(out, "end_to_end", latency);
+        out << ",\n";
+        writeSnapshot(out, "whisper", whisper);
+        out << ",\n";
+        writeSnapshot(out, "vad", vad);
+        out << "\n  }\n}\n";
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+// Consumer wakeup: sleep polling versus RingBuffer::waitFor().
+//
+//   wakeup_bench [--seconds <s>] [--json <path>]
+//
+// A producer thread pushes 256-frame periods of 48 kHz stereo at real-time
+// pace, like the PortAudio callback, and the consumer pulls 100 ms chunks
+// the way the preprocessing stage does: either by the old loop (sleep
+// 10 ms, check, repeat) or by sleeping in waitFor(). For each mode reports
+// the wakeup latency (push of the period that completed a chunk to the
+// consumer holding it), consumer wakeups and consumer CPU time per second,
+// while audio flows and while the device is silent (no pushes at all).
+
+#include "BenchHarness.hpp"
+
+#include "Metrics.hpp"
+#include "RingBuffer.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+static const int kDeviceRate = 48000;
+static const int kChannels = 2;
+static const size_t kPeriod = 256;          // Frames per PortAudio callback.
+static const size_t kChunk = 4800;          // 100 ms at 48 kHz.
+static const int kPollMs = 10;              // The loop waitFor() replaces.
+static const std::chrono::milliseconds kWaitTimeout(100);
+
+using Clock = std::chrono::steady_clock;
+
+// CPU time of the calling thread in seconds.
+static double threadCpuSeconds() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user))
+        return 0.0;
+    auto ticks = [](const FILETIME &t) {
+        return (static_cast<uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime;
+    };
+    return static_cast<double>(ticks(kernel) + ticks(user)) * 100e-9;
+#elif defined(RUSAGE_THREAD)
+    rusage usage{};
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#endif
+}
+
+struct WakeupResult {
+    std::string name;
+    HistogramSnapshot latency;
+    double wakeupsPerSecond = 0.0;
+    double cpuMsPerSecond = 0.0;
+    uint64_t chunks = 0;
+};
+
+// Runs one consumer for `seconds`; with `silent` the producer never pushes.
+static WakeupResult run(const char *name, bool useWait, bool silent, double seconds) {
+    RingBuffer ring(kDeviceRate, kChannels);
+    const size_t periods = static_cast<size_t>(seconds * kDeviceRate / kPeriod);
+    // Push time of every period, written before the push that publishes it.
+    std::vector<Clock::time_point> pushed(periods + 1);
+    std::atomic<bool> running(true);
+
+    std::thread producer([&]() {
+        std::vector<int16_t> block(kPeriod * kChannels, 0);
+        const auto period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(kPeriod) / kDeviceRate));
+        Clock::time_point next = Clock::now();
+        for (size_t i = 0; i < periods; i++) {
+            next += period;
+            std::this_thread::sleep_until(next);
+            if (silent)
+                continue;
+            pushed[i] = Clock::now();
+            ring.push(block.data(), kPeriod);
+        }
+        running = false;
+    });
+
+    Histogram latency;
+    std::vector<int16_t> chunk;
+    uint64_t wakeups = 0;
+    uint64_t chunks = 0;
+    double cpuStart = threadCpuSeconds();
+    Clock::time_point start = Clock::now();
+    while (running) {
+        if (useWait)
+            ring.waitFor(kChunk, kWaitTimeout);
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+        wakeups++;
+        while (ring.available() >= kChunk) {
+            Clock::time_point now = Clock::now();
+            size_t last = static_cast<size_t>(((chunks + 1) * kChunk + kPeriod - 1) / kPeriod) - 1;
+            latency.record(now - pushed[last]);
+            ring.pop(kChunk, chunk);
+            chunks++;
+        }
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    double cpu = threadCpuSeconds() - cpuStart;
+    producer.join();
+
+    WakeupResult r;
+    r.name = name;
+    r.latency = latency.snapshot();
+    r.wakeupsPerSecond = elapsed > 0.0 ? wakeups / elapsed : 0.0;
+    r.cpuMsPerSecond = elapsed > 0.0 ? cpu * 1000.0 / elapsed : 0.0;
+    r.chunks = chunks;
+    return r;
+}
+
+int main(int argc, char *argv[]) {
+    std::string jsonPath;
+    double seconds = 5.0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (arg == "--seconds" && i + 1 < argc)
+            seconds = std::max(0.5, std::atof(argv[++i]));
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--seconds <s>] [--json <path>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<WakeupResult> results;
+    results.push_back(run("poll_10ms", false, false, seconds));
+    results.push_back(run("wait_for", true, false, seconds));
+    results.push_back(run("poll_10ms_idle", false, true, seconds));
+    results.push_back(run("wait_for_idle", true, true, seconds));
+
+    std::printf("%-16s %8s %10s %10s %10s %10s %12s\n", "mode", "chunks", "p50 ms", "p99 ms", "max ms",
+                "wakeups/s", "cpu ms/s");
+    for (const WakeupResult &r : results) {
+        std::printf("%-16s %8llu %10.3f %10.3f %10.3f %10.1f %12.3f\n", r.name.c_str(),
+                    static_cast<unsigned long long>(r.chunks), r.latency.p50Ms, r.latency.p99Ms, r.latency.maxMs,
+                    r.wakeupsPerSecond, r.cpuMsPerSecond);
+    }
+
+    if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        if (!out.is_open()) {
+            std::cerr << "Failed to write " << jsonPath << std::endl;
+            return 1;
+        }
+        out << "{\n  \"seconds\": " << seconds << ",\n  \"modes\": [";
+        for (size_t i = 0; i < results.size(); i++) {
+            const WakeupResult &r = results[i];
+            out << (i ? ",\n" : "\n") << "    {\"name\": \"" << jsonEscape(r.name) << "\", \"chunks\": " << r.chunks
+                << ", \"latency_p50_ms\": " << r.latency.p50Ms << ", \"latency_p99_ms\": " << r.latency.p99Ms
+                << ", \"latency_max_ms\": " << r.latency.maxMs << ", \"wakeups_per_second\": "
+                << r.wakeupsPerSecond << ", \"cpu_ms_per_second\": " << r.cpuMsPerSecond << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+    return 0;
+}
@@ -2,6 +2,7 @@
 #define AAUDIODEVICE_HPP
 
 #include "IAudioDevice.hpp"
+#include "SampleFormat.hpp"
 
 #ifdef _WIN32
 #include "Pa_win_wasapi.h"
@@ -11,11 +12,14 @@ class AAudioDevice : public IAudioDevice {
     public:
         AAudioDevice(int deviceId);
         ~AAudioDevice();
-        DeviceType getDeviceType() const;
-        PaDeviceInfo getDeviceInfo() const;
-        PaHostApiInfo getHostAPIInfo() const;
+        DeviceType getDeviceType() const override;
+        const PaDeviceInfo &getDeviceInfo() const override;
+        const PaHostApiInfo &getHostAPIInfo() const override;
         int getID() const;
 
+        // PortAudio sample format for stream parameters.
+        static PaSampleFormat toPaSampleFormat(SampleFormat format);
+
         // Factory method for creating platform-specific instances
         static std::unique_ptr<AAudioDevice> createInstance(int deviceId);
     protected:
@@ -0,0 +1,63 @@
+#ifndef APPCONFIG_HPP
+#define APPCONFIG_HPP
+
+#include <string>
+#include <vector>
+
+#include "MetricsReporter.hpp"
+#include "OverloadController.hpp"
+#include "ThreadScheduler.hpp"
+#include "VoiceActivityDetector.hpp"
+
+// Everything the tool can be told at startup.
+//
+// Options come from the command line and, with -c/--config, from a file of
+// `key = value` lines whose keys are the long option names ("model",
+// "device", "chunk-ms", ...). Flags are written bare or as `key = true`;
+// `#` starts a comment. The file is read first, so the command line
+// overrides it; a list option (device, input, output) given on the command line
+// replaces the file's entries instead of adding to them.
+//
+// Nothing here reads the terminal: with the device named in the
+// configuration (or the host API's default) startup goes straight to
+// capture, and the tool stops on SIGINT/SIGTERM.
+struct AppConfig {
+    std::string modelPath = "models/ggml-base.bin";
+    std::string fallbackModelPath;
+    std::string mode = "fixed";         // fixed, vad or stream
+    bool warmup = true;
+    float recordSeconds = 2.0f;         // Fixed-mode window.
+    int chunkMs = 100;                  // Block pulled from the ring in VAD and streaming mode.
+    int keepMs = 200;                   // Fixed-mode overlap between windows.
+    int framesPerBuffer = 256;
+    int whisperRate = 16000;
+    std::string hostApi;                // Empty: the platform's preferred host API.
+    std::vector<std::string> devices;   // Index in the device list or (part of) a name.
+    std::string virtualSource;
+    std::string servePath;              // IPC socket for the desktop frontend; empty: none.
+    std::vector<std::string> inputs;    // Offline WAV files.
+    std::vector<std::string> outputs;   // Transcript writers, "<format>:<target>".
+    int jobs = 1;
+    int workers = 2;
+    bool debug = false;
+    bool debugSession = false;
+    VadConfig vad;
+    ThreadSchedulerConfig threads;
+    OverloadConfig overload;
+    MetricsReporterConfig metrics;
+    bool help = false;
+
+    // Reads the file named by -c/--config, if any, then the rest of the
+    // command line. Returns false (with a message) on a bad option.
+    bool parse(int argc, char *argv[]);
+    bool loadFile(const std::string &path);
+
+    static void printUsage(const char *program);
+
+    // Index of `spec` in `names`: a number is taken as the index, anything
+    // else must match one name exactly or be part of exactly one name,
+    // ignoring case. Returns -1 if there is no single match.
+    static int match(const std::string &spec, const std::vector<std::string> &names);
+};
+
+#endif // APPCONFIG_HPP
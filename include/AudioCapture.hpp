@@ -2,21 +2,53 @@
 #define AUDIOCAPTURE_HPP
 
 #include "AAudioDevice.hpp"
+#include "AudioSink.hpp"
+#include "SampleFormat.hpp"
 #include <vector>
 #include <memory>
 #include <chrono>
 
+struct CaptureFormat {
+    double sampleRate = 0.0;
+    int channels = 0;
+    SampleFormat format = SampleFormat::Int16;
+};
+
+// Continuous capture from one device.
+//
+// open() configures the stream, start() begins delivering every period to
+// the registered sink from the host API's callback until stop(). Blocks
+// carry the negotiated sample format and the stream timestamps, so
+// downstream stages (ring buffer, resampler) get exactly what the device
+// produced without an intermediate recording buffer.
 class AudioCapture {
     public:
         virtual ~AudioCapture() = default;
 
-        virtual bool start(AAudioDevice *device, std::chrono::seconds duration) = 0;
-        virtual std::vector<uint8_t> getCapturedData() const = 0;
-        virtual double getSampleRate() const = 0;
+        virtual bool open(AAudioDevice *device, SampleFormat format = SampleFormat::Int16) = 0;
+        virtual bool start() = 0;
+        virtual bool stop() = 0;
+        virtual void close() = 0;
+        virtual bool isActive() const = 0;
+
+        // Sink receiving the audio; set before start().
+        void setSink(AudioSink *sink);
+        // Frames per callback requested from the host; set before open().
+        void setFramesPerBuffer(unsigned long frames);
+        const CaptureFormat &getFormat() const;
+        uint64_t framesCaptured() const;
 
         // Factory method for creating platform-specific instances
         static std::unique_ptr<AudioCapture> createInstance();
     protected:
+        // Shared body of the platform PortAudio callbacks.
+        int deliver(const void *input, unsigned long frames, const PaStreamCallbackTimeInfo *timeInfo,
+                    PaStreamCallbackFlags statusFlags);
+
+        AudioSink *sink_ = nullptr;
+        CaptureFormat format_;
+        uint64_t framesDelivered_ = 0;
+        unsigned long framesPerBuffer_ = 256;
     private:
 };
 
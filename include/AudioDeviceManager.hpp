@@ -8,17 +8,35 @@
 #include <chrono>
 #include <thread>
 #include "AAudioDevice.hpp"
+#include "AudioCapture.hpp"
+#include "AudioPlayback.hpp"
+#include "CaptureBuffer.hpp"
+#include "RingBuffer.hpp"
 
 #ifdef _WIN32
 #include <pa_win_wasapi.h>
 #include "WindowsAudioDevice.hpp"
 #include "WindowsAudioCapture.hpp"
 #include "WindowsAudioPlayback.hpp"
+#elif defined(__linux__)
+#include "LinuxAudioDevice.hpp"
+#include "LinuxAudioCapture.hpp"
+#include "LinuxAudioPlayback.hpp"
 #endif
 
+// Host API and devices to use, by index or (part of) a name as in
+// AppConfig::match. Empty entries mean the default; the terminal is only
+// asked when `interactive` is set.
+struct DeviceSelection {
+    std::string hostApi;
+    std::string recordingDevice;
+    std::string playbackDevice;
+    bool interactive = false;
+};
+
 class AudioDeviceManager {
     public:
-        AudioDeviceManager();
+        explicit AudioDeviceManager(const DeviceSelection &selection = DeviceSelection());
         ~AudioDeviceManager();
         bool init();
         bool record_device(std::chrono::seconds duration);
@@ -31,7 +49,12 @@ class AudioDeviceManager {
         std::unique_ptr<AudioPlayback> audioPlayback_;
         std::vector<std::unique_ptr<AAudioDevice>> recordingDevices_;
         std::vector<std::unique_ptr<AAudioDevice>> playbackDevices_;
+        CaptureBuffer recording_;   // Last record_device() result, lent to playback as a view.
+        DeviceSelection selection_;
     private:
+        // The configured choice as a list index ("" = default), asking with
+        // `prompt` only in interactive mode.
+        std::string choose(const std::string &preset, const char *prompt, const std::vector<std::string> &names) const;
         bool initDevices();
         void listAvailableHostAPIs(PaHostApiIndex numHostAPIs, PaHostApiIndex defaultHostAPIIndex);
         bool selectHostAPI();
@@ -2,13 +2,15 @@
 #define AUDIOPLAYBACK_HPP
 
 #include "AAudioDevice.hpp"
+#include "SampleFormat.hpp"
 #include <vector>
 #include <memory>
 
 class AudioPlayback {
     public:
         virtual ~AudioPlayback() = default;
-        virtual bool start(AAudioDevice *device, std::vector<uint8_t>& data, double sampleRate) = 0;
+        // Plays `audio` to the end; the samples are read in place, not copied.
+        virtual bool start(AAudioDevice *device, const AudioView &audio, double sampleRate) = 0;
 
         static std::unique_ptr<AudioPlayback> createInstance();
     protected:
@@ -0,0 +1,65 @@
+#ifndef AUDIOSINK_HPP
+#define AUDIOSINK_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include "RingBuffer.hpp"
+#include "SampleFormat.hpp"
+
+// One period of captured audio as delivered by the host API.
+struct CaptureBlock {
+    AudioView audio;            // Interleaved frames; only valid during onAudio().
+    uint64_t frameIndex = 0;    // Frames delivered before this block since start().
+    double adcTime = 0.0;       // Capture time of the first frame, stream clock in seconds.
+    bool overflow = false;      // The host dropped input before this block.
+};
+
+// Receiver of captured audio. onAudio() runs on the audio thread: it must
+// not block, allocate or take locks the consumer may hold.
+class AudioSink {
+    public:
+        virtual ~AudioSink() = default;
+        virtual void onAudio(const CaptureBlock &block) = 0;
+};
+
+// Pushes int16 blocks into a RingBuffer for a consumer thread to drain.
+// Blocks in any other format or channel layout are counted and dropped.
+class RingBufferSink : public AudioSink {
+    public:
+        explicit RingBufferSink(RingBuffer &ring) : ring_(ring), rejected_(0), overflows_(0) {}
+
+        void onAudio(const CaptureBlock &block) override {
+            if (block.overflow)
+                overflows_.fetch_add(1, std::memory_order_relaxed);
+            if (block.audio.format != SampleFormat::Int16 || block.audio.channels != ring_.channels()) {
+                rejected_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            ring_.push(reinterpret_cast<const int16_t *>(block.audio.data), block.audio.frames);
+        }
+
+        uint64_t rejected() const { return rejected_.load(std::memory_order_relaxed); }
+        uint64_t overflows() const { return overflows_.load(std::memory_order_relaxed); }
+    private:
+        RingBuffer &ring_;
+        std::atomic<uint64_t> rejected_;
+        std::atomic<uint64_t> overflows_;
+};
+
+// Forwards blocks to a callable, for consumers that process in place.
+class CallbackSink : public AudioSink {
+    public:
+        using Callback = std::function<void(const CaptureBlock &)>;
+
+        explicit CallbackSink(Callback callback) : callback_(std::move(callback)) {}
+
+        void onAudio(const CaptureBlock &block) override {
+            callback_(block);
+        }
+    private:
+        Callback callback_;
+};
+
+#endif // AUDIOSINK_HPP
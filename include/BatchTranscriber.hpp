@@ -0,0 +1,88 @@
+#ifndef BATCHTRANSCRIBER_HPP
+#define BATCHTRANSCRIBER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "whisper.h"
+#include "UtteranceSegmenter.hpp"
+
+struct BatchConfig {
+    int jobs = 1;                   // Parallel whisper_states.
+    int threadsPerJob = 1;          // n_threads given to each whisper_full call.
+    int whisperRate = 16000;
+    size_t readFrames = 16384;      // Frames read from disk per block.
+    size_t queueDepth = 0;          // Pending utterances; 0 = 2 * jobs.
+    const char *language = "en";
+    SegmenterConfig segmenter;
+    VadConfig vad;
+};
+
+// One recognised segment with times relative to the start of its file.
+struct TimedText {
+    double start = 0.0;
+    double end = 0.0;
+    std::string text;
+};
+
+// Offline transcription of WAV files.
+//
+// A reader thread streams each file from disk through the resampler and the
+// utterance segmenter and queues the utterances; `jobs` workers, each with
+// its own whisper_state on the shared model, decode them in parallel. Only
+// the bounded queue of utterances is held in memory. A worker that cannot
+// get a whisper_state drops out and the others carry on; the batch fails
+// only when none could start. An utterance whisper cannot decode fails the
+// batch too, after the other files are done: its file's transcript is
+// incomplete.
+class BatchTranscriber {
+    public:
+        BatchTranscriber(whisper_context *ctx, const BatchConfig &config);
+        ~BatchTranscriber();
+
+        // Transcribes all files and prints one transcript per file.
+        bool run(const std::vector<std::string> &files);
+
+        double audioSeconds() const;
+        double wallSeconds() const;
+
+        // Expands a file, a directory (all .wav files in it) or a wildcard
+        // pattern on the file name (e.g. recordings/*.wav) into file paths.
+        static std::vector<std::string> collectInputs(const std::string &input);
+    protected:
+    private:
+        struct Job {
+            size_t file = 0;
+            uint64_t start = 0;     // 16 kHz samples since the start of the file.
+            std::vector<float> samples;
+        };
+
+        bool readFile(size_t index, const std::string &path);
+        void enqueue(Job &&job);
+        void worker();
+
+        whisper_context *ctx_;
+        BatchConfig config_;
+
+        std::mutex mutex_;
+        std::condition_variable notEmpty_;
+        std::condition_variable notFull_;
+        std::deque<Job> queue_;
+        bool finished_;
+        int failedWorkers_;
+        std::atomic<bool> failed_;      // No worker could start; read by run() without the lock.
+
+        std::mutex resultsMutex_;
+        std::vector<std::vector<TimedText>> results_;
+        std::vector<size_t> decodeFailures_;    // Utterances lost per file.
+
+        double audioSeconds_;
+        double wallSeconds_;
+};
+
+#endif // BATCHTRANSCRIBER_HPP
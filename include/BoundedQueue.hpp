@@ -0,0 +1,146 @@
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Keeps the producer and consumer indices on separate cache lines.
+#define BOUNDEDQUEUE_CACHE_LINE 64
+
+// Wakes a thread waiting for some lock-free state to change.
+//
+// notify() costs a fence and a load while nobody waits; only a waiter makes
+// it take the mutex, so a producer on a hot path (or the audio callback)
+// never blocks on a consumer that is busy. The waiter announces itself
+// before re-checking its condition, and the producer publishes its change
+// before looking for waiters, so a wakeup cannot be lost between the two.
+class Notifier {
+    public:
+        Notifier() : waiters_(0) {}
+        Notifier(const Notifier &) = delete;
+        Notifier &operator=(const Notifier &) = delete;
+
+        void notify() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiters_.load(std::memory_order_relaxed) == 0)
+                return;
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv_.notify_all();
+        }
+
+        // Waits until `ready()` holds or `timeout` passes; returns ready().
+        template <typename Predicate>
+        bool waitFor(Predicate ready, std::chrono::milliseconds timeout) {
+            if (ready())
+                return true;
+            std::unique_lock<std::mutex> lock(mutex_);
+            waiters_.fetch_add(1, std::memory_order_seq_cst);
+            bool result = cv_.wait_for(lock, timeout, ready);
+            waiters_.fetch_sub(1, std::memory_order_relaxed);
+            return result;
+        }
+    private:
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::atomic<int> waiters_;
+};
+
+// Bounded lock-free single-producer/single-consumer queue between two
+// pipeline stages.
+//
+// Slots are allocated up front and items are exchanged with them by swap,
+// so a stage hands over a filled item and gets back the one the other side
+// finished with: buffers such as std::vector keep their capacity and
+// circulate between the stages without allocating. The capacity is rounded
+// up to a power of two and positions are monotonic counters, as in
+// RingBuffer.
+//
+// tryPush()/tryPop() never block. push()/pop() wait on a Notifier when the
+// queue is full or empty, so neither stage polls. close() ends the stream:
+// pop() drains what is left and then returns false at once.
+template <typename T>
+class BoundedQueue {
+    public:
+        explicit BoundedQueue(size_t capacity) : head_(0), tail_(0), closed_(false) {
+            size_t rounded = 1;
+            while (rounded < capacity)
+                rounded <<= 1;
+            slots_.resize(rounded);
+            mask_ = rounded - 1;
+        }
+        BoundedQueue(const BoundedQueue &) = delete;
+        BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+        // Producer side. On success `item` holds a recycled slot value.
+        bool tryPush(T &item) {
+            uint64_t head = head_.load(std::memory_order_relaxed);
+            if (head - tail_.load(std::memory_order_acquire) > mask_)
+                return false;
+            std::swap(slots_[head & mask_], item);
+            head_.store(head + 1, std::memory_order_release);
+            notEmpty_.notify();
+            return true;
+        }
+
+        // Waits up to `timeout` for a free slot.
+        bool push(T &item, std::chrono::milliseconds timeout) {
+            if (tryPush(item))
+                return true;
+            notFull_.waitFor([this]() { return size() <= mask_; }, timeout);
+            return tryPush(item);
+        }
+
+        // Consumer side. On success `item` holds the oldest value and its
+        // old value goes back to the producer through the slot.
+        bool tryPop(T &item) {
+            uint64_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail == head_.load(std::memory_order_acquire))
+                return false;
+            std::swap(slots_[tail & mask_], item);
+            tail_.store(tail + 1, std::memory_order_release);
+            notFull_.notify();
+            return true;
+        }
+
+        // Waits up to `timeout` for an item. Returns false on timeout, or at
+        // once when the queue is closed and empty.
+        bool pop(T &item, std::chrono::milliseconds timeout) {
+            if (tryPop(item))
+                return true;
+            notEmpty_.waitFor([this]() { return size() > 0 || closed(); }, timeout);
+            return tryPop(item);
+        }
+
+        // Producer side: no more items will follow.
+        void close() {
+            closed_.store(true, std::memory_order_release);
+            notEmpty_.notify();
+        }
+
+        bool closed() const { return closed_.load(std::memory_order_acquire); }
+        size_t size() const {
+            // Tail first: the head only moves forward, so it cannot be behind.
+            uint64_t tail = tail_.load(std::memory_order_acquire);
+            return static_cast<size_t>(head_.load(std::memory_order_acquire) - tail);
+        }
+        size_t capacity() const { return mask_ + 1; }
+    private:
+        std::vector<T> slots_;
+        size_t mask_;
+
+        // Written by the producer only.
+        alignas(BOUNDEDQUEUE_CACHE_LINE) std::atomic<uint64_t> head_;
+        // Written by the consumer only.
+        alignas(BOUNDEDQUEUE_CACHE_LINE) std::atomic<uint64_t> tail_;
+        std::atomic<bool> closed_;
+        Notifier notEmpty_;
+        Notifier notFull_;
+};
+
+#endif // BOUNDEDQUEUE_HPP
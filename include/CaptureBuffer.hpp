@@ -0,0 +1,62 @@
+#ifndef CAPTUREBUFFER_HPP
+#define CAPTUREBUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "SampleFormat.hpp"
+
+// A finished recording: interleaved frames plus the format they were
+// captured in.
+//
+// Move-only. A recording is handed from capture to its consumer (playback,
+// a WAV file, a transcriber) by moving the buffer or by lending an
+// AudioView of it, never by copying the samples.
+class CaptureBuffer {
+    public:
+        CaptureBuffer() : sampleRate_(0.0), channels_(0), format_(SampleFormat::Int16) {}
+        CaptureBuffer(double sampleRate, int channels, SampleFormat format)
+            : sampleRate_(sampleRate), channels_(channels), format_(format) {}
+
+        CaptureBuffer(const CaptureBuffer &) = delete;
+        CaptureBuffer &operator=(const CaptureBuffer &) = delete;
+        CaptureBuffer(CaptureBuffer &&) noexcept = default;
+        CaptureBuffer &operator=(CaptureBuffer &&) noexcept = default;
+
+        // Sizes the buffer for `frames` frames; the contents are overwritten
+        // by the writer.
+        void resize(size_t frames) { data_.resize(frames * frameBytes()); }
+        uint8_t *frame(size_t index) { return data_.data() + index * frameBytes(); }
+
+        AudioView view() const {
+            AudioView v;
+            v.data = data_.data();
+            v.frames = frames();
+            v.channels = channels_;
+            v.format = format_;
+            return v;
+        }
+
+        size_t frames() const { return frameBytes() ? data_.size() / frameBytes() : 0; }
+        size_t frameBytes() const { return static_cast<size_t>(channels_) * bytesPerSample(format_); }
+        bool empty() const { return data_.empty(); }
+        double sampleRate() const { return sampleRate_; }
+        int channels() const { return channels_; }
+        SampleFormat format() const { return format_; }
+    protected:
+    private:
+        std::vector<uint8_t> data_;
+        double sampleRate_;
+        int channels_;
+        SampleFormat format_;
+};
+
+static_assert(!std::is_copy_constructible<CaptureBuffer>::value && !std::is_copy_assignable<CaptureBuffer>::value,
+              "CaptureBuffer must only be moved");
+static_assert(std::is_nothrow_move_constructible<CaptureBuffer>::value,
+              "CaptureBuffer moves must not reallocate");
+
+#endif // CAPTUREBUFFER_HPP
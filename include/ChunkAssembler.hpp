@@ -0,0 +1,55 @@
+#ifndef CHUNKASSEMBLER_HPP
+#define CHUNKASSEMBLER_HPP
+
+#include "RingBuffer.hpp"
+#include "Resampler.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Builds fixed-size mono chunks at the Whisper rate straight out of the ring
+// buffer's memory. New frames are downmixed and resampled (see Resampler)
+// from the ring's view (contiguous or two-part) into a window that is
+// allocated once at construction; the tail of each chunk is kept in place
+// as overlap for the next one. No heap allocation happens once the
+// assembler is constructed.
+class ChunkAssembler {
+    public:
+        ChunkAssembler(size_t chunkFrames, size_t keepFrames, int channels,
+                       double deviceSampleRate, int outputRate);
+        ~ChunkAssembler();
+
+        // Pulls the frames that follow the overlap from the ring. Returns false
+        // when not enough audio is buffered yet or the view was overwritten.
+        bool assemble(RingBuffer &ring);
+
+        // Current chunk (overlap + new audio), valid until the next assemble().
+        const float *data() const;
+        size_t size() const;
+        // Samples at the front of the chunk carried over from the previous one.
+        size_t overlapSize() const;
+
+        // Keeps the last `keep` output samples of the chunk as the next overlap.
+        void advance();
+
+        // Device frame that follows the latest chunk.
+        uint64_t position() const;
+        // Reports, once, the device frames [start, end) that the producer
+        // overwrote before they could be assembled. Consecutive losses are
+        // merged into one span. The first chunk after a gap carries silence
+        // as its overlap.
+        bool takeGap(uint64_t &start, uint64_t &end);
+    protected:
+    private:
+        Resampler resampler_;
+        std::vector<float> window_;
+        size_t newFrames_;
+        size_t keepSamples_;
+        size_t size_;
+        uint64_t next_;         // Device frame expected at the next assemble().
+        uint64_t gapStart_;
+        uint64_t gapEnd_;
+        bool gapPending_;
+};
+
+#endif // CHUNKASSEMBLER_HPP
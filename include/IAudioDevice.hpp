@@ -19,9 +19,13 @@ class IAudioDevice {
     public:
         IAudioDevice() = default;
         virtual ~IAudioDevice() = default;
+        // Devices are owned by one unique_ptr and passed by pointer; copying
+        // one would duplicate its PortAudio stream parameters.
+        IAudioDevice(const IAudioDevice &) = delete;
+        IAudioDevice &operator=(const IAudioDevice &) = delete;
         virtual DeviceType getDeviceType() const = 0;
-        virtual PaDeviceInfo getDeviceInfo() const = 0;
-        virtual PaHostApiInfo getHostAPIInfo() const = 0;
+        virtual const PaDeviceInfo &getDeviceInfo() const = 0;
+        virtual const PaHostApiInfo &getHostAPIInfo() const = 0;
     protected:
         int id_ = -1;
         DeviceType deviceType_ = DeviceType::None;
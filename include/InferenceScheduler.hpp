@@ -0,0 +1,56 @@
+#ifndef INFERENCESCHEDULER_HPP
+#define INFERENCESCHEDULER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "ThreadScheduler.hpp"
+#include "TranscriptionStream.hpp"
+
+struct SchedulerConfig {
+    int workers = 2;            // Concurrent whisper_full calls.
+    int idleMs = 100;           // Longest wait for captured audio when no stream has work.
+};
+
+// Fixed pool of inference workers shared by all streams.
+//
+// Each worker scans the streams round-robin, starting one past where the
+// previous pick started, and decodes the first stream with a finished
+// utterance that no other worker is busy with. A talkative stream therefore
+// cannot starve the others, and at most `workers` decodes run at once no
+// matter how many streams are open. The n_threads of each call comes from
+// the ThreadScheduler, which splits the cores between concurrent calls.
+//
+// A worker that finds nothing to do sleeps until a stream has captured
+// another chunk: an utterance can only end, or a partial come due, once the
+// segmenter has been fed more audio. Streams notify a shared Notifier from
+// their capture callbacks, so an idle process neither polls nor adds a
+// chunk's worth of latency.
+class InferenceScheduler {
+    public:
+        InferenceScheduler(const std::vector<TranscriptionStream *> &streams, const SchedulerConfig &config,
+                           ThreadScheduler &threads);
+        ~InferenceScheduler();
+
+        bool start(const TranscriptionStream::TextCallback &onText);
+        void stop();
+    protected:
+    private:
+        void worker();
+        uint64_t chunksCaptured() const;
+
+        std::vector<TranscriptionStream *> streams_;
+        SchedulerConfig config_;
+        ThreadScheduler &threads_;
+        std::vector<size_t> slots_;     // ThreadScheduler slot of each stream.
+        TranscriptionStream::TextCallback onText_;
+        std::vector<std::thread> workers_;
+        Notifier captured_;             // Woken by the streams' capture callbacks.
+        std::atomic<size_t> cursor_;
+        std::atomic<bool> running_;
+};
+
+#endif // INFERENCESCHEDULER_HPP
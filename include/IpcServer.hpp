@@ -0,0 +1,129 @@
+#ifndef IPCSERVER_HPP
+#define IPCSERVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct IpcServerConfig {
+    std::string path;                       // Socket path; a stale socket there is replaced at start.
+    int coalesceMs = 20;                    // Events are gathered this long into one write per client.
+    size_t maxRequestBytes = 64 * 1024;     // A longer request closes the connection.
+    size_t maxPendingBytes = 1 << 20;       // A client this far behind is disconnected.
+};
+
+// One request frame: a flat JSON object whose values are strings, numbers,
+// booleans or arrays of those.
+struct IpcRequest {
+    std::map<std::string, std::string> values;  // Strings unescaped, other scalars as written.
+    std::map<std::string, std::vector<std::string>> lists;
+
+    std::string get(const std::string &key, const std::string &fallback = "") const;
+    double number(const std::string &key, double fallback) const;
+    const std::vector<std::string> *list(const std::string &key) const;
+
+    // Returns false on anything but a flat object.
+    static bool parse(const char *data, size_t size, IpcRequest &out);
+};
+
+// Local IPC endpoint for the desktop frontend.
+//
+// Listens on a Unix domain socket (AF_UNIX, which Windows 10 and later
+// support as well), readable by the current user only. start() fails if
+// the path is taken by anything but a stale socket (connecting is refused),
+// and stop() removes only the socket this server created. Both directions
+// carry frames of a 4-byte big-endian length followed by that many bytes
+// of UTF-8 JSON.
+//
+// Requests are handed to the handler on the server thread, which answers
+// with send(). Events go through publish(): they are queued and written
+// by a sender thread coalesceMs after the first one arrived, all events
+// queued for a client in one write. A new event for a key drops any queued
+// replaceable event with that key, so a partial transcript nobody has
+// received yet is not delivered after a newer partial or the final text.
+// Clients only get the topics they subscribed to.
+class IpcServer {
+    public:
+        using Socket = intptr_t;    // int on POSIX, SOCKET on Windows.
+        using ClientId = uint64_t;
+        using RequestHandler = std::function<void(ClientId, const IpcRequest &)>;
+
+        explicit IpcServer(const IpcServerConfig &config);
+        ~IpcServer();
+        IpcServer(const IpcServer &) = delete;
+        IpcServer &operator=(const IpcServer &) = delete;
+
+        bool start(const RequestHandler &onRequest);
+        void stop();
+
+        // Sends `json` to one client at once (replies, not coalesced).
+        void send(ClientId client, const std::string &json);
+        // Queues an event for the clients subscribed to `topic`.
+        void publish(const std::string &topic, const std::string &key, bool replaceable, const std::string &json);
+        // Replaces the client's topics.
+        void subscribe(ClientId client, const std::vector<std::string> &topics);
+
+        size_t clients() const;
+        uint64_t batches() const;       // Coalesced writes so far...
+        uint64_t events() const;        // ...and the events they carried.
+        uint64_t replaced() const;      // Events dropped for a newer one.
+
+        static void appendFrame(std::string &out, const std::string &json);
+    protected:
+    private:
+        struct Client {
+            ClientId id;
+            Socket socket;
+            std::string input;          // Bytes of a partly received frame.
+            std::string output;         // Framed bytes not sent yet.
+            std::vector<std::string> topics;
+        };
+        struct Event {
+            std::string topic;
+            std::string key;
+            bool replaceable;
+            std::string frame;
+        };
+
+        bool listenOn();
+        void removeOwnSocket();
+        void run();
+        void sender();
+        bool receive(Client &client, std::vector<IpcRequest> &requests);
+        bool drain(Client &client);
+        Client *find(ClientId id);
+        static void closeSocket(Socket socket);
+
+        IpcServerConfig config_;
+        RequestHandler onRequest_;
+        Socket listener_;
+        bool ownsPath_;                 // The socket file at config_.path is ours...
+        uint64_t socketFile_;           // ...with this inode (POSIX).
+
+        mutable std::mutex mutex_;
+        std::vector<std::unique_ptr<Client>> clients_;
+        ClientId nextId_;
+
+        std::mutex eventMutex_;
+        std::condition_variable eventReady_;
+        std::vector<Event> queued_;
+        std::vector<Event> sending_;    // Sender thread only.
+        std::atomic<uint64_t> batches_;
+        std::atomic<uint64_t> events_;
+        std::atomic<uint64_t> replaced_;
+
+        std::thread thread_;
+        std::thread senderThread_;
+        std::atomic<bool> running_;
+};
+
+#endif // IPCSERVER_HPP
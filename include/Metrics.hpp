@@ -0,0 +1,126 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Monotonically increasing event count.
+class Counter {
+    public:
+        Counter() : value_(0) {}
+        void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+        // For counters owned elsewhere (e.g. RingBuffer overruns) that are
+        // mirrored here.
+        void set(uint64_t v) { value_.store(v, std::memory_order_relaxed); }
+        uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+    private:
+        std::atomic<uint64_t> value_;
+};
+
+// Last observed value.
+class Gauge {
+    public:
+        Gauge() : value_(0.0) {}
+        void set(double v) { value_.store(v, std::memory_order_relaxed); }
+        double value() const { return value_.load(std::memory_order_relaxed); }
+    private:
+        std::atomic<double> value_;
+};
+
+struct HistogramSnapshot {
+    uint64_t count = 0;
+    double sumMs = 0.0;
+    double maxMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+};
+
+// Lock-free latency histogram.
+//
+// Durations are counted in log-linear microsecond buckets (four per power of
+// two, so quantiles are within ~11% of the true value) from 1 us to about
+// 2 minutes. record() is two relaxed atomic adds and a compare-exchange
+// for the maximum, cheap enough for the audio and inference threads.
+class Histogram {
+    public:
+        Histogram();
+        Histogram(const Histogram &) = delete;
+        Histogram &operator=(const Histogram &) = delete;
+
+        void record(double ms);
+        void record(std::chrono::steady_clock::duration elapsed);
+        HistogramSnapshot snapshot() const;
+    private:
+        static const size_t kBuckets = 4 * 27 + 2;
+
+        static size_t bucketFor(uint64_t us);
+        static double midpointMs(size_t bucket);
+
+        std::array<std::atomic<uint64_t>, kBuckets> buckets_;
+        std::atomic<uint64_t> sumUs_;
+        std::atomic<uint64_t> maxUs_;
+};
+
+// Times the enclosing scope into a histogram.
+class ScopedTimer {
+    public:
+        explicit ScopedTimer(Histogram &histogram)
+            : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() { histogram_.record(std::chrono::steady_clock::now() - start_); }
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+    private:
+        Histogram &histogram_;
+        std::chrono::steady_clock::time_point start_;
+};
+
+// Named metrics of the process.
+//
+// Metrics are registered once at startup and keep their address for the
+// life of the registry, so hot paths hold plain references and never look
+// anything up. Rendering takes the registration lock; updates never do.
+class MetricsRegistry {
+    public:
+        MetricsRegistry() = default;
+        MetricsRegistry(const MetricsRegistry &) = delete;
+        MetricsRegistry &operator=(const MetricsRegistry &) = delete;
+
+        // Names are snake_case without unit suffix, e.g. "whisper" or "ring_fill".
+        Counter &counter(const std::string &name, const std::string &help);
+        Gauge &gauge(const std::string &name, const std::string &help);
+        Histogram &histogram(const std::string &name, const std::string &help);
+
+        // One-line JSON object: counters and gauges by value, histograms as
+        // {count, mean, p50, p95, p99, max} in milliseconds.
+        std::string toJson() const;
+        // Prometheus text exposition format 0.0.4; histograms are exported as
+        // summaries in seconds.
+        std::string toPrometheus() const;
+    protected:
+    private:
+        template <typename T>
+        struct Entry {
+            std::string name;
+            std::string help;
+            std::unique_ptr<T> metric;
+        };
+
+        // Returns the metric called `name`, registering it on first use.
+        template <typename T>
+        T &findOrAdd(std::vector<Entry<T>> &entries, const std::string &name, const std::string &help);
+
+        mutable std::mutex mutex_;
+        std::vector<Entry<Counter>> counters_;
+        std::vector<Entry<Gauge>> gauges_;
+        std::vector<Entry<Histogram>> histograms_;
+};
+
+#endif // METRICS_HPP
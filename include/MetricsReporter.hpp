@@ -0,0 +1,51 @@
+#ifndef METRICSREPORTER_HPP
+#define METRICSREPORTER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#include "Metrics.hpp"
+
+struct MetricsReporterConfig {
+    double intervalSeconds = 0.0;   // JSON line period; 0 disables the log line.
+    int port = 0;                   // HTTP port for /metrics; 0 disables the endpoint.
+    std::string bindAddress = "127.0.0.1";
+};
+
+// Publishes a MetricsRegistry without touching the threads that update it.
+//
+// One background thread writes the registry as a JSON line every interval
+// and, if a port is set, serves GET /metrics in Prometheus text format on
+// a local socket. Requests are answered one at a time; a scrape costs one
+// snapshot of each histogram.
+class MetricsReporter {
+    public:
+        using Socket = intptr_t;    // int on POSIX, SOCKET on Windows.
+
+        MetricsReporter(const MetricsRegistry &registry, const MetricsReporterConfig &config,
+                        std::ostream &log);
+        ~MetricsReporter();
+        MetricsReporter(const MetricsReporter &) = delete;
+        MetricsReporter &operator=(const MetricsReporter &) = delete;
+
+        bool start();
+        void stop();
+    protected:
+    private:
+        bool listenOn();
+        void run();
+        void serve(Socket client);
+        static void closeSocket(Socket socket);
+
+        const MetricsRegistry &registry_;
+        MetricsReporterConfig config_;
+        std::ostream &log_;
+        Socket listener_;
+        std::thread thread_;
+        std::atomic<bool> running_;
+};
+
+#endif // METRICSREPORTER_HPP
@@ -0,0 +1,70 @@
+#ifndef MODELMANAGER_HPP
+#define MODELMANAGER_HPP
+
+#include <cstddef>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "whisper.h"
+
+struct ModelLoadStats {
+    size_t bytes = 0;
+    bool mapped = false;        // Read through a shared mapping rather than whisper's file reader.
+    double mapMs = 0.0;         // Mapping and read-ahead advice.
+    double initMs = 0.0;        // whisper_init_*: parsing and copying the weights.
+    double warmupMs = 0.0;      // First inference on silence.
+};
+
+// Loads Whisper models in the background and hands out one context per file.
+//
+// preload() starts a load on its own thread and returns at once, so the
+// model is read while PortAudio enumerates devices and the user picks one;
+// get() waits for it. Files are mapped read-only and shared, and the
+// context is built from the mapping: every process using the same model
+// reads the weights from the same page-cache pages instead of through its
+// own buffered copy, and a model another process loaded recently costs no
+// disk reads. The mapping is released once whisper has copied the weights
+// into its own buffers.
+//
+// With warmup on, one whisper_full over a second of silence runs before
+// the context is handed out, so first-use allocations and cold caches are
+// paid before audio is accepted instead of by the first chunk.
+//
+// The manager owns the contexts and frees them when it is destroyed.
+class ModelManager {
+    public:
+        ModelManager();
+        ~ModelManager();
+        ModelManager(const ModelManager &) = delete;
+        ModelManager &operator=(const ModelManager &) = delete;
+
+        // Starts loading `path` unless it is already loading or loaded.
+        void preload(const std::string &path, const whisper_context_params &params, bool warmup = true);
+
+        // Waits for `path` (preloading it first if needed). Returns nullptr
+        // if the model failed to load.
+        whisper_context *get(const std::string &path, const whisper_context_params &params, bool warmup = true);
+
+        // Timings of a model returned by get().
+        ModelLoadStats stats(const std::string &path) const;
+    protected:
+    private:
+        struct Model {
+            std::shared_future<whisper_context *> context;
+            ModelLoadStats stats;   // Written by the loading thread before `context` is ready.
+        };
+
+        static whisper_context *load(const std::string &path, const whisper_context_params &params, bool warmup,
+                                     ModelLoadStats &stats);
+        static whisper_context *initMapped(const std::string &path, const whisper_context_params &params,
+                                           ModelLoadStats &stats);
+        static void warmUp(whisper_context *ctx);
+
+        mutable std::mutex mutex_;
+        std::map<std::string, std::unique_ptr<Model>> models_;
+};
+
+#endif // MODELMANAGER_HPP
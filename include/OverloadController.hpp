@@ -0,0 +1,109 @@
+#ifndef OVERLOADCONTROLLER_HPP
+#define OVERLOADCONTROLLER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "whisper.h"
+
+// Ways to shed inference load, applied cumulatively in the configured order.
+enum class Degradation {
+    SkipSilence,    // Do not decode chunks without speech.
+    FastDecode,     // No temperature fallback, best_of 1, encoder context sized to the audio.
+    SmallModel,     // Decode with the smaller fallback model.
+    Coalesce        // Decode the whole backlog in one call instead of chunk by chunk.
+};
+
+struct OverloadConfig {
+    std::vector<Degradation> order = {Degradation::SkipSilence, Degradation::FastDecode,
+                                      Degradation::SmallModel, Degradation::Coalesce};
+    double enterLoad = 1.0;     // Whisper time over audio time that counts as falling behind...
+    double backlogHigh = 0.5;   // ...as does a ring buffer fuller than this.
+    double exitLoad = 0.6;      // Below this (and half the backlog limit) the load has eased.
+    int escalateCalls = 2;      // Consecutive overloaded calls before the next step.
+    int relaxCalls = 10;        // Consecutive eased calls before undoing the last step.
+    double smoothing = 0.3;     // Weight of the newest call in the load average.
+};
+
+// Audio that was not transcribed, in seconds since capture started.
+struct DroppedSpan {
+    double start = 0.0;
+    double end = 0.0;
+    std::string reason;
+};
+
+// Keeps captions predictable when Whisper cannot keep up.
+//
+// Without it, a decode that takes longer than the audio it covers lets the
+// ring buffer fill until the capture side overwrites audio at random. The
+// controller watches each call's load (Whisper time over the audio time it
+// had to keep up with) and the ring backlog. After escalateCalls overloaded
+// calls it enables the next degradation in `order`; after relaxCalls calls
+// with the load well below real time it disables the last one again.
+// Steps the caller cannot provide (no fallback model) are left out.
+//
+// Every span that is not transcribed, whether overwritten in the ring or
+// skipped as non-speech, goes through drop(). Contiguous spans with the
+// same reason are merged and logged once, with their timestamps, when the
+// span closes.
+//
+// All methods may be called from different threads: the preprocessing
+// stage drops audio while the inference stage reports its load.
+class OverloadController {
+    public:
+        OverloadController(const OverloadConfig &config, std::ostream &log);
+        ~OverloadController();
+
+        // Parses a comma-separated order such as "silence,fast,model,coalesce",
+        // or "off" for none.
+        static bool parseOrder(const std::string &text, std::vector<Degradation> &order);
+        static const char *name(Degradation step);
+
+        // Removes a step the caller cannot provide.
+        void disable(Degradation step);
+
+        // Accounts one decode of `elapsedSeconds` that had `budgetSeconds` of
+        // audio to keep up with, with the ring `backlog` (0 to 1) full.
+        void update(double elapsedSeconds, double budgetSeconds, double backlog);
+
+        bool active(Degradation step) const;
+        int level() const;
+        double load() const;
+
+        // Applies FastDecode to `params` if it is active, for `samples` of
+        // audio at `sampleRate`.
+        void tune(whisper_full_params &params, size_t samples, int sampleRate) const;
+
+        // Records untranscribed audio; see the class comment.
+        void drop(double start, double end, const char *reason);
+        // Logs the open span, if any.
+        void flush();
+
+        uint64_t droppedSpans() const;
+        double droppedSeconds(const std::string &reason) const;
+    protected:
+    private:
+        bool isActive(Degradation step) const;
+        void closeSpan();
+        void report(const DroppedSpan &span);
+
+        mutable std::mutex mutex_;
+
+        OverloadConfig config_;
+        std::ostream &log_;
+        int level_;             // Leading steps of config_.order that are enabled.
+        double load_;           // Smoothed; < 0 before the first call.
+        int overloaded_;
+        int eased_;
+        DroppedSpan open_;
+        bool hasOpen_;
+        uint64_t spans_;
+        std::map<std::string, double> seconds_;    // Dropped per reason.
+};
+
+#endif // OVERLOADCONTROLLER_HPP
@@ -0,0 +1,95 @@
+#ifndef RESAMPLER_HPP
+#define RESAMPLER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "SampleFormat.hpp"
+
+// Windowed-sinc (Kaiser) low-pass split into L phases for a reduced L/M
+// ratio. Coefficients are stored per phase, time-reversed and zero-padded to
+// a multiple of 8 so the inner loop is a straight SIMD dot product.
+struct ResamplerFilterBank {
+    int up = 1;                 // L
+    int down = 1;               // M
+    size_t taps = 0;            // Coefficients per phase (padded).
+    double delay = 0.0;         // Group delay in input samples.
+    std::vector<float> coeffs;  // up * taps, phase-major.
+
+    const float *phase(int p) const { return coeffs.data() + static_cast<size_t>(p) * taps; }
+};
+
+// Inner loop of the FIR. Scalar is always there; the SIMD kernels when both
+// the build and the CPU support them.
+enum class ResamplerKernel {
+    Scalar,
+    Sse2,
+    Avx2,       // with FMA
+    Neon
+};
+
+// Streaming N-channel PCM -> mono float resampler.
+//
+// Every channel is averaged into the mono signal, which is then resampled
+// with a polyphase FIR. Filter history and phase are kept between calls so
+// consecutive blocks (and chunk boundaries) are seamless. Filter banks are
+// built once per ratio and shared between instances (48k->16k and
+// 44.1k->16k are the common cases). New instances use the fastest kernel
+// the CPU supports.
+class Resampler {
+    public:
+        Resampler(double inputRate, int outputRate, int channels);
+        ~Resampler();
+
+        // Converts `frames` interleaved frames and writes the output samples to
+        // `out`, which must hold at least maxOutput(frames) floats. Returns the
+        // number of samples written.
+        size_t process(const int16_t *in, size_t frames, float *out);
+
+        // Same for any sample format, e.g. a view straight into a mapped WAV
+        // file. The view's channel count must match the constructor's.
+        size_t process(const AudioView &in, float *out);
+
+        // Upper bound of samples produced by process() for `frames` frames.
+        size_t maxOutput(size_t frames) const;
+
+        // Drops the filter history, e.g. after a gap in the input.
+        void reset();
+
+        // Switches the inner loop, e.g. to compare kernels. Returns false if the
+        // build or the CPU lacks `kernel`.
+        bool setKernel(ResamplerKernel kernel);
+        ResamplerKernel kernel() const;
+
+        int upFactor() const;
+        int downFactor() const;
+        // Group delay of the filter in input frames: output sample n is the
+        // input at n * downFactor() / upFactor() - delay().
+        double delay() const;
+        int channels() const;
+
+        static std::shared_ptr<const ResamplerFilterBank> getFilterBank(int up, int down);
+        static bool kernelSupported(ResamplerKernel kernel);
+        static ResamplerKernel bestKernel();
+        static const char *kernelName(ResamplerKernel kernel);
+
+        using DotFunction = float (*)(const float *, const float *, size_t);
+    protected:
+    private:
+        size_t run(float *out);
+        size_t feed(const AudioView &in, float *out, void (*downmix)(const uint8_t *, size_t, int, float *));
+
+        std::shared_ptr<const ResamplerFilterBank> bank_;
+        std::vector<float> buffer_;     // taps - 1 samples of history + one block of input.
+        size_t filled_;
+        size_t base_;
+        int phase_;
+        int channels_;
+        bool passthrough_;
+        ResamplerKernel kernel_;
+        DotFunction dot_;
+};
+
+#endif // RESAMPLER_HPP
@@ -0,0 +1,107 @@
+#ifndef RINGBUFFER_HPP
+#define RINGBUFFER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Keeps the producer and consumer indices on separate cache lines.
+#define RINGBUFFER_CACHE_LINE 64
+
+enum class OverflowPolicy {
+    OverwriteOldest,    // Lossy: the newest audio always wins, the consumer skips ahead.
+    DropNewest          // The producer discards whatever does not fit.
+};
+
+// Read-only view of the oldest frames in the ring. The frames are either
+// contiguous (secondFrames == 0) or split in two parts at the wrap point.
+struct RingBufferView {
+    const int16_t *first = nullptr;
+    size_t firstFrames = 0;
+    const int16_t *second = nullptr;
+    size_t secondFrames = 0;
+    uint64_t position = 0;      // Absolute frame index of first[0].
+
+    size_t frames() const { return firstFrames + secondFrames; }
+};
+
+// Wait-free single-producer/single-consumer ring of interleaved int16 frames.
+//
+// push() is called from the real-time PortAudio callback and never locks,
+// allocates or loops per sample. Positions are monotonic 64-bit frame
+// counters and the capacity is rounded up to a power of two, so wrapping is
+// a mask and every copy is at most two memcpy segments. Storage is counted in
+// frames so a wrap never splits a frame across the two segments.
+//
+// The consumer can sleep in waitFor() instead of polling. It publishes the
+// head position it is waiting for; push() only checks that position after
+// storing the head and makes a single wake call (futex on Linux,
+// WakeByAddressSingle on Windows) for the block that reaches it. Blocks that
+// do not complete the request cost a fence and a load, with no lock or
+// syscall.
+class RingBuffer {
+    public:
+        RingBuffer(size_t capacityFrames, int channels, OverflowPolicy policy = OverflowPolicy::OverwriteOldest);
+        ~RingBuffer();
+
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer& operator=(const RingBuffer&) = delete;
+
+        // Producer side. Returns the number of frames actually stored.
+        size_t push(const int16_t *data, size_t frames);
+
+        // Consumer side. Pop exactly `frames` frames if available.
+        bool pop(size_t frames, std::vector<int16_t> &out);
+        bool pop(size_t frames, int16_t *out);
+
+        // Zero-copy consumer side: peek() exposes the oldest `frames` frames in
+        // place, consume() releases them. With OverwriteOldest the producer may
+        // lap a view that is held too long; consume() then returns false and the
+        // data read through the view must be discarded.
+        bool peek(size_t frames, RingBufferView &view);
+        bool consume(const RingBufferView &view);
+
+        // Consumer side: sleeps until at least `frames` frames are available or
+        // `timeout` has passed. Returns whether they are available.
+        bool waitFor(size_t frames, std::chrono::milliseconds timeout);
+
+        size_t available() const;
+        size_t capacity() const;
+        int channels() const;
+        OverflowPolicy policy() const;
+
+        // Number of overflow events and total frames lost to them.
+        uint64_t overruns() const;
+        uint64_t droppedFrames() const;
+        // Number of times push() woke a consumer sleeping in waitFor().
+        uint64_t wakeups() const;
+    protected:
+    private:
+        void wakeConsumer(uint64_t head);
+        uint64_t skipOverwritten(uint64_t tail);
+        void copyIn(uint64_t position, const int16_t *data, size_t frames);
+        void copyOut(uint64_t position, int16_t *out, size_t frames) const;
+
+        std::vector<int16_t> buffer_;
+        size_t capacity_;
+        size_t mask_;
+        int channels_;
+        OverflowPolicy policy_;
+
+        // Written by the producer only.
+        alignas(RINGBUFFER_CACHE_LINE) std::atomic<uint64_t> head_;
+        std::atomic<uint64_t> reserve_;
+        // Written by the consumer only.
+        alignas(RINGBUFFER_CACHE_LINE) std::atomic<uint64_t> tail_;
+        // Written by whichever side detects the overflow for the active policy.
+        alignas(RINGBUFFER_CACHE_LINE) std::atomic<uint64_t> overruns_;
+        std::atomic<uint64_t> droppedFrames_;
+        // Set by a waiting consumer, cleared by whichever side ends the wait.
+        alignas(RINGBUFFER_CACHE_LINE) std::atomic<uint64_t> waitTarget_;  // Head position needed; 0 if none.
+        std::atomic<uint32_t> wakeSeq_;     // Futex word, bumped on every wake.
+        std::atomic<uint64_t> wakeups_;
+};
+
+#endif // RINGBUFFER_HPP
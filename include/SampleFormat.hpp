@@ -0,0 +1,47 @@
+#ifndef SAMPLEFORMAT_HPP
+#define SAMPLEFORMAT_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Interleaved PCM sample encodings understood by the readers and the resampler.
+enum class SampleFormat {
+    Int16,
+    Int24,      // Packed little-endian, 3 bytes per sample.
+    Int32,
+    Float32
+};
+
+inline size_t bytesPerSample(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::Int16:   return 2;
+        case SampleFormat::Int24:   return 3;
+        case SampleFormat::Int32:   return 4;
+        case SampleFormat::Float32: return 4;
+    }
+    return 0;
+}
+
+inline const char *sampleFormatName(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::Int16:   return "int16";
+        case SampleFormat::Int24:   return "int24";
+        case SampleFormat::Int32:   return "int32";
+        case SampleFormat::Float32: return "float32";
+    }
+    return "unknown";
+}
+
+// Non-owning view of interleaved frames, e.g. straight into a mapped file.
+// Samples are little-endian and need not be aligned to their size.
+struct AudioView {
+    const uint8_t *data = nullptr;
+    size_t frames = 0;
+    int channels = 1;
+    SampleFormat format = SampleFormat::Int16;
+
+    size_t frameBytes() const { return bytesPerSample(format) * static_cast<size_t>(channels); }
+    size_t bytes() const { return frames * frameBytes(); }
+};
+
+#endif // SAMPLEFORMAT_HPP
@@ -0,0 +1,100 @@
+#ifndef STREAMINGTRANSCRIBER_HPP
+#define STREAMINGTRANSCRIBER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "whisper.h"
+#include "WhisperSession.hpp"
+
+struct StreamingConfig {
+    int sampleRate = 16000;
+    int stepMs = 2000;          // New audio required before each decoding pass.
+    int holdbackMs = 500;       // Words ending this close to the window end stay tentative.
+    int maxWindowMs = 15000;    // Force a commit once the window grows past this.
+    int maxPromptTokens = 224;  // Committed tokens fed back as prompt (half the text context).
+    bool trimAudioContext = true; // Size the encoder context to the window instead of 30 s.
+    int threads = 4;
+    const char *language = "en";
+};
+
+// Streaming transcription over a rolling audio window.
+//
+// Audio is appended to the window and decoded once per step. Words are
+// committed token by token once they are stable: they end well before the
+// window end, or they came out identical in two consecutive passes. The
+// commit stops at a word boundary, the committed audio is cut from the
+// window at the end of its last token and the committed tokens become the
+// prompt of the next pass. Within one long segment of continuous speech the
+// window therefore stays at about holdback plus one step: only the held-back
+// tail is decoded again, so the audio is decoded about 1 + holdback/step
+// times over (1.25 with the defaults), and the text continues without the
+// overlap/stitching step of fixed chunking.
+//
+// The window is a view into a buffer twice its maximum size: cutting only
+// moves its start, and the buffer is compacted when an append would not fit.
+//
+// The engine owns its whisper_state and decodes through a WhisperSession
+// on it, so the decode parameters are built once; the whisper_context
+// (model) is shared.
+class StreamingTranscriber {
+    public:
+        StreamingTranscriber(whisper_context *ctx, const StreamingConfig &config);
+        ~StreamingTranscriber();
+
+        StreamingTranscriber(const StreamingTranscriber&) = delete;
+        StreamingTranscriber& operator=(const StreamingTranscriber&) = delete;
+
+        bool init();
+
+        // Appends 16 kHz mono samples to the rolling window.
+        void push(const float *samples, size_t count);
+
+        // True when enough new audio is buffered for another pass.
+        bool ready() const;
+
+        // n_threads of the following passes.
+        void setThreads(int threads);
+
+        // Runs one pass and appends newly committed text to `committed`.
+        // Returns false if whisper failed.
+        bool step(std::string &committed);
+
+        // Decodes and commits whatever is left in the window.
+        bool flush(std::string &committed);
+
+        // Text of the words that are decoded but not committed yet.
+        const std::string &tentative() const;
+
+        // Absolute sample index (since start) of the window's first sample.
+        uint64_t windowStart() const;
+
+        // Samples decoded over samples pushed so far; 1 if every sample was
+        // decoded exactly once.
+        double decodeRatio() const;
+    protected:
+    private:
+        bool decode();
+        void commit(size_t count, std::string &committed);
+        const float *window() const;
+        size_t windowSize() const;
+
+        whisper_context *ctx_;
+        whisper_state *state_;
+        std::unique_ptr<WhisperSession> session_;
+        StreamingConfig config_;
+        std::vector<float> buffer_;
+        size_t begin_;                      // Window start in buffer_.
+        std::vector<whisper_token> prompt_;
+        std::vector<SessionToken> previous_;    // Tentative tokens of the last pass, window-relative.
+        std::string tentative_;
+        size_t newSamples_;
+        uint64_t windowStart_;
+        uint64_t pushedSamples_;
+        uint64_t decodedSamples_;
+};
+
+#endif // STREAMINGTRANSCRIBER_HPP
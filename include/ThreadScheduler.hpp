@@ -0,0 +1,99 @@
+#ifndef THREADSCHEDULER_HPP
+#define THREADSCHEDULER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct ThreadSchedulerConfig {
+    int fixedThreads = 0;       // > 0 pins n_threads and disables adaptation.
+    int initialThreads = 4;     // Starting point, capped to the usable cores.
+    int maxThreads = 0;         // 0 = every usable core.
+    int audioCore = -1;         // Core kept free for the audio callback; -1 = no pinning.
+    double targetLoad = 0.6;    // Whisper time over the chunk budget to aim for.
+    int settleCalls = 3;        // Calls at one thread count before it is re-evaluated.
+    double smoothing = 0.3;     // Weight of the newest call in the load average.
+    double activeSeconds = 5.0; // A stream that started a call this recently shares the cores.
+};
+
+// Chooses n_threads for each whisper_full call.
+//
+// Every call is measured against its budget, the audio time it has to keep
+// up with (the new audio of a fixed chunk or streaming step, the length of
+// an utterance). The load (time / budget) is averaged per thread count and
+// stream. After settleCalls calls, a stream above the target load tries one
+// more thread, unless the last added thread or the next one (if measured)
+// gained less than 10%; a stream well below it tries one fewer, unless one
+// fewer was measured over the target. Cores freed that way go to the audio
+// callback and the other streams.
+//
+// One scheduler serves every stream of the process, so streams opened by
+// different sessions share the same core accounting. Streams that started
+// a call within activeSeconds split the usable cores: begin() grants the
+// smaller of the stream's preferred count, an equal share among the active
+// streams, and the cores not granted to calls in flight.
+//
+// With an audio core set, pinCurrentThread() restricts the calling thread
+// to the other cores. On Linux the threads ggml spawns inherit the mask;
+// on Windows only the calling thread is restricted.
+//
+// Every change of a stream's thread count is logged with the loads that
+// caused it.
+class ThreadScheduler {
+    public:
+        ThreadScheduler(const ThreadSchedulerConfig &config, std::ostream &log);
+        ~ThreadScheduler();
+        ThreadScheduler(const ThreadScheduler &) = delete;
+        ThreadScheduler &operator=(const ThreadScheduler &) = delete;
+
+        // Registers a stream and returns its slot for begin()/end().
+        size_t addStream(const std::string &name);
+        // Releases the slot of a stream with no call in flight; addStream()
+        // reuses it.
+        void removeStream(size_t stream);
+
+        // Threads for the stream's next call; must be paired with end().
+        int begin(size_t stream);
+        void end(size_t stream, int threads, double elapsedSeconds, double budgetSeconds);
+
+        // Restricts the calling thread to the inference cores. Returns false
+        // if there is nothing to pin or the platform refused.
+        bool pinCurrentThread() const;
+
+        int usableCores() const;
+        int preferredThreads(size_t stream) const;
+
+        // Cores this process may run on.
+        static std::vector<int> allowedCores();
+    protected:
+    private:
+        struct StreamState {
+            std::string name;
+            int preferred = 1;
+            int granted = 0;            // Last begin() result, to log a cap only when it changes.
+            bool capped = false;
+            int sinceChange = 0;
+            std::chrono::steady_clock::time_point lastBegin;
+            bool started = false;
+            bool removed = false;
+            std::vector<double> load;   // Per thread count; < 0 = not measured.
+            std::vector<uint32_t> calls;
+        };
+
+        void adapt(StreamState &s, int threads);
+
+        ThreadSchedulerConfig config_;
+        std::ostream &log_;
+        std::vector<int> cores_;        // Inference cores (audio core removed).
+        int maxThreads_;
+        mutable std::mutex mutex_;
+        std::vector<StreamState> streams_;
+        int inFlight_;
+        int threadsInUse_;
+};
+
+#endif // THREADSCHEDULER_HPP
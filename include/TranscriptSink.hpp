@@ -0,0 +1,154 @@
+#ifndef TRANSCRIPTSINK_HPP
+#define TRANSCRIPTSINK_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+enum class TranscriptFormat {
+    Jsonl,      // One JSON object per line: index, stream, start, end, text.
+    Srt,        // SubRip cues.
+    WebVtt      // WebVTT cues after a WEBVTT header.
+};
+
+// One published segment. Times are seconds on the stream clock: since
+// capture started, including audio that was dropped.
+struct TranscriptSegment {
+    uint64_t index = 0;         // 1-based, in publish order.
+    int stream = -1;            // Device stream id; -1 with a single device.
+    double start = 0.0;
+    double end = 0.0;
+    std::string text;
+};
+
+// One consumer of formatted segments. append() receives the segment
+// already formatted in format(); the bytes are shared with every other
+// writer of that format and must not be modified.
+class TranscriptWriter {
+    public:
+        explicit TranscriptWriter(TranscriptFormat format) : format_(format) {}
+        virtual ~TranscriptWriter() = default;
+
+        TranscriptFormat format() const { return format_; }
+
+        virtual bool open() = 0;
+        virtual void append(const std::shared_ptr<const std::string> &bytes) = 0;
+        virtual void flush() {}
+        virtual void close() {}
+    protected:
+        TranscriptFormat format_;
+};
+
+// Writes to stdout (or another stream owned by the caller).
+class StreamTranscriptWriter : public TranscriptWriter {
+    public:
+        StreamTranscriptWriter(TranscriptFormat format, std::ostream &out);
+
+        bool open() override;
+        void append(const std::shared_ptr<const std::string> &bytes) override;
+        void flush() override;
+    private:
+        std::ostream &out_;
+};
+
+// Creates (or truncates) the file once when opened and only appends to it
+// afterwards, so a reader tailing it never sees a rewrite.
+class FileTranscriptWriter : public TranscriptWriter {
+    public:
+        FileTranscriptWriter(TranscriptFormat format, const std::string &path);
+
+        bool open() override;
+        void append(const std::shared_ptr<const std::string> &bytes) override;
+        void flush() override;
+        void close() override;
+    private:
+        std::string path_;
+        std::ofstream out_;
+};
+
+// Serves the formatted stream to any number of local TCP clients, e.g. a
+// desktop caption window. A client gets the format's header on connect and
+// every segment published after that. Sends never block the caller: what a
+// client cannot take yet is queued as references to the shared segment
+// bytes and sent by the writer's thread, and a client more than
+// kMaxPendingBytes behind is disconnected.
+class SocketTranscriptWriter : public TranscriptWriter {
+    public:
+        using Socket = intptr_t;    // int on POSIX, SOCKET on Windows.
+
+        SocketTranscriptWriter(TranscriptFormat format, int port, const std::string &bindAddress = "127.0.0.1");
+        ~SocketTranscriptWriter() override;
+
+        bool open() override;
+        void append(const std::shared_ptr<const std::string> &bytes) override;
+        void close() override;
+    private:
+        struct Client {
+            Socket socket;
+            std::deque<std::shared_ptr<const std::string>> pending;
+            size_t offset = 0;      // Bytes of pending.front() already sent.
+            size_t bytes = 0;       // Total queued.
+        };
+
+        void run();
+        bool drain(Client &client);
+        static void closeSocket(Socket socket);
+
+        int port_;
+        std::string bindAddress_;
+        Socket listener_;
+        std::mutex mutex_;
+        std::vector<Client> clients_;
+        std::thread thread_;
+        std::atomic<bool> running_;
+};
+
+// Fans transcript segments out to any number of writers.
+//
+// publish() assigns the segment its index, formats it once per format in
+// use into an immutable buffer and hands that same buffer to each writer of
+// the format: no per-writer copies, and writers only ever append. publish()
+// may be called from several threads.
+class TranscriptSink {
+    public:
+        TranscriptSink();
+        ~TranscriptSink();
+        TranscriptSink(const TranscriptSink &) = delete;
+        TranscriptSink &operator=(const TranscriptSink &) = delete;
+
+        // Adds and opens a writer described by "<format>:<target>": format
+        // jsonl, srt or vtt; target a file path, "-" or "stdout", or
+        // "tcp:<port>" for local clients. Returns false with a message.
+        bool add(const std::string &spec);
+        bool add(std::unique_ptr<TranscriptWriter> writer);
+
+        bool empty() const;
+        bool writesStdout() const;
+
+        // Publishes `text` (trimmed; nothing if empty) for [start, end].
+        void publish(int stream, double start, double end, std::string_view text);
+        void flush();
+        void close();
+
+        static bool parseFormat(const std::string &name, TranscriptFormat &format);
+        // Text a consumer needs before the first segment ("WEBVTT" for WebVTT).
+        static const char *header(TranscriptFormat format);
+        static void format(TranscriptFormat format, const TranscriptSegment &segment, std::string &out);
+        // Appends `text` as a quoted, escaped JSON string.
+        static void appendJsonString(std::string &out, std::string_view text);
+    private:
+        mutable std::mutex mutex_;
+        std::vector<std::unique_ptr<TranscriptWriter>> writers_;
+        bool stdout_;
+        uint64_t next_;
+};
+
+#endif // TRANSCRIPTSINK_HPP
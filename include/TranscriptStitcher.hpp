@@ -0,0 +1,81 @@
+#ifndef TRANSCRIPTSTITCHER_HPP
+#define TRANSCRIPTSTITCHER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "WhisperSession.hpp"
+
+struct StitcherConfig {
+    int slackMs = 300;          // Timestamp tolerance around the overlap region.
+    size_t minMatchTokens = 2;  // Shortest token alignment that is trusted; one
+                                // common token (" the", ",") is often chance.
+    size_t reserveTokens = 512; // Per window; more than a 30 s window decodes to.
+};
+
+// Joins the transcripts of overlapping fixed-mode windows.
+//
+// Each window's text tokens are kept with their absolute timestamps. The
+// tokens of the previous window that end inside the overlap (give or take
+// slackMs) are aligned against the tokens of the new window that start
+// inside it: the longest suffix of the former that is also a prefix of the
+// latter is found by KMP over token IDs in O(n + m), and those tokens are
+// not emitted again. Without an alignment of at least minMatchTokens
+// (Whisper transcribed the overlap differently, or only a common word
+// happens to line up), tokens centred before the end of the previous
+// window's last token are dropped instead.
+//
+// Token text points into the model's vocabulary and the buffers are reused
+// window to window, so stitching allocates nothing once the buffers have
+// grown to the longest window.
+class TranscriptStitcher {
+    public:
+        explicit TranscriptStitcher(const StitcherConfig &config = StitcherConfig());
+        ~TranscriptStitcher();
+
+        // Starts a window of audio beginning at `startSeconds` (since capture
+        // started), whose first `overlapSeconds` were the end of the previous
+        // window.
+        void beginWindow(double startSeconds, double overlapSeconds);
+
+        // Adds a text token; times are centiseconds from the window start.
+        // `text` must outlive the next window.
+        void addToken(whisper_token id, int64_t t0, int64_t t1, const char *text);
+
+        // Adds the tokens of the session's last decode (collectTokens on).
+        void addTokens(const WhisperSession &session);
+
+        // Aligns the window with the previous one and appends the text not
+        // emitted before to `committed`. Returns the number of tokens skipped
+        // as already emitted.
+        size_t commit(std::string &committed);
+
+        // Time span, in seconds since capture started, of the tokens the
+        // last commit() appended. Returns false if it appended none.
+        bool committedSpan(double &start, double &end) const;
+
+        // Forgets the previous window, e.g. after audio was skipped.
+        void reset();
+    protected:
+    private:
+        struct Token {
+            whisper_token id;
+            int64_t t0;     // centiseconds since capture started
+            int64_t t1;
+            const char *text;
+        };
+
+        size_t align() const;
+
+        StitcherConfig config_;
+        std::vector<Token> previous_;
+        std::vector<Token> current_;
+        mutable std::vector<size_t> failure_;  // KMP failure function of the current head.
+        int64_t windowStart_;
+        int64_t overlapEnd_;
+        size_t lastSkip_;               // Tokens of previous_ the last commit skipped.
+};
+
+#endif // TRANSCRIPTSTITCHER_HPP
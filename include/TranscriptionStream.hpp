@@ -0,0 +1,138 @@
+#ifndef TRANSCRIPTIONSTREAM_HPP
+#define TRANSCRIPTIONSTREAM_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "portaudio.h"
+#include "whisper.h"
+
+#include "AudioCapture.hpp"
+#include "AudioSink.hpp"
+#include "BoundedQueue.hpp"
+#include "RingBuffer.hpp"
+#include "ChunkAssembler.hpp"
+#include "UtteranceSegmenter.hpp"
+#include "ThreadScheduler.hpp"
+#include "WhisperSession.hpp"
+
+struct StreamConfig {
+    int whisperRate = 16000;
+    int chunkMs = 100;              // Audio pulled from the ring per assemble().
+    int ringSeconds = 20;
+    int framesPerBuffer = 256;
+    const char *language = "en";
+    int partialMs = 0;              // Decode the open utterance after every partialMs of it; 0: finals only.
+    SegmenterConfig segmenter;
+    VadConfig vad;
+};
+
+// Snapshot of one stream's counters. Latency is measured from the moment
+// the last sample of an utterance was captured to the moment its text was
+// ready, so it includes the segmenter's silence timeout and any time the
+// utterance waited for a free worker.
+struct StreamStats {
+    uint64_t utterances = 0;
+    double audioSeconds = 0.0;
+    double inferenceSeconds = 0.0;
+    double latencyMeanMs = 0.0;
+    double latencyP50Ms = 0.0;
+    double latencyP95Ms = 0.0;
+    double latencyMaxMs = 0.0;
+    uint64_t overruns = 0;
+    uint64_t decodeFailures = 0;    // Not part of the counts and times above.
+};
+
+// One transcript reported by a stream.
+struct StreamResult {
+    const WhisperSession *session = nullptr;    // Text and segments; valid during the callback.
+    double startSeconds = 0.0;      // Utterance start on the stream clock (since capture
+                                    // started, dropped audio included); segment times count from here.
+    bool partial = false;           // The utterance so far; its final result follows.
+    std::chrono::steady_clock::time_point captured;     // Capture of the last sample decoded.
+};
+
+// One capture device feeding utterances to Whisper.
+//
+// Each stream owns its AudioCapture, ring buffer, resampler and
+// segmenter plus a whisper_state on the shared model, so adding a stream
+// costs one state (KV cache and work buffers), not another model copy.
+// process() is driven by the InferenceScheduler's workers; a stream is
+// processed by at most one worker at a time, which keeps its utterances in
+// order and its state unshared.
+class TranscriptionStream {
+    public:
+        using TextCallback = std::function<void(const TranscriptionStream &, const StreamResult &)>;
+
+        TranscriptionStream(int id, whisper_context *ctx, const StreamConfig &config);
+        ~TranscriptionStream();
+        TranscriptionStream(const TranscriptionStream &) = delete;
+        TranscriptionStream &operator=(const TranscriptionStream &) = delete;
+
+        // Opens the device and allocates the whisper_state.
+        bool open(PaDeviceIndex device);
+        bool start();
+        void stop();
+
+        // Pulls captured audio into the segmenter and, if an utterance is
+        // complete, transcribes it with the threads granted by `threads` for
+        // slot `slot` and reports the text. With partialMs set, an utterance
+        // still being spoken is decoded and reported as partial each time it
+        // has grown by partialMs. Returns false without waiting if another
+        // worker holds the stream or there is nothing to decode.
+        bool process(ThreadScheduler &threads, size_t slot, const TextCallback &onText);
+
+        // Notifies `notifier` from the capture callback each time a chunk of
+        // audio has been stored, the only event that can give process()
+        // something new to do; nullptr stops the notifications.
+        void setNotifier(Notifier *notifier);
+        // Chunks captured so far.
+        uint64_t chunksCaptured() const;
+
+        int id() const;
+        const std::string &name() const;
+        StreamStats stats() const;
+    protected:
+    private:
+        class ChunkSink;
+
+        void pump();
+        void record(double audioSeconds, double inferenceSeconds, double latencyMs);
+
+        int id_;
+        std::string name_;
+        whisper_context *ctx_;
+        whisper_state *state_;
+        StreamConfig config_;
+        std::unique_ptr<WhisperSession> session_;
+        std::unique_ptr<AudioCapture> capture_;
+
+        std::unique_ptr<RingBuffer> ring_;
+        std::unique_ptr<ChunkSink> sink_;
+        std::unique_ptr<ChunkAssembler> assembler_;
+        std::unique_ptr<UtteranceSegmenter> segmenter_;
+        Notifier *notifier_;
+        Utterance utterance_;
+        size_t partialSamples_;         // Open utterance length at the last partial.
+
+        // Capture clock: when the segmenter last received audio and how much.
+        std::chrono::steady_clock::time_point lastPush_;
+        uint64_t pushedSamples_;
+        double deviceRate_;
+
+        std::mutex busy_;
+
+        mutable std::mutex statsMutex_;
+        StreamStats stats_;
+        std::vector<float> latencies_;  // Most recent latencies for percentiles.
+        size_t latencyNext_;
+};
+
+#endif // TRANSCRIPTIONSTREAM_HPP
@@ -0,0 +1,93 @@
+#ifndef UTTERANCESEGMENTER_HPP
+#define UTTERANCESEGMENTER_HPP
+
+#include "VoiceActivityDetector.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct SegmenterConfig {
+    int sampleRate = 16000;
+    int minUtteranceMs = 400;       // Shorter speech is treated as a click and dropped.
+    int maxUtteranceMs = 10000;     // Longer speech is force-split.
+    int silenceTimeoutMs = 300;     // Non-speech after the last speech frame before the utterance is flushed.
+    int paddingMs = 150;            // Audio kept in front of the detected speech start.
+    int splitSearchMs = 2000;       // Window before the max length searched for a quiet split point.
+};
+
+// One utterance ready for inference. `start` is the absolute sample index
+// of samples[0] in the 16 kHz stream.
+struct Utterance {
+    uint64_t start = 0;
+    std::vector<float> samples;
+    bool forced = false;            // Cut at max length rather than at a pause.
+};
+
+// Turns a continuous 16 kHz stream into variable-length utterances.
+//
+// Audio is run through a VoiceActivityDetector. Speech segments closer than
+// the silence timeout are merged; once the timeout expires the utterance is
+// emitted. The timeout counts from the last frame classified as speech, not
+// from the end of the VAD hangover, so it may fire while the detector is
+// still open; the utterance then ends at the flush and speech resuming
+// within the hangover starts the next one. Utterances growing past the
+// maximum length are split at the lowest-energy frame near the limit so
+// words are not cut in half.
+class UtteranceSegmenter {
+    public:
+        explicit UtteranceSegmenter(const SegmenterConfig &config = SegmenterConfig(),
+                                    const VadConfig &vadConfig = VadConfig());
+        ~UtteranceSegmenter();
+
+        void push(const float *samples, size_t count);
+
+        // Copies the next ready utterance into `out` (reusing its storage).
+        bool pop(Utterance &out);
+
+        // Copies the utterance still being spoken, up to the latest audio,
+        // into `out`. Returns false, without copying, if none is open or it
+        // is shorter than `minSamples`.
+        bool peekOpen(Utterance &out, size_t minSamples = 0) const;
+
+        // End of stream: emits whatever speech is still open.
+        void flush();
+
+        size_t pending() const;
+        uint64_t droppedShort() const;
+        const VoiceActivityDetector &vad() const;
+    protected:
+    private:
+        struct Range {
+            uint64_t start;
+            uint64_t end;
+            bool forced;
+        };
+
+        void handleSegments();
+        void splitLongUtterance();
+        void emit(uint64_t start, uint64_t end, bool forced);
+        void trim();
+
+        SegmenterConfig config_;
+        VoiceActivityDetector vad_;
+        std::vector<float> audio_;          // Audio from bufferStart_ onwards.
+        uint64_t bufferStart_;
+        std::vector<VadFrame> frames_;      // Frame decisions over audio_.
+        std::vector<SpeechSegment> segments_;
+        std::vector<Range> ready_;
+
+        bool inUtterance_;
+        uint64_t utteranceStart_;
+        uint64_t lastSpeechEnd_;            // End of the utterance audio so far (hangover included).
+        uint64_t lastVoiceEnd_;             // End of the last speech frame; the timeout counts from here.
+        uint64_t droppedShort_;
+
+        size_t minSamples_;
+        size_t maxSamples_;
+        size_t silenceSamples_;
+        size_t paddingSamples_;
+        size_t lookbackSamples_;            // Padding plus the VAD onset, kept while no speech is open.
+        size_t splitSearchSamples_;
+};
+
+#endif // UTTERANCESEGMENTER_HPP
@@ -0,0 +1,61 @@
+#ifndef VIRTUALCAPTUREDEVICE_HPP
+#define VIRTUALCAPTUREDEVICE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AudioSink.hpp"
+#include "WavReader.hpp"
+
+struct VirtualDeviceConfig {
+    std::string source = "null";    // "null" for silence, otherwise a WAV file path.
+    double sampleRate = 48000.0;    // Null device only; files use their own rate.
+    int channels = 2;               // Null device only.
+    unsigned long framesPerBuffer = 256;
+    double speed = 1.0;             // 1 = real time, 0 = as fast as the consumer allows.
+    double tailSeconds = 2.0;       // Silence delivered after the file ends.
+};
+
+// Capture device without hardware, for CI and reproducible runs.
+//
+// A thread delivers interleaved int16 periods to an AudioSink exactly as an
+// AudioCapture stream would, paced at the configured speed. The null source
+// produces silence forever; a file source plays the WAV once, then a short
+// tail of silence so VAD and streaming stages can close their last
+// utterance, and reports finished().
+class VirtualCaptureDevice {
+    public:
+        VirtualCaptureDevice();
+        ~VirtualCaptureDevice();
+        VirtualCaptureDevice(const VirtualCaptureDevice &) = delete;
+        VirtualCaptureDevice &operator=(const VirtualCaptureDevice &) = delete;
+
+        bool open(const VirtualDeviceConfig &config);
+        // Starts delivering periods to `sink`.
+        bool start(AudioSink *sink);
+        void stop();
+
+        bool finished() const;
+        double sampleRate() const;
+        int channels() const;
+        const std::string &name() const;
+    protected:
+    private:
+        void run();
+        size_t fill(int16_t *out, size_t frames);
+
+        VirtualDeviceConfig config_;
+        AudioSink *sink_;
+        WavReader reader_;
+        bool fromFile_;
+        std::string name_;
+        std::vector<int16_t> buffer_;
+        std::thread thread_;
+        std::atomic<bool> running_;
+        std::atomic<bool> finished_;
+};
+
+#endif // VIRTUALCAPTUREDEVICE_HPP
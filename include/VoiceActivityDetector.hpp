@@ -0,0 +1,95 @@
+#ifndef VOICEACTIVITYDETECTOR_HPP
+#define VOICEACTIVITYDETECTOR_HPP
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct VadConfig {
+    int sampleRate = 16000;
+    int frameMs = 16;               // 256 samples at 16 kHz.
+    float energyMarginDb = 9.0f;    // Required level above the tracked noise floor.
+    float minEnergyDb = -55.0f;     // Absolute level (dBFS) below which nothing is speech.
+    float flatnessMax = 0.45f;      // Spectral flatness above this is treated as noise.
+    float fricativeZcr = 0.30f;     // Zero-crossing rate of unvoiced speech.
+    int onsetFrames = 3;            // Consecutive speech frames needed to open a segment.
+    int hangoverFrames = 20;        // Frames kept open after the last speech frame.
+    float floorRise = 0.02f;        // Noise floor adaptation per frame when rising...
+    float floorFall = 0.25f;        // ...and when falling.
+};
+
+// Decision for one analysis frame. `start` is the absolute sample index.
+struct VadFrame {
+    uint64_t start = 0;
+    float energyDb = 0.0f;
+    bool speech = false;            // Smoothed decision (onset + hangover applied).
+};
+
+// Speech region [start, end) in absolute samples. `end` includes the
+// hangover; `speechEnd` is the end of the last frame classified as speech.
+struct SpeechSegment {
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint64_t speechEnd = 0;
+};
+
+// Frame-level voice activity detector for 16 kHz mono audio.
+//
+// Each frame is classified from its energy against an adaptive noise floor,
+// its spectral flatness over the speech band and its zero-crossing rate.
+// Only voiced (tonal) frames can open a segment; unvoiced frames keep it open.
+// The raw decisions are smoothed with an onset counter and a hangover, and
+// the detector reports closed speech segments so only speech is sent to
+// inference. All buffers are sized at construction.
+class VoiceActivityDetector {
+    public:
+        explicit VoiceActivityDetector(const VadConfig &config = VadConfig());
+        ~VoiceActivityDetector();
+
+        // Consumes `count` samples. One VadFrame is appended to `frames` per
+        // completed frame and every segment that closed is appended to
+        // `segments`. Partial frames are carried over to the next call.
+        void process(const float *samples, size_t count,
+                     std::vector<VadFrame> &frames, std::vector<SpeechSegment> &segments);
+
+        // Closes an open segment at the current position (end of stream).
+        bool finish(std::vector<SpeechSegment> &segments);
+
+        bool inSpeech() const;
+        uint64_t speechStart() const;   // Start of the open segment, if inSpeech().
+        uint64_t speechEnd() const;     // End of its last speech frame, if inSpeech().
+        uint64_t position() const;      // Samples analysed so far.
+        size_t frameSize() const;
+        float noiseFloorDb() const;
+
+        void reset();
+    protected:
+    private:
+        void analyseFrame(const float *frame, VadFrame &out, bool &voiced, bool &unvoiced);
+        void fft();
+
+        VadConfig config_;
+        size_t frameSize_;
+        size_t fftSize_;
+        size_t bandLow_;
+        size_t bandHigh_;
+        std::vector<float> window_;
+        std::vector<std::complex<float>> twiddles_;
+        std::vector<uint32_t> bitReverse_;
+        std::vector<std::complex<float>> spectrum_;
+        std::vector<float> pending_;
+        size_t pendingCount_;
+
+        uint64_t position_;
+        uint64_t framesSeen_;
+        float noiseFloorDb_;
+        int onsetCount_;
+        int hangover_;
+        bool inSpeech_;
+        uint64_t candidateStart_;
+        uint64_t speechStart_;
+        uint64_t speechEnd_;            // End of the last speech frame of the open segment.
+};
+
+#endif // VOICEACTIVITYDETECTOR_HPP
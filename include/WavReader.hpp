@@ -0,0 +1,64 @@
+#ifndef WAVREADER_HPP
+#define WAVREADER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "SampleFormat.hpp"
+
+// Memory-mapped reader for RIFF/WAVE files.
+//
+// The file is mapped read-only and read() hands out zero-copy views of the
+// data chunk, so multi-hour recordings are never copied into memory. Plain
+// and WAVE_FORMAT_EXTENSIBLE headers are parsed; 16/24/32-bit integer PCM
+// and 32-bit float are supported. Pages behind the read position are given
+// back to the OS as the file is consumed.
+class WavReader {
+    public:
+        WavReader();
+        ~WavReader();
+        WavReader(const WavReader &) = delete;
+        WavReader &operator=(const WavReader &) = delete;
+
+        bool open(const std::string &path);
+        void close();
+
+        // Returns a view of up to `frames` frames at the read position and
+        // advances past them. The view stays valid until close().
+        AudioView read(size_t frames);
+
+        // View of `frames` frames starting at `frame`; does not move the read position.
+        AudioView view(uint64_t frame, size_t frames) const;
+        bool seek(uint64_t frame);
+
+        int channels() const;
+        int sampleRate() const;
+        SampleFormat format() const;
+        uint64_t totalFrames() const;
+        uint64_t position() const;
+    protected:
+    private:
+        bool map(const std::string &path);
+        bool parse(const std::string &path);
+        void releaseConsumed();
+
+        const uint8_t *base_;       // Start of the mapping.
+        size_t mappedBytes_;
+        const uint8_t *data_;       // Start of the data chunk.
+        size_t released_;           // Bytes of data already handed back to the OS.
+#ifdef _WIN32
+        void *file_;
+        void *mapping_;
+#else
+        int fd_;
+#endif
+        int channels_;
+        int sampleRate_;
+        SampleFormat format_;
+        size_t frameBytes_;
+        uint64_t totalFrames_;
+        uint64_t position_;
+};
+
+#endif // WAVREADER_HPP
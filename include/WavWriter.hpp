@@ -0,0 +1,80 @@
+#ifndef WAVWRITER_HPP
+#define WAVWRITER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class WavWriterMode {
+    PerChunk,   // One file per write() call: <prefix>_<n>.wav.
+    Session     // Everything appended to <prefix>.wav; sizes patched on stop().
+};
+
+struct WavWriterConfig {
+    std::string directory = "debug";
+    std::string prefix = "chunk";
+    WavWriterMode mode = WavWriterMode::PerChunk;
+    int sampleRate = 16000;
+    size_t slots = 16;              // Chunks that can be queued before write() drops.
+    size_t slotSamples = 16000 * 4; // Initial capacity of each slot.
+};
+
+// Mono 16-bit WAV writer that keeps all file I/O off the caller's thread.
+//
+// write() copies the samples into a preallocated slot and returns; a
+// background thread converts the slot to int16 in one vectorised pass and
+// writes it as a single block. When every slot is still waiting to be
+// written the chunk is dropped and counted, so the processing loop is never
+// blocked by the disk.
+class WavWriter {
+    public:
+        explicit WavWriter(const WavWriterConfig &config = WavWriterConfig());
+        ~WavWriter();
+        WavWriter(const WavWriter &) = delete;
+        WavWriter &operator=(const WavWriter &) = delete;
+
+        bool start();
+        // Writes everything still queued, patches the session header and joins.
+        void stop();
+
+        // Queues `count` samples in [-1, 1]. Returns false if the chunk was dropped.
+        bool write(const float *samples, size_t count);
+
+        bool running() const;
+        uint64_t chunksWritten() const;
+        uint64_t chunksDropped() const;
+    protected:
+    private:
+        void worker();
+        void writeChunk(const std::vector<float> &samples);
+        bool writeHeader(FILE *fp, uint32_t dataBytes);
+        void closeSession();
+
+        WavWriterConfig config_;
+
+        std::vector<std::vector<float>> slots_;
+        std::vector<size_t> free_;
+        std::deque<size_t> ready_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        bool stopping_;
+        std::thread thread_;
+
+        std::vector<int16_t> pcm_;      // Writer thread only.
+        FILE *session_;
+        uint64_t sessionBytes_;
+        uint64_t chunkIndex_;
+
+        std::atomic<bool> running_;
+        std::atomic<uint64_t> written_;
+        std::atomic<uint64_t> dropped_;
+};
+
+#endif // WAVWRITER_HPP
@@ -0,0 +1,102 @@
+#ifndef WHISPERSESSION_HPP
+#define WHISPERSESSION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "whisper.h"
+
+struct WhisperSessionConfig {
+    std::string language = "en";
+    bool translate = false;
+    bool noContext = true;          // Whisper's default: no prompt from the previous call.
+    bool tokenTimestamps = false;   // Per-token times for tokens() (fixed-mode stitching).
+    bool collectTokens = false;     // Fill tokens() after each decode.
+    int threads = 4;
+    size_t reserveText = 4096;      // Transcript bytes per call before the arena grows.
+    size_t reserveSegments = 64;
+    size_t reserveTokens = 512;
+};
+
+// A segment of the last decode. `text` views the session's transcript and
+// is valid until the next decode.
+struct SessionSegment {
+    std::string_view text;
+    int64_t t0;                     // centiseconds from the start of the audio
+    int64_t t1;
+    size_t tokenEnd;                // collectTokens: one past its last entry in tokens()
+};
+
+// A text token of the last decode (special and timestamp tokens left out).
+struct SessionToken {
+    whisper_token id;
+    int64_t t0;                     // centiseconds; spread evenly over the segment
+    int64_t t1;                     // when Whisper gave no token timestamps
+    const char *text;               // model vocabulary
+};
+
+// Repeated whisper_full calls on one context (or one whisper_state of it).
+//
+// The decode parameters are built once from the config; prepare() restores
+// them before each call, so per-call changes (n_threads, the overload
+// controller's FastDecode) never leak into the next one. Results are
+// collected into buffers owned by the session: the segment texts are
+// appended to one transcript arena and exposed as string views, tokens
+// point into the model vocabulary. Once the buffers have grown to the
+// longest result they are reused as they are and collecting a result
+// allocates nothing.
+//
+// Without a state the context's own state is used, which the
+// ModelManager warmup has already run. The caller keeps ownership of a
+// state passed in and must not share it between sessions in use at the same
+// time.
+class WhisperSession {
+    public:
+        WhisperSession(whisper_context *ctx, whisper_state *state = nullptr,
+                       const WhisperSessionConfig &config = WhisperSessionConfig());
+        ~WhisperSession();
+
+        WhisperSession(const WhisperSession&) = delete;
+        WhisperSession& operator=(const WhisperSession&) = delete;
+
+        // Resets the parameters to the configured ones with `threads`
+        // threads and returns them for per-call adjustments.
+        whisper_full_params &prepare(int threads);
+        whisper_full_params &params();
+
+        // Runs whisper_full on `count` samples with params() and collects the
+        // result. Returns false (with an empty result) if Whisper failed.
+        bool decode(const float *samples, size_t count);
+
+        // Result of the last decode: the segment texts joined, the segments
+        // and, with collectTokens, the text tokens.
+        std::string_view text() const;
+        const std::vector<SessionSegment> &segments() const;
+        const std::vector<SessionToken> &tokens() const;
+
+        whisper_context *context() const;
+    protected:
+    private:
+        void collect();
+        int segmentCount() const;
+        const char *segmentText(int segment) const;
+        int64_t segmentStart(int segment) const;
+        int64_t segmentEnd(int segment) const;
+        int tokenCount(int segment) const;
+        whisper_token_data tokenData(int segment, int token) const;
+
+        whisper_context *ctx_;
+        whisper_state *state_;
+        WhisperSessionConfig config_;
+        whisper_full_params base_;
+        whisper_full_params params_;
+        std::string text_;
+        std::vector<size_t> ends_;          // End of each segment's text in text_.
+        std::vector<SessionSegment> segments_;
+        std::vector<SessionToken> tokens_;
+};
+
+#endif // WHISPERSESSION_HPP
@@ -0,0 +1,31 @@
+#ifndef LINUX_AUDIO_CAPTURE_HPP
+#define LINUX_AUDIO_CAPTURE_HPP
+
+#include "AudioCapture.hpp"
+#include "LinuxAudioDevice.hpp"
+#include <portaudio.h>
+#include <vector>
+#include <memory>
+
+// Callback-driven capture on ALSA, JACK or PulseAudio. Periods are handed
+// to the sink straight from PortAudio's audio thread.
+class LinuxAudioCapture : public AudioCapture {
+    public:
+        LinuxAudioCapture();
+        ~LinuxAudioCapture() override;
+
+        bool open(AAudioDevice *device, SampleFormat format = SampleFormat::Int16) override;
+        bool start() override;
+        bool stop() override;
+        void close() override;
+        bool isActive() const override;
+    protected:
+    private:
+        static int audioCallback(const void *input, void *output, unsigned long frames,
+                                 const PaStreamCallbackTimeInfo *timeInfo,
+                                 PaStreamCallbackFlags statusFlags, void *userData);
+
+        PaStream *stream_;
+};
+
+#endif // LINUX_AUDIO_CAPTURE_HPP
@@ -0,0 +1,21 @@
+#ifndef LINUXAUDIODEVICE_HPP
+#define LINUXAUDIODEVICE_HPP
+
+#include "AAudioDevice.hpp"
+
+// PortAudio device on one of the Linux host APIs (ALSA, JACK, PulseAudio).
+// PulseAudio monitor sources ("Monitor of ...") capture what a sink plays
+// and are reported as LoopBack devices.
+class LinuxAudioDevice : public AAudioDevice {
+    public:
+        LinuxAudioDevice(int deviceId);
+        ~LinuxAudioDevice();
+        const PaStreamParameters &getStreamParams() const;
+
+        static bool isMonitorSource(const PaDeviceInfo &info);
+    protected:
+    private:
+        PaStreamParameters streamParams_;
+};
+
+#endif // LINUXAUDIODEVICE_HPP
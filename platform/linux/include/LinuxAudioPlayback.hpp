@@ -0,0 +1,22 @@
+#ifndef LINUX_AUDIO_PLAYBACK_HPP
+#define LINUX_AUDIO_PLAYBACK_HPP
+
+#include "AudioPlayback.hpp"
+#include <portaudio.h>
+#include <vector>
+#include <memory>
+
+#include "LinuxAudioDevice.hpp"
+
+class LinuxAudioPlayback : public AudioPlayback {
+    public:
+        LinuxAudioPlayback();
+        ~LinuxAudioPlayback() override;
+
+        bool start(AAudioDevice *device, const AudioView &audio, double sampleRate) override;
+    protected:
+    private:
+        PaStream *stream_;
+};
+
+#endif // LINUX_AUDIO_PLAYBACK_HPP
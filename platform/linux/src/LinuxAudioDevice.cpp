@@ -0,0 +1,41 @@
+#include "LinuxAudioDevice.hpp"
+
+#include <cstring>
+
+LinuxAudioDevice::LinuxAudioDevice(int deviceId) : AAudioDevice(deviceId), streamParams_{} {
+    if (id_ < 0)
+        return;
+    if (deviceType_ == DeviceType::Input && isMonitorSource(*deviceInfo_)) {
+        deviceType_ = DeviceType::LoopBack;
+    }
+    if (getDeviceType() == DeviceType::Input || getDeviceType() == DeviceType::LoopBack) {
+        streamParams_.device = getID();
+        streamParams_.channelCount = deviceInfo_->maxInputChannels;
+        streamParams_.sampleFormat = paInt16;
+        // Low latency: ALSA and JACK deliver small periods straight to the callback.
+        streamParams_.suggestedLatency = deviceInfo_->defaultLowInputLatency;
+        streamParams_.hostApiSpecificStreamInfo = nullptr;
+    } else if (getDeviceType() == DeviceType::Output) {
+        streamParams_.device = getID();
+        streamParams_.channelCount = deviceInfo_->maxOutputChannels;
+        streamParams_.sampleFormat = paInt16;
+        streamParams_.suggestedLatency = deviceInfo_->defaultLowOutputLatency;
+        streamParams_.hostApiSpecificStreamInfo = nullptr;
+    } else {
+        std::cerr << "Unsupported device type." << std::endl;
+    }
+}
+
+LinuxAudioDevice::~LinuxAudioDevice() {}
+
+const PaStreamParameters &LinuxAudioDevice::getStreamParams() const {
+    return streamParams_;
+}
+
+bool LinuxAudioDevice::isMonitorSource(const PaDeviceInfo &info) {
+    if (!info.name)
+        return false;
+    // PulseAudio/PipeWire describe monitors as "Monitor of <sink>"; the raw
+    // source names end in ".monitor".
+    return std::strncmp(info.name, "Monitor of ", 11) == 0 || std::strstr(info.name, ".monitor") != nullptr;
+}
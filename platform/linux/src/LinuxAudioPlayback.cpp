@@ -0,0 +1,59 @@
+#include "LinuxAudioPlayback.hpp"
+#include <algorithm>
+#include <iostream>
+
+LinuxAudioPlayback::LinuxAudioPlayback() : stream_(nullptr) {}
+
+LinuxAudioPlayback::~LinuxAudioPlayback() {
+}
+
+bool LinuxAudioPlayback::start(AAudioDevice *device, const AudioView &audio, double sampleRate) {
+    const LinuxAudioDevice *linuxDevice = dynamic_cast<const LinuxAudioDevice *>(device);
+    if (!linuxDevice) {
+        std::cerr << "Error: The selected device was not created by the Linux backend." << std::endl;
+        return false;
+    }
+    if (audio.channels > linuxDevice->getDeviceInfo().maxOutputChannels) {
+        std::cerr << "Error: " << audio.channels << " channels recorded but the device plays "
+                  << linuxDevice->getDeviceInfo().maxOutputChannels << "." << std::endl;
+        return false;
+    }
+    // Play the recording in its own layout; the device keeps its defaults.
+    PaStreamParameters params = linuxDevice->getStreamParams();
+    params.channelCount = audio.channels;
+    params.sampleFormat = AAudioDevice::toPaSampleFormat(audio.format);
+
+    std::cout << "Setting up playback with " << params.channelCount << " channels at " << sampleRate << " Hz." << std::endl;
+    PaError err = Pa_OpenStream(&stream_, nullptr, &params, sampleRate, 1024, paClipOff, nullptr, nullptr);
+    if (err != paNoError) {
+        std::cerr << "Error opening output stream: " << Pa_GetErrorText(err) << std::endl;
+        return false;
+    }
+    err = Pa_StartStream(stream_);
+    if (err != paNoError) {
+        std::cerr << "Error starting output stream: " << Pa_GetErrorText(err) << std::endl;
+        Pa_CloseStream(stream_);
+        return false;
+    }
+    std::cout << "Playback started successfully on device: " << linuxDevice->getDeviceInfo().name << std::endl;
+    std::cout << "Playing back recorded audio..." << std::endl;
+    const size_t frameBytes = audio.frameBytes();
+    size_t numFramesPlayed = 0;
+    while (numFramesPlayed < audio.frames) {
+        size_t framesToWrite = std::min<size_t>(1024, audio.frames - numFramesPlayed);
+        err = Pa_WriteStream(stream_, audio.data + numFramesPlayed * frameBytes, static_cast<unsigned long>(framesToWrite));
+        if (err != paNoError && err != paOutputUnderflowed) {
+            std::cerr << "Error writing to output stream: " << Pa_GetErrorText(err) << std::endl;
+            break;
+        }
+        numFramesPlayed += framesToWrite;
+    }
+    std::cout << "Finished playback." << std::endl;
+    err = Pa_StopStream(stream_);
+    if (err != paNoError) {
+        std::cerr << "Error stopping output stream: " << Pa_GetErrorText(err) << std::endl;
+    }
+    Pa_CloseStream(stream_);
+    stream_ = nullptr;
+    return true;
+}
@@ -12,19 +12,19 @@ class WindowsAudioCapture : public AudioCapture {
         WindowsAudioCapture();
         ~WindowsAudioCapture() override;
 
-        bool start(AAudioDevice *device, std::chrono::seconds duration) override;
-        bool open_stream(WindowsAudioDevice *windowsDevice);
-        bool read_stream(WindowsAudioDevice *windowsDevice, std::chrono::seconds duration);
-        bool start_stream(WindowsAudioDevice *windowsDevice);
-        bool start_input(WindowsAudioDevice *windowsDevice);
-        bool close_stream();
-        std::vector<uint8_t> getCapturedData() const override;
-        double getSampleRate() const;
+        bool open(AAudioDevice *device, SampleFormat format = SampleFormat::Int16) override;
+        bool start() override;
+        bool stop() override;
+        void close() override;
+        bool isActive() const override;
     protected:
     private:
+        static int audioCallback(const void *input, void *output, unsigned long frames,
+                                 const PaStreamCallbackTimeInfo *timeInfo,
+                                 PaStreamCallbackFlags statusFlags, void *userData);
+
         PaStream *stream_;
-        std::vector<uint8_t> capturedData_;
-        double sampleRate_;
+        PaWasapiStreamInfo wasapiInfo_;
 };
 
 #endif // WINDOWS_AUDIO_CAPTURE_HPP
@@ -6,10 +6,9 @@
 class WindowsAudioDevice : public AAudioDevice {
     public:
         WindowsAudioDevice(int deviceId);
-        WindowsAudioDevice(const AAudioDevice &device);
         ~WindowsAudioDevice();
-        PaWasapiStreamInfo getWasapiInfo() const;
-        PaStreamParameters getStreamParams() const;
+        const PaWasapiStreamInfo &getWasapiInfo() const;
+        const PaStreamParameters &getStreamParams() const;
     protected:
     private:
         PaWasapiStreamInfo wasapiInfo_;
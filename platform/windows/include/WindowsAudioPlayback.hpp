@@ -13,7 +13,7 @@ class WindowsAudioPlayback : public AudioPlayback {
         WindowsAudioPlayback();
         ~WindowsAudioPlayback() override;
         
-        bool start(AAudioDevice *device, std::vector<uint8_t>& data, double sampleRate) override;
+        bool start(AAudioDevice *device, const AudioView &audio, double sampleRate) override;
     protected:
     private:
         PaStream *stream_;
@@ -4,119 +4,94 @@
 #include <windows.h>
 #include <pa_win_wasapi.h>
 
-WindowsAudioCapture::WindowsAudioCapture() : stream_(nullptr), sampleRate_(0) {
+WindowsAudioCapture::WindowsAudioCapture() : stream_(nullptr), wasapiInfo_{} {
 }
 
 WindowsAudioCapture::~WindowsAudioCapture() {
+    close();
 }
 
-bool WindowsAudioCapture::open_stream(WindowsAudioDevice *windowsDevice)
-{
-    PaError err;
+int WindowsAudioCapture::audioCallback(const void *input, void * /*output*/, unsigned long frames,
+                                       const PaStreamCallbackTimeInfo *timeInfo,
+                                       PaStreamCallbackFlags statusFlags, void *userData) {
+    return static_cast<WindowsAudioCapture *>(userData)->deliver(input, frames, timeInfo, statusFlags);
+}
 
-    err = Pa_IsFormatSupported(&windowsDevice->getStreamParams(), nullptr, windowsDevice->getDeviceInfo().defaultSampleRate);
-    if (err != paFormatIsSupported) {
-        std::cerr << "Format not supported for input on this device: " << Pa_GetErrorText(err) << std::endl;
+bool WindowsAudioCapture::open(AAudioDevice *device, SampleFormat format) {
+    close();
+    const WindowsAudioDevice *windowsDevice = dynamic_cast<const WindowsAudioDevice *>(device);
+    if (!windowsDevice) {
+        std::cerr << "Error: The selected device was not created by the Windows backend." << std::endl;
         return false;
     }
-    std::cout << "Configuring input capture with " << windowsDevice->getStreamParams().channelCount << " channels." << std::endl;
-    err = Pa_OpenStream(&stream_, &windowsDevice->getStreamParams(), nullptr, sampleRate_, 1024, paNoFlag, nullptr, nullptr);
-    if (err != paNoError) {
-        std::cerr << "Error opening input stream: " << Pa_GetErrorText(err) << std::endl;
+    if (windowsDevice->getHostAPIInfo().type != paWASAPI) {
+        std::cerr << "Error: The selected device is not using the WASAPI host API." << std::endl;
         return false;
     }
-    return true;
-}
-
-bool WindowsAudioCapture::start_stream(WindowsAudioDevice *windowsDevice) {
-    PaError err;
-
-    err = Pa_StartStream(stream_);
-    std::cout << "Stream started." << std::endl;
-    if (err != paNoError) {
-        std::cerr << "Error starting input stream: " << Pa_GetErrorText(err) << std::endl;
+    if (windowsDevice->getDeviceType() != DeviceType::Input && windowsDevice->getDeviceType() != DeviceType::LoopBack) {
+        std::cerr << "Unsupported device type." << std::endl;
         return false;
     }
-    std::cout << "Audio capture started on device: " << windowsDevice->getDeviceInfo().name
-              << " with " << windowsDevice->getStreamParams().channelCount << " channels " << sampleRate_ << " Hz." << std::endl;
-    return true;
-}
+    // The one copy needed to override the sample format; the device keeps its defaults.
+    PaStreamParameters params = windowsDevice->getStreamParams();
+    params.sampleFormat = AAudioDevice::toPaSampleFormat(format);
+    // Let WASAPI convert when the mix format differs from the requested one.
+    wasapiInfo_ = windowsDevice->getWasapiInfo();
+    params.hostApiSpecificStreamInfo = &wasapiInfo_;
+    double sampleRate = windowsDevice->getDeviceInfo().defaultSampleRate;
 
-bool WindowsAudioCapture::read_stream(WindowsAudioDevice *windowsDevice, std::chrono::seconds duration) {
-    PaError err;
-    long totalFrames = static_cast<long>(duration.count()) * static_cast<long>(sampleRate_);
-    long numFramesCaptured = 0;
-    size_t numSamples = totalFrames * windowsDevice->getStreamParams().channelCount;
-    size_t bytesPerSample = Pa_GetSampleSize(windowsDevice->getStreamParams().sampleFormat);
-    // Allocate buffer for recording
-    if (bytesPerSample == paSampleFormatNotSupported) {
-        std::cerr << "Sample format not supported." << std::endl;
+    PaError err = Pa_IsFormatSupported(&params, nullptr, sampleRate);
+    if (err != paFormatIsSupported) {
+        std::cerr << "Format not supported for input on this device: " << Pa_GetErrorText(err) << std::endl;
         return false;
     }
-    capturedData_.resize(numSamples * bytesPerSample);
-    std::cout << "Recording..." << std::endl;
-    while (numFramesCaptured < totalFrames) {
-        long framesToRead = 1024;
-        if (numFramesCaptured + framesToRead > totalFrames) {
-            framesToRead = totalFrames - numFramesCaptured;
-        }
-        void* bufferPtr = capturedData_.data() + numFramesCaptured * windowsDevice->getStreamParams().channelCount * bytesPerSample;
-        err = Pa_ReadStream(stream_, bufferPtr, framesToRead);
-        if (err != paNoError) {
-            std::cerr << "Error reading from stream: " << Pa_GetErrorText(err) << std::endl;
-            return false;
-        }
-        numFramesCaptured += framesToRead;
+    std::cout << "Configuring input capture with " << params.channelCount << " channels." << std::endl;
+    err = Pa_OpenStream(&stream_, &params, nullptr, sampleRate, framesPerBuffer_, paClipOff,
+                        &WindowsAudioCapture::audioCallback, this);
+    if (err != paNoError) {
+        std::cerr << "Error opening input stream: " << Pa_GetErrorText(err) << std::endl;
+        stream_ = nullptr;
+        return false;
     }
-    std::cout << "Finished recording." << std::endl;
+    format_.sampleRate = sampleRate;
+    format_.channels = params.channelCount;
+    format_.format = format;
     return true;
 }
 
-bool WindowsAudioCapture::start(AAudioDevice *device, std::chrono::seconds duration) {
-    WindowsAudioDevice windowsDevice(*device);
-
-    if (windowsDevice.getHostAPIInfo().type != paWASAPI) {
-        std::cerr << "Error: The selected device is not using the WASAPI host API." << std::endl;
+bool WindowsAudioCapture::start() {
+    if (!stream_)
         return false;
-    }
-    if (windowsDevice.getDeviceType() == DeviceType::Input || windowsDevice.getDeviceType() == DeviceType::LoopBack) {
-        sampleRate_ = windowsDevice.getDeviceInfo().defaultSampleRate;
-        if (!open_stream(&windowsDevice)) {
-            return false;
-        }
-        if (!start_stream(&windowsDevice)) {
-            Pa_CloseStream(stream_);
-            return false;
-        }
-        if (!read_stream(&windowsDevice, duration)) {
-            Pa_StopStream(stream_);
-            Pa_CloseStream(stream_);
-            return false;
-        }
-        Pa_StopStream(stream_);
-        Pa_CloseStream(stream_);
-    } else {
-        std::cerr << "Unsupported device type." << std::endl;
+    framesDelivered_ = 0;
+    PaError err = Pa_StartStream(stream_);
+    if (err != paNoError) {
+        std::cerr << "Error starting input stream: " << Pa_GetErrorText(err) << std::endl;
         return false;
     }
+    std::cout << "Audio capture started with " << format_.channels << " channels " << format_.sampleRate
+              << " Hz (" << sampleFormatName(format_.format) << ")." << std::endl;
     return true;
 }
 
-bool WindowsAudioCapture::close_stream() {
-    PaError err;
-    err = Pa_StopStream(stream_);
+bool WindowsAudioCapture::stop() {
+    if (!stream_ || Pa_IsStreamActive(stream_) != 1)
+        return true;
+    PaError err = Pa_StopStream(stream_);
     if (err != paNoError) {
         std::cerr << "Error stopping input stream: " << Pa_GetErrorText(err) << std::endl;
         return false;
     }
-    Pa_CloseStream(stream_);
     return true;
 }
 
-std::vector<uint8_t> WindowsAudioCapture::getCapturedData() const {
-    return capturedData_;
+void WindowsAudioCapture::close() {
+    if (!stream_)
+        return;
+    stop();
+    Pa_CloseStream(stream_);
+    stream_ = nullptr;
 }
 
-double WindowsAudioCapture::getSampleRate() const {
-    return sampleRate_;
+bool WindowsAudioCapture::isActive() const {
+    return stream_ && Pa_IsStreamActive(stream_) == 1;
 }
@@ -34,14 +34,12 @@ WindowsAudioDevice::WindowsAudioDevice(int deviceId) : AAudioDevice(deviceId) {
     }
 }
 
-WindowsAudioDevice::WindowsAudioDevice(const AAudioDevice &device) : WindowsAudioDevice(device.getID()) {}
-
 WindowsAudioDevice::~WindowsAudioDevice() {}
 
-PaWasapiStreamInfo WindowsAudioDevice::getWasapiInfo() const {
+const PaWasapiStreamInfo &WindowsAudioDevice::getWasapiInfo() const {
     return wasapiInfo_;
 }
 
-PaStreamParameters WindowsAudioDevice::getStreamParams() const {
+const PaStreamParameters &WindowsAudioDevice::getStreamParams() const {
     return streamParams_;
 }
@@ -1,4 +1,5 @@
 #include "WindowsAudioPlayback.hpp"
+#include <algorithm>
 #include <iostream>
 
 WindowsAudioPlayback::WindowsAudioPlayback() : stream_(nullptr) {}
@@ -6,11 +7,24 @@ WindowsAudioPlayback::WindowsAudioPlayback() : stream_(nullptr) {}
 WindowsAudioPlayback::~WindowsAudioPlayback() {
 }
 
-bool WindowsAudioPlayback::start(AAudioDevice *device, std::vector<uint8_t> &capturedData, double sampleRate) {
-    WindowsAudioDevice windowsDevice(*device);
+bool WindowsAudioPlayback::start(AAudioDevice *device, const AudioView &audio, double sampleRate) {
+    const WindowsAudioDevice *windowsDevice = dynamic_cast<const WindowsAudioDevice *>(device);
+    if (!windowsDevice) {
+        std::cerr << "Error: The selected device was not created by the Windows backend." << std::endl;
+        return false;
+    }
+    if (audio.channels > windowsDevice->getDeviceInfo().maxOutputChannels) {
+        std::cerr << "Error: " << audio.channels << " channels recorded but the device plays "
+                  << windowsDevice->getDeviceInfo().maxOutputChannels << "." << std::endl;
+        return false;
+    }
+    // Play the recording in its own layout; the device keeps its defaults.
+    PaStreamParameters params = windowsDevice->getStreamParams();
+    params.channelCount = audio.channels;
+    params.sampleFormat = AAudioDevice::toPaSampleFormat(audio.format);
 
-    std::cout << "Setting up playback with " << windowsDevice.getDeviceInfo().maxOutputChannels << " channels at " << windowsDevice.getDeviceInfo().defaultSampleRate << " Hz." << std::endl;
-    PaError err = Pa_OpenStream(&stream_, nullptr, &windowsDevice.getStreamParams(), sampleRate, 1024, paClipOff, nullptr, nullptr);
+    std::cout << "Setting up playback with " << params.channelCount << " channels at " << sampleRate << " Hz." << std::endl;
+    PaError err = Pa_OpenStream(&stream_, nullptr, &params, sampleRate, 1024, paClipOff, nullptr, nullptr);
     if (err != paNoError) {
         std::cerr << "Error opening output stream: " << Pa_GetErrorText(err) << std::endl;
         return false;
@@ -21,18 +35,13 @@ bool WindowsAudioPlayback::start(AAudioDevice *device, std::vector<uint8_t> &cap
         Pa_CloseStream(stream_);
         return false;
     }
-    std::cout << "Playback started successfully on device: " << windowsDevice.getDeviceInfo().name << std::endl;
+    std::cout << "Playback started successfully on device: " << windowsDevice->getDeviceInfo().name << std::endl;
     std::cout << "Playing back recorded audio..." << std::endl;
-    long numFramesPlayed = 0;
-    long totalFrames = 5 * static_cast<long>(sampleRate);
-    size_t bytesPerSample = Pa_GetSampleSize(paInt16);
-    while (numFramesPlayed < totalFrames) {
-        long framesToWrite = 1024;
-        if (numFramesPlayed + framesToWrite > totalFrames) {
-            framesToWrite = totalFrames - numFramesPlayed;
-        }
-        void *bufferPtr = capturedData.data() + numFramesPlayed * device->getDeviceInfo().maxOutputChannels * bytesPerSample;
-        err = Pa_WriteStream(stream_, bufferPtr, framesToWrite);
+    const size_t frameBytes = audio.frameBytes();
+    size_t numFramesPlayed = 0;
+    while (numFramesPlayed < audio.frames) {
+        size_t framesToWrite = std::min<size_t>(1024, audio.frames - numFramesPlayed);
+        err = Pa_WriteStream(stream_, audio.data + numFramesPlayed * frameBytes, static_cast<unsigned long>(framesToWrite));
         if (err != paNoError) {
             std::cerr << "Error writing to output stream: " << Pa_GetErrorText(err) << std::endl;
             break;
@@ -45,5 +54,6 @@ bool WindowsAudioPlayback::start(AAudioDevice *device, std::vector<uint8_t> &cap
         std::cerr << "Error stopping output stream: " << Pa_GetErrorText(err) << std::endl;
     }
     Pa_CloseStream(stream_);
+    stream_ = nullptr;
     return true;
 }
@@ -2,6 +2,8 @@
 
 #ifdef _WIN32
 #include "WindowsAudioDevice.hpp"
+#elif defined(__linux__)
+#include "LinuxAudioDevice.hpp"
 #endif
 
 AAudioDevice::AAudioDevice(int deviceId) {
@@ -38,17 +40,29 @@ DeviceType AAudioDevice::getDeviceType() const {
     return deviceType_;
 }
 
-PaDeviceInfo AAudioDevice::getDeviceInfo() const {
+const PaDeviceInfo &AAudioDevice::getDeviceInfo() const {
     return *deviceInfo_;
 }
 
-PaHostApiInfo AAudioDevice::getHostAPIInfo() const {
+const PaHostApiInfo &AAudioDevice::getHostAPIInfo() const {
     return *hostApiInfo_;
 }
 
+PaSampleFormat AAudioDevice::toPaSampleFormat(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::Int16:   return paInt16;
+        case SampleFormat::Int24:   return paInt24;
+        case SampleFormat::Int32:   return paInt32;
+        case SampleFormat::Float32: return paFloat32;
+    }
+    return paInt16;
+}
+
 std::unique_ptr<AAudioDevice> AAudioDevice::createInstance(int deviceId) {
 #ifdef _WIN32
     return std::make_unique<WindowsAudioDevice>(deviceId);
+#elif defined(__linux__)
+    return std::make_unique<LinuxAudioDevice>(deviceId);
 #else
     // Add support for other platforms as needed
     return nullptr;
@@ -0,0 +1,428 @@
+#include "AppConfig.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "BatchTranscriber.hpp"
+#include "TranscriptSink.hpp"
+
+struct OptionSpec {
+    const char *name;
+    char shortName;     // 0 = long form only
+    bool takesValue;
+};
+
+static const OptionSpec kOptions[] = {
+    {"help", 'h', false},
+    {"config", 'c', true},
+    {"fixed", 'f', false},
+    {"vad", 'v', false},
+    {"stream", 's', false},
+    {"mode", 0, true},
+    {"model", 'm', true},
+    {"fallback-model", 0, true},
+    {"no-warmup", 0, false},
+    {"input", 'i', true},
+    {"jobs", 'j', true},
+    {"host-api", 0, true},
+    {"device", 'D', true},
+    {"workers", 'w', true},
+    {"threads", 't', true},
+    {"audio-core", 0, true},
+    {"overload", 0, true},
+    {"chunk-ms", 0, true},
+    {"keep-ms", 0, true},
+    {"frames-per-buffer", 0, true},
+    {"vad-threshold", 0, true},
+    {"vad-floor", 0, true},
+    {"virtual", 0, true},
+    {"metrics", 0, true},
+    {"metrics-port", 0, true},
+    {"output", 'o', true},
+    {"serve", 0, true},
+    {"debug", 'd', false},
+    {"debug-session", 0, false},
+};
+
+// Where the values of one parse come from (for messages) and which list
+// options the command line has started replacing.
+struct ParseState {
+    std::string file;       // Empty for the command line.
+    int line = 0;
+    bool devicesReplaced = false;
+    bool inputsReplaced = false;
+    bool outputsReplaced = false;
+};
+
+static const OptionSpec *findOption(const std::string &name) {
+    for (const OptionSpec &option : kOptions) {
+        if (name == option.name)
+            return &option;
+    }
+    return nullptr;
+}
+
+static const OptionSpec *findShortOption(char c) {
+    for (const OptionSpec &option : kOptions) {
+        if (option.shortName != 0 && option.shortName == c)
+            return &option;
+    }
+    return nullptr;
+}
+
+static std::string lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+static std::string trim(const std::string &text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos)
+        return "";
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+static bool toInt(const std::string &text, int &value) {
+    if (text.empty())
+        return false;
+    char *end = nullptr;
+    errno = 0;
+    long v = std::strtol(text.c_str(), &end, 10);
+    if (*end != '\0' || errno != 0 || v < -2147483647L || v > 2147483647L)
+        return false;
+    value = static_cast<int>(v);
+    return true;
+}
+
+static bool toDouble(const std::string &text, double &value) {
+    if (text.empty())
+        return false;
+    char *end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return *end == '\0';
+}
+
+static std::ostream &error(const ParseState &state, const OptionSpec &option) {
+    std::cerr << "Error: ";
+    if (state.file.empty())
+        std::cerr << "--" << option.name;
+    else
+        std::cerr << state.file << ":" << state.line << ": " << option.name;
+    return std::cerr;
+}
+
+static bool apply(AppConfig &config, const OptionSpec &option, const std::string &value, ParseState &state) {
+    const std::string name = option.name;
+    int n = 0;
+    double x = 0.0;
+    if (name == "help") {
+        config.help = true;
+    } else if (name == "config") {
+        error(state, option) << ": a configuration file cannot include another." << std::endl;
+        return false;
+    } else if (name == "fixed" || name == "vad" || name == "stream") {
+        config.mode = name;
+    } else if (name == "mode") {
+        if (value != "fixed" && value != "vad" && value != "stream") {
+            error(state, option) << " expects fixed, vad or stream." << std::endl;
+            return false;
+        }
+        config.mode = value;
+    } else if (name == "model") {
+        config.modelPath = value;
+    } else if (name == "fallback-model") {
+        config.fallbackModelPath = value;
+    } else if (name == "no-warmup") {
+        config.warmup = false;
+    } else if (name == "input") {
+        std::vector<std::string> files = BatchTranscriber::collectInputs(value);
+        if (files.empty()) {
+            error(state, option) << ": no input files match " << value << std::endl;
+            return false;
+        }
+        if (state.file.empty() && !state.inputsReplaced) {
+            config.inputs.clear();
+            state.inputsReplaced = true;
+        }
+        config.inputs.insert(config.inputs.end(), files.begin(), files.end());
+    } else if (name == "jobs" || name == "workers") {
+        if (!toInt(value, n) || n < 1) {
+            error(state, option) << " expects a positive number." << std::endl;
+            return false;
+        }
+        (name == "jobs" ? config.jobs : config.workers) = n;
+    } else if (name == "host-api") {
+        config.hostApi = value;
+    } else if (name == "device") {
+        if (value.empty()) {
+            error(state, option) << " expects a device index or name." << std::endl;
+            return false;
+        }
+        if (state.file.empty() && !state.devicesReplaced) {
+            config.devices.clear();
+            state.devicesReplaced = true;
+        }
+        config.devices.push_back(value);
+    } else if (name == "output") {
+        size_t colon = value.find(':');
+        TranscriptFormat format;
+        if (colon == std::string::npos || colon + 1 == value.size() ||
+            !TranscriptSink::parseFormat(value.substr(0, colon), format)) {
+            error(state, option) << " expects <jsonl|srt|vtt>:<file|-|tcp:PORT>." << std::endl;
+            return false;
+        }
+        if (state.file.empty() && !state.outputsReplaced) {
+            config.outputs.clear();
+            state.outputsReplaced = true;
+        }
+        config.outputs.push_back(value);
+    } else if (name == "threads") {
+        if (value == "auto") {
+            config.threads.fixedThreads = 0;
+        } else if (toInt(value, n) && n >= 1) {
+            config.threads.fixedThreads = n;
+        } else {
+            error(state, option) << " expects a positive number or 'auto'." << std::endl;
+            return false;
+        }
+    } else if (name == "audio-core") {
+        if (!toInt(value, n) || n < 0) {
+            error(state, option) << " expects a core number." << std::endl;
+            return false;
+        }
+        config.threads.audioCore = n;
+    } else if (name == "overload") {
+        if (!OverloadController::parseOrder(value, config.overload.order)) {
+            error(state, option) << " expects a list of silence, fast, model, coalesce or 'off'." << std::endl;
+            return false;
+        }
+    } else if (name == "chunk-ms" || name == "frames-per-buffer") {
+        if (!toInt(value, n) || n < 1) {
+            error(state, option) << " expects a positive number." << std::endl;
+            return false;
+        }
+        (name == "chunk-ms" ? config.chunkMs : config.framesPerBuffer) = n;
+    } else if (name == "keep-ms") {
+        if (!toInt(value, n) || n < 0 || n >= static_cast<int>(config.recordSeconds * 1000.0f)) {
+            error(state, option) << " expects milliseconds shorter than the "
+                                 << config.recordSeconds << " s window." << std::endl;
+            return false;
+        }
+        config.keepMs = n;
+    } else if (name == "vad-threshold") {
+        if (!toDouble(value, x) || x <= 0.0) {
+            error(state, option) << " expects a positive margin in dB." << std::endl;
+            return false;
+        }
+        config.vad.energyMarginDb = static_cast<float>(x);
+    } else if (name == "vad-floor") {
+        if (!toDouble(value, x) || x > 0.0) {
+            error(state, option) << " expects a level in dBFS (0 or below)." << std::endl;
+            return false;
+        }
+        config.vad.minEnergyDb = static_cast<float>(x);
+    } else if (name == "virtual") {
+        config.virtualSource = value;
+    } else if (name == "serve") {
+        if (value.empty()) {
+            error(state, option) << " expects a socket path." << std::endl;
+            return false;
+        }
+        config.servePath = value;
+    } else if (name == "metrics") {
+        if (!toDouble(value, x) || x <= 0.0) {
+            error(state, option) << " expects an interval in seconds." << std::endl;
+            return false;
+        }
+        config.metrics.intervalSeconds = x;
+    } else if (name == "metrics-port") {
+        if (!toInt(value, n) || n < 1 || n > 65535) {
+            error(state, option) << " expects a TCP port." << std::endl;
+            return false;
+        }
+        config.metrics.port = n;
+    } else if (name == "debug") {
+        config.debug = true;
+    } else if (name == "debug-session") {
+        config.debug = true;
+        config.debugSession = true;
+    }
+    return true;
+}
+
+bool AppConfig::parse(int argc, char *argv[]) {
+    // The file first, wherever -c/--config appears, so the command line wins.
+    static const std::string kConfigPrefix = "--config=";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, kConfigPrefix.size(), kConfigPrefix) == 0) {
+            if (!loadFile(arg.substr(kConfigPrefix.size())))
+                return false;
+            break;
+        }
+        if ((arg == "-c" || arg == "--config") && i + 1 < argc) {
+            if (!loadFile(argv[i + 1]))
+                return false;
+            break;
+        }
+    }
+
+    ParseState state;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const OptionSpec *option = nullptr;
+        std::string value;
+        bool inlineValue = false;
+        if (arg.size() > 2 && arg[0] == '-' && arg[1] == '-') {
+            std::string name = arg.substr(2);
+            size_t eq = name.find('=');
+            if (eq != std::string::npos) {
+                value = name.substr(eq + 1);
+                name = name.substr(0, eq);
+                inlineValue = true;
+            }
+            option = findOption(name);
+        } else if (arg.size() == 2 && arg[0] == '-') {
+            option = findShortOption(arg[1]);
+        }
+        if (!option) {
+            std::cerr << "Error: Unknown option " << arg << " (see --help)." << std::endl;
+            return false;
+        }
+        if (option->takesValue && !inlineValue) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << arg << " expects a value." << std::endl;
+                return false;
+            }
+            value = argv[++i];
+        }
+        if (std::string(option->name) == "config")
+            continue;   // already read
+        if (!apply(*this, *option, value, state))
+            return false;
+    }
+    return true;
+}
+
+bool AppConfig::loadFile(const std::string &path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot read configuration file " << path << std::endl;
+        return false;
+    }
+    ParseState state;
+    state.file = path;
+    std::string line;
+    while (std::getline(file, line)) {
+        state.line++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos)
+            line.erase(hash);
+        line = trim(line);
+        if (line.empty())
+            continue;
+        size_t eq = line.find('=');
+        std::string key = trim(line.substr(0, eq));
+        std::string value = eq == std::string::npos ? "" : trim(line.substr(eq + 1));
+        const OptionSpec *option = findOption(key);
+        if (!option) {
+            std::cerr << "Error: " << path << ":" << state.line << ": unknown key " << key << std::endl;
+            return false;
+        }
+        if (!option->takesValue) {
+            std::string flag = lower(value);
+            if (flag == "false" || flag == "no" || flag == "0")
+                continue;
+            if (!flag.empty() && flag != "true" && flag != "yes" && flag != "1") {
+                std::cerr << "Error: " << path << ":" << state.line << ": " << key
+                          << " is a flag (true or false)." << std::endl;
+                return false;
+            }
+        } else if (eq == std::string::npos) {
+            std::cerr << "Error: " << path << ":" << state.line << ": " << key << " expects a value." << std::endl;
+            return false;
+        }
+        if (!apply(*this, *option, value, state))
+            return false;
+    }
+    return true;
+}
+
+int AppConfig::match(const std::string &spec, const std::vector<std::string> &names) {
+    int index = 0;
+    if (toInt(spec, index))
+        return index >= 0 && index < static_cast<int>(names.size()) ? index : -1;
+    const std::string wanted = lower(spec);
+    int partial = -1;
+    int partialCount = 0;
+    for (size_t i = 0; i < names.size(); i++) {
+        std::string name = lower(names[i]);
+        if (name == wanted)
+            return static_cast<int>(i);
+        if (name.find(wanted) != std::string::npos) {
+            partial = static_cast<int>(i);
+            partialCount++;
+        }
+    }
+    return partialCount == 1 ? partial : -1;
+}
+
+void AppConfig::printUsage(const char *program) {
+    std::cout << "Usage: " << program << " [options]" << std::endl
+    << "Options:" << std::endl
+    << "  -h, --help           Show this help message" << std::endl
+    << "  -c, --config <path>  Read options from a file of 'key = value' lines (keys are the" << std::endl
+    << "                       long option names); the command line overrides it" << std::endl
+    << "  -f, --fixed          Use fixed mode without VAD processing (default)" << std::endl
+    << "  -v, --vad            VAD mode: transcribe speech utterances as they end" << std::endl
+    << "  -s, --stream         Streaming mode (rolling window, commits stable segments)" << std::endl
+    << "      --mode <m>       fixed, vad or stream" << std::endl
+    << "  -m, --model <path>   Path to the Whisper model file" << std::endl
+    << "  -i, --input <path>   Transcribe a WAV file, directory or pattern offline (repeatable)" << std::endl
+    << "  -j, --jobs <n>       Parallel Whisper states for offline input (default 1)" << std::endl
+    << "      --host-api <name>" << std::endl
+    << "                       Host API to list devices from (e.g. WASAPI, ALSA, PulseAudio)" << std::endl
+    << "  -D, --device <n|name>" << std::endl
+    << "                       Capture device by index in the list or by (part of) its name;" << std::endl
+    << "                       repeat to caption several devices at once with one shared" << std::endl
+    << "                       model (default: the host API's default input)" << std::endl
+    << "  -w, --workers <n>    Inference workers shared by all devices (default 2)" << std::endl
+    << "  -t, --threads <n>    Whisper threads per call; 'auto' (default) adapts the count" << std::endl
+    << "                       to the measured decode time" << std::endl
+    << "      --audio-core <n> Keep inference threads off core <n>, leaving it to the audio" << std::endl
+    << "                       callback" << std::endl
+    << "      --overload <steps>" << std::endl
+    << "                       When Whisper falls behind, enable these in order (comma-" << std::endl
+    << "                       separated): silence, fast, model, coalesce; or 'off'" << std::endl
+    << "                       (default silence,fast,model,coalesce)" << std::endl
+    << "      --fallback-model <path>" << std::endl
+    << "                       Smaller model for the 'model' overload step" << std::endl
+    << "      --no-warmup      Skip the warmup inference run before audio is accepted" << std::endl
+    << "      --chunk-ms <ms>  Audio pulled per step in VAD and streaming mode (default 100)" << std::endl
+    << "      --keep-ms <ms>   Overlap between fixed-mode windows (default 200)" << std::endl
+    << "      --frames-per-buffer <n>" << std::endl
+    << "                       Frames per audio callback (default 256)" << std::endl
+    << "      --vad-threshold <dB>" << std::endl
+    << "                       Level above the noise floor that counts as speech (default 9)" << std::endl
+    << "      --vad-floor <dBFS>" << std::endl
+    << "                       Level below which nothing is speech (default -55)" << std::endl
+    << "      --virtual <src>  Capture from a virtual device instead of hardware: a WAV" << std::endl
+    << "                       file played in real time, or 'null' for silence" << std::endl
+    << "      --metrics <sec>  Log per-stage latency and counters as a JSON line every <sec>" << std::endl
+    << "      --metrics-port <port>" << std::endl
+    << "                       Serve Prometheus metrics at http://127.0.0.1:<port>/metrics" << std::endl
+    << "  -o, --output <format:target>" << std::endl
+    << "                       Write timestamped segments as jsonl, srt or vtt to a file," << std::endl
+    << "                       '-' for stdout or tcp:<port> for local clients (repeatable)" << std::endl
+    << "      --serve <path>   Wait for a local frontend on Unix domain socket <path>; it" << std::endl
+    << "                       starts and stops sessions and receives transcript events" << std::endl
+    << "  -d, --debug          Enable debug mode (saves WAV files for each chunk)" << std::endl
+    << "      --debug-session  Debug mode, but append all chunks to one debug/session.wav" << std::endl
+    << "Stop with Ctrl+C (SIGINT) or SIGTERM." << std::endl;
+}
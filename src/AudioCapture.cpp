@@ -2,11 +2,48 @@
 
 #ifdef _WIN32
 #include "WindowsAudioCapture.hpp"
+#elif defined(__linux__)
+#include "LinuxAudioCapture.hpp"
 #endif
 
+void AudioCapture::setSink(AudioSink *sink) {
+    sink_ = sink;
+}
+
+void AudioCapture::setFramesPerBuffer(unsigned long frames) {
+    framesPerBuffer_ = frames;
+}
+
+const CaptureFormat &AudioCapture::getFormat() const {
+    return format_;
+}
+
+uint64_t AudioCapture::framesCaptured() const {
+    return framesDelivered_;
+}
+
+int AudioCapture::deliver(const void *input, unsigned long frames, const PaStreamCallbackTimeInfo *timeInfo,
+                          PaStreamCallbackFlags statusFlags) {
+    if (!input || !sink_)
+        return paContinue;
+    CaptureBlock block;
+    block.audio.data = static_cast<const uint8_t *>(input);
+    block.audio.frames = frames;
+    block.audio.channels = format_.channels;
+    block.audio.format = format_.format;
+    block.frameIndex = framesDelivered_;
+    block.adcTime = timeInfo ? timeInfo->inputBufferAdcTime : 0.0;
+    block.overflow = (statusFlags & paInputOverflow) != 0;
+    sink_->onAudio(block);
+    framesDelivered_ += frames;
+    return paContinue;
+}
+
 std::unique_ptr<AudioCapture> AudioCapture::createInstance() {
 #ifdef _WIN32
     return std::make_unique<WindowsAudioCapture>();
+#elif defined(__linux__)
+    return std::make_unique<LinuxAudioCapture>();
 #else
     // Add support for other platforms as needed
     return nullptr;
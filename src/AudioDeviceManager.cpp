@@ -1,6 +1,10 @@
 #include "AudioDeviceManager.hpp"
 
-AudioDeviceManager::AudioDeviceManager() {
+#include <algorithm>
+
+#include "AppConfig.hpp"
+
+AudioDeviceManager::AudioDeviceManager(const DeviceSelection &selection) : selection_(selection) {
     selectedHostAPI_ = paInDevelopment;
     selectedRecordingDevice_ = nullptr;
     selectedPlaybackDevice_ = nullptr;
@@ -13,6 +17,24 @@ AudioDeviceManager::~AudioDeviceManager() {
     Pa_Terminate();
 }
 
+std::string AudioDeviceManager::choose(const std::string &preset, const char *prompt,
+                                       const std::vector<std::string> &names) const {
+    std::string input;
+    if (!preset.empty()) {
+        int index = AppConfig::match(preset, names);
+        if (index < 0) {
+            std::cerr << "'" << preset << "' matches no single entry; using the default." << std::endl;
+            return "";
+        }
+        return std::to_string(index);
+    }
+    if (selection_.interactive) {
+        std::cout << prompt;
+        std::getline(std::cin, input); // Read the entire input line
+    }
+    return input;
+}
+
 bool AudioDeviceManager::initDevices() {
     PaDeviceIndex numDevices = Pa_GetDeviceCount();
     if (numDevices < 0) {
@@ -86,10 +108,12 @@ bool AudioDeviceManager::selectHostAPI() {
     PaHostApiIndex defaultHostAPIIndex = Pa_GetDefaultHostApi();
     listAvailableHostAPIs(numHostAPIs, defaultHostAPIIndex);
 
-    // Prompt user for selection
-    std::cout << "Enter host API index to use (press Enter to use default): ";
-    std::string input;
-    std::getline(std::cin, input); // Read the entire input line
+    std::vector<std::string> names;
+    for (PaHostApiIndex i = 0; i < numHostAPIs; i++) {
+        const PaHostApiInfo* hostAPIInfo = Pa_GetHostApiInfo(i);
+        names.push_back(hostAPIInfo ? hostAPIInfo->name : "");
+    }
+    std::string input = choose(selection_.hostApi, "Enter host API index to use (press Enter to use default): ", names);
 
     PaHostApiIndex hostAPIIndex;
     if (input.empty()) {
@@ -178,8 +202,11 @@ bool AudioDeviceManager::selectRecordingDevice() {
     std::string input; // Use a string to handle empty input
 
     listAvailableRecordingDevices(); // List available recording devices
-    std::cout << "Enter device ID to capture audio from (press Enter for default input device): ";
-    std::getline(std::cin, input); // Read the entire line of input
+    std::vector<std::string> names;
+    for (const auto &device : recordingDevices_)
+        names.push_back(device ? device->getDeviceInfo().name : "");
+    input = choose(selection_.recordingDevice,
+                   "Enter device ID to capture audio from (press Enter for default input device): ", names);
 
     if (input.empty()) { // Check if input is empty
         for (int i = 0; i < recordingDevices_.size(); ++i) {
@@ -216,8 +243,11 @@ bool AudioDeviceManager::selectPlaybackDevice() {
     std::string input; // Use a string to handle empty input
 
     listAvailablePlaybackDevices(); // List available playback devices
-    std::cout << "Enter device ID to playback audio from (press Enter for default output device): ";
-    std::getline(std::cin, input); // Read the entire line of input
+    std::vector<std::string> names;
+    for (const auto &device : playbackDevices_)
+        names.push_back(device ? device->getDeviceInfo().name : "");
+    input = choose(selection_.playbackDevice,
+                   "Enter device ID to playback audio from (press Enter for default output device): ", names);
 
     if (input.empty()) { // Check if input is empty
         for (int i = 0; i < playbackDevices_.size(); ++i) {
@@ -250,42 +280,73 @@ bool AudioDeviceManager::selectPlaybackDevice() {
 
 bool AudioDeviceManager::record_device(std::chrono::seconds duration)
 {
+    const PaDeviceInfo &info = selectedRecordingDevice_->getDeviceInfo();
     std::cout << "Selected general device ID: " << selectedRecordingDevice_->getID() << std::endl;
-    std::cout << "Device name: " << selectedRecordingDevice_->getDeviceInfo().name << std::endl;
+    std::cout << "Device name: " << info.name << std::endl;
     std::cout << "Device type: " << selectedRecordingDevice_->getDeviceType() << std::endl;
-    std::cout << "Max input channels: " << selectedRecordingDevice_->getDeviceInfo().maxInputChannels << std::endl;
-    std::cout << "Max output channels: " << selectedRecordingDevice_->getDeviceInfo().maxOutputChannels << std::endl;
-    std::cout << "Sample Rate: " << selectedRecordingDevice_->getDeviceInfo().defaultSampleRate << std::endl;
+    std::cout << "Max input channels: " << info.maxInputChannels << std::endl;
+    std::cout << "Max output channels: " << info.maxOutputChannels << std::endl;
+    std::cout << "Sample Rate: " << info.defaultSampleRate << std::endl;
 
-    if (!audioCapture_->start(selectedRecordingDevice_, duration)) {
+    if (!audioCapture_->open(selectedRecordingDevice_)) {
+        std::cerr << "Failed to open audio capture." << std::endl;
+        return false;
+    }
+    const CaptureFormat &format = audioCapture_->getFormat();
+    const size_t totalFrames = static_cast<size_t>(duration.count()) * static_cast<size_t>(format.sampleRate);
+    RingBuffer ring(static_cast<size_t>(format.sampleRate) * 2, format.channels);
+    RingBufferSink sink(ring);
+    audioCapture_->setSink(&sink);
+    if (!audioCapture_->start()) {
         std::cerr << "Failed to start audio capture." << std::endl;
+        audioCapture_->close();
         return false;
     }
-    std::cout << "Recording audio from device: " << selectedRecordingDevice_->getDeviceInfo().name 
+    std::cout << "Recording audio from device: " << info.name
               << " for " << duration.count() << " seconds..." << std::endl;
-    if (audioCapture_->getCapturedData().empty()) {
+    // Filled in place and then moved into recording_, so the samples are
+    // written exactly once.
+    CaptureBuffer recording(format.sampleRate, format.channels, format.format);
+    recording.resize(totalFrames);
+    size_t captured = 0;
+    while (captured < totalFrames && audioCapture_->isActive()) {
+        size_t frames = std::min(ring.available(), totalFrames - captured);
+        if (frames == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        if (ring.pop(frames, reinterpret_cast<int16_t *>(recording.frame(captured))))
+            captured += frames;
+    }
+    audioCapture_->close();
+    audioCapture_->setSink(nullptr);
+    recording.resize(captured);
+    if (ring.overruns() > 0)
+        std::cerr << "Warning: " << ring.droppedFrames() << " frames lost to ring buffer overruns." << std::endl;
+    if (recording.empty()) {
         std::cerr << "Captured data is empty. Recording might have failed." << std::endl;
         return false;
     }
-    std::cout << "Captured " << audioCapture_->getCapturedData().size() << " samples." << std::endl;
+    std::cout << "Captured " << recording.frames() << " frames." << std::endl;
+    recording_ = std::move(recording);
     return true;
 }
 
 bool AudioDeviceManager::playback_device()
 {
+    const PaDeviceInfo &info = selectedPlaybackDevice_->getDeviceInfo();
     std::cout << "Selected general device ID: " << selectedPlaybackDevice_->getID() << std::endl;
-    std::cout << "Device name: " << selectedPlaybackDevice_->getDeviceInfo().name << std::endl;
+    std::cout << "Device name: " << info.name << std::endl;
     std::cout << "Device type: " << selectedPlaybackDevice_->getDeviceType() << std::endl;
-    std::cout << "Max input channels: " << selectedPlaybackDevice_->getDeviceInfo().maxInputChannels << std::endl;
-    std::cout << "Max output channels: " << selectedPlaybackDevice_->getDeviceInfo().maxOutputChannels << std::endl;
-    std::cout << "Sample Rate: " << selectedPlaybackDevice_->getDeviceInfo().defaultSampleRate << std::endl;
+    std::cout << "Max input channels: " << info.maxInputChannels << std::endl;
+    std::cout << "Max output channels: " << info.maxOutputChannels << std::endl;
+    std::cout << "Sample Rate: " << info.defaultSampleRate << std::endl;
 
-    std::vector<uint8_t> capturedData = audioCapture_->getCapturedData();
-    if (capturedData.empty()) {
+    if (recording_.empty()) {
         std::cerr << "No captured data to play." << std::endl;
         return false;
     }
-    if (!audioPlayback_->start(selectedPlaybackDevice_, capturedData, selectedRecordingDevice_->getDeviceInfo().defaultSampleRate)) {
+    if (!audioPlayback_->start(selectedPlaybackDevice_, recording_.view(), recording_.sampleRate())) {
         std::cerr << "Failed to start audio capture." << std::endl;
         return false;
     }
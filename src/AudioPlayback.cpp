@@ -2,11 +2,15 @@
 
 #ifdef _WIN32
 #include "WindowsAudioPlayback.hpp"
+#elif defined(__linux__)
+#include "LinuxAudioPlayback.hpp"
 #endif
 
 std::unique_ptr<AudioPlayback> AudioPlayback::createInstance() {
 #ifdef _WIN32
     return std::make_unique<WindowsAudioPlayback>();
+#elif defined(__linux__)
+    return std::make_unique<LinuxAudioPlayback>();
 #else
     // Add support for other platforms as needed
     return nullptr;
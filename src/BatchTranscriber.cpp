@@ -0,0 +1,259 @@
+#include "BatchTranscriber.hpp"
+
+#include "Resampler.hpp"
+#include "WavReader.hpp"
+#include "WhisperSession.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+BatchTranscriber::BatchTranscriber(whisper_context *ctx, const BatchConfig &config)
+    : ctx_(ctx),
+      config_(config),
+      finished_(false),
+      failedWorkers_(0),
+      failed_(false),
+      audioSeconds_(0.0),
+      wallSeconds_(0.0) {
+    config_.jobs = std::max(1, config_.jobs);
+    config_.threadsPerJob = std::max(1, config_.threadsPerJob);
+    if (config_.queueDepth == 0)
+        config_.queueDepth = static_cast<size_t>(config_.jobs) * 2;
+    config_.segmenter.sampleRate = config_.whisperRate;
+}
+
+BatchTranscriber::~BatchTranscriber() {}
+
+//---------------------------------------------------------------------------
+// Input expansion
+//---------------------------------------------------------------------------
+static bool wildcardMatch(const char *pattern, const char *text) {
+    // Iterative '*' / '?' matcher with single backtrack point.
+    const char *star = nullptr;
+    const char *resume = nullptr;
+    while (*text) {
+        if (*pattern == '?' || *pattern == *text) {
+            pattern++;
+            text++;
+        } else if (*pattern == '*') {
+            star = pattern++;
+            resume = text;
+        } else if (star) {
+            pattern = star + 1;
+            text = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (*pattern == '*')
+        pattern++;
+    return *pattern == '\0';
+}
+
+static bool hasWavExtension(const std::filesystem::path &path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".wav";
+}
+
+std::vector<std::string> BatchTranscriber::collectInputs(const std::string &input) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
+    std::error_code ec;
+
+    if (input.find_first_of("*?") != std::string::npos) {
+        fs::path pattern(input);
+        fs::path dir = pattern.has_parent_path() ? pattern.parent_path() : fs::path(".");
+        std::string name = pattern.filename().string();
+        for (const fs::directory_entry &entry : fs::directory_iterator(dir, ec)) {
+            if (entry.is_regular_file(ec) && wildcardMatch(name.c_str(), entry.path().filename().string().c_str()))
+                files.push_back(entry.path().string());
+        }
+    } else if (fs::is_directory(input, ec)) {
+        for (const fs::directory_entry &entry : fs::directory_iterator(input, ec)) {
+            if (entry.is_regular_file(ec) && hasWavExtension(entry.path()))
+                files.push_back(entry.path().string());
+        }
+    } else if (fs::exists(input, ec)) {
+        files.push_back(input);
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+//---------------------------------------------------------------------------
+// Reader side
+//---------------------------------------------------------------------------
+void BatchTranscriber::enqueue(Job &&job) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    notFull_.wait(lock, [this]() { return queue_.size() < config_.queueDepth || failed_; });
+    if (failed_)
+        return;     // Nobody is left to decode it.
+    queue_.push_back(std::move(job));
+    notEmpty_.notify_one();
+}
+
+bool BatchTranscriber::readFile(size_t index, const std::string &path) {
+    WavReader reader;
+    if (!reader.open(path))
+        return false;
+
+    Resampler resampler(reader.sampleRate(), config_.whisperRate, reader.channels());
+    UtteranceSegmenter segmenter(config_.segmenter, config_.vad);
+    std::vector<float> mono(resampler.maxOutput(config_.readFrames));
+
+    Utterance utterance;
+    auto drain = [&]() {
+        while (segmenter.pop(utterance)) {
+            Job job;
+            job.file = index;
+            job.start = utterance.start;
+            job.samples = std::move(utterance.samples);
+            enqueue(std::move(job));
+        }
+    };
+
+    // Blocks are views into the mapped file; nothing is copied before the resampler.
+    AudioView block;
+    while ((block = reader.read(config_.readFrames)).frames > 0) {
+        size_t produced = resampler.process(block, mono.data());
+        segmenter.push(mono.data(), produced);
+        drain();
+    }
+    segmenter.flush();
+    drain();
+
+    std::lock_guard<std::mutex> lock(resultsMutex_);
+    audioSeconds_ += static_cast<double>(reader.totalFrames()) / reader.sampleRate();
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// Worker side
+//---------------------------------------------------------------------------
+void BatchTranscriber::worker() {
+    whisper_state *state = whisper_init_state(ctx_);
+    if (!state) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (++failedWorkers_ < config_.jobs) {
+            std::cerr << "Failed to allocate Whisper state for a batch worker; continuing with "
+                      << config_.jobs - failedWorkers_ << " of " << config_.jobs << "." << std::endl;
+            return;
+        }
+        std::cerr << "Failed to allocate a Whisper state for any batch worker." << std::endl;
+        failed_ = true;
+        notFull_.notify_all();
+        return;
+    }
+
+    WhisperSessionConfig sessionConfig;
+    sessionConfig.language = config_.language;
+    sessionConfig.threads = config_.threadsPerJob;
+    // Utterances are decoded out of order, so no context carries over.
+    sessionConfig.noContext = true;
+    WhisperSession session(ctx_, state, sessionConfig);
+
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            notEmpty_.wait(lock, [this]() { return !queue_.empty() || finished_; });
+            if (queue_.empty())
+                break;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            notFull_.notify_one();
+        }
+
+        if (!session.decode(job.samples.data(), job.samples.size())) {
+            std::cerr << "whisper_full_with_state() failed!" << std::endl;
+            std::lock_guard<std::mutex> lock(resultsMutex_);
+            decodeFailures_[job.file]++;
+            continue;
+        }
+        double offset = static_cast<double>(job.start) / config_.whisperRate;
+        std::lock_guard<std::mutex> lock(resultsMutex_);
+        for (const SessionSegment &result : session.segments()) {
+            TimedText segment;
+            segment.text.assign(result.text);
+            segment.start = offset + result.t0 / 100.0;
+            segment.end = offset + result.t1 / 100.0;
+            results_[job.file].push_back(std::move(segment));
+        }
+    }
+    whisper_free_state(state);
+}
+
+static std::string formatTimestamp(double seconds) {
+    long long ms = static_cast<long long>(seconds * 1000.0 + 0.5);
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%02lld:%02lld:%02lld.%03lld",
+                  ms / 3600000, (ms / 60000) % 60, (ms / 1000) % 60, ms % 1000);
+    return buf;
+}
+
+bool BatchTranscriber::run(const std::vector<std::string> &files) {
+    results_.assign(files.size(), std::vector<TimedText>());
+    decodeFailures_.assign(files.size(), 0);
+    finished_ = false;
+    failedWorkers_ = 0;
+    failed_ = false;
+    audioSeconds_ = 0.0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < config_.jobs; i++) {
+        workers.emplace_back(&BatchTranscriber::worker, this);
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < files.size() && !failed_; i++) {
+        std::cout << "Reading " << files[i] << std::endl;
+        if (!readFile(i, files[i]))
+            ok = false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+    }
+    notEmpty_.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    wallSeconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    for (size_t i = 0; i < files.size(); i++) {
+        std::vector<TimedText> &segments = results_[i];
+        std::sort(segments.begin(), segments.end(),
+                  [](const TimedText &a, const TimedText &b) { return a.start < b.start; });
+        std::cout << "--------------------------------------------------" << std::endl;
+        std::cout << files[i] << std::endl;
+        for (const TimedText &segment : segments) {
+            std::cout << "[" << formatTimestamp(segment.start) << " --> " << formatTimestamp(segment.end) << "]"
+                      << segment.text << "\n";
+        }
+        if (decodeFailures_[i] > 0) {
+            std::cerr << files[i] << ": " << decodeFailures_[i] << " utterances failed to decode; "
+                      << "the transcript is incomplete." << std::endl;
+            ok = false;
+        }
+    }
+    std::cout << "--------------------------------------------------" << std::endl;
+    std::cout << "Transcribed " << audioSeconds_ << " s of audio in " << wallSeconds_ << " s ("
+              << (wallSeconds_ > 0.0 ? audioSeconds_ / wallSeconds_ : 0.0) << " audio-s/wall-s, "
+              << config_.jobs - failedWorkers_ << " jobs x " << config_.threadsPerJob << " threads)" << std::endl;
+    return ok && !failed_;
+}
+
+double BatchTranscriber::audioSeconds() const {
+    return audioSeconds_;
+}
+
+double BatchTranscriber::wallSeconds() const {
+    return wallSeconds_;
+}
@@ -0,0 +1,88 @@
+#include "ChunkAssembler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+ChunkAssembler::ChunkAssembler(size_t chunkFrames, size_t keepFrames, int channels,
+                               double deviceSampleRate, int outputRate)
+    : resampler_(deviceSampleRate, outputRate, channels),
+      newFrames_(chunkFrames > keepFrames ? chunkFrames - keepFrames : 0),
+      keepSamples_(0),
+      size_(0),
+      next_(0),
+      gapStart_(0),
+      gapEnd_(0),
+      gapPending_(false) {
+    keepSamples_ = static_cast<size_t>(std::floor(static_cast<double>(keepFrames) * outputRate / deviceSampleRate));
+    // The overlap starts out as silence, like the original overlap buffer.
+    window_.assign(keepSamples_ + resampler_.maxOutput(newFrames_), 0.0f);
+    size_ = keepSamples_;
+}
+
+ChunkAssembler::~ChunkAssembler() {}
+
+bool ChunkAssembler::assemble(RingBuffer &ring) {
+    RingBufferView view;
+    if (!ring.peek(newFrames_, view))
+        return false;
+    if (view.position > next_) {
+        // Overwritten since the last chunk: the audio is discontinuous.
+        if (!gapPending_)
+            gapStart_ = next_;
+        gapEnd_ = view.position;
+        gapPending_ = true;
+        resampler_.reset();
+        next_ = view.position;
+        // The overlap was spoken before the gap; silence keeps the chunk's
+        // timing right without carrying stale audio across it.
+        std::fill(window_.begin(), window_.begin() + keepSamples_, 0.0f);
+    }
+
+    float *out = window_.data() + keepSamples_;
+    size_t written = resampler_.process(view.first, view.firstFrames, out);
+    if (view.secondFrames > 0)
+        written += resampler_.process(view.second, view.secondFrames, out + written);
+
+    if (!ring.consume(view)) {
+        // The producer lapped us while converting; drop what we read and
+        // restart the filter on the audio that follows the gap.
+        resampler_.reset();
+        return false;
+    }
+    size_ = keepSamples_ + written;
+    next_ = view.position + view.frames();
+    return true;
+}
+
+const float *ChunkAssembler::data() const {
+    return window_.data();
+}
+
+size_t ChunkAssembler::size() const {
+    return size_;
+}
+
+size_t ChunkAssembler::overlapSize() const {
+    return keepSamples_;
+}
+
+void ChunkAssembler::advance() {
+    if (size_ < keepSamples_)
+        return;
+    std::memmove(window_.data(), window_.data() + (size_ - keepSamples_), keepSamples_ * sizeof(float));
+    size_ = keepSamples_;
+}
+
+uint64_t ChunkAssembler::position() const {
+    return next_;
+}
+
+bool ChunkAssembler::takeGap(uint64_t &start, uint64_t &end) {
+    if (!gapPending_)
+        return false;
+    start = gapStart_;
+    end = gapEnd_;
+    gapPending_ = false;
+    return true;
+}
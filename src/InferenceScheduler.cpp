@@ -0,0 +1,70 @@
+#include "InferenceScheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+InferenceScheduler::InferenceScheduler(const std::vector<TranscriptionStream *> &streams, const SchedulerConfig &config,
+                                       ThreadScheduler &threads)
+    : streams_(streams), config_(config), threads_(threads), cursor_(0), running_(false) {
+    config_.workers = std::max(1, config_.workers);
+    for (TranscriptionStream *stream : streams_) {
+        slots_.push_back(threads_.addStream("stream " + std::to_string(stream->id())));
+        stream->setNotifier(&captured_);
+    }
+}
+
+InferenceScheduler::~InferenceScheduler() {
+    stop();
+    for (TranscriptionStream *stream : streams_)
+        stream->setNotifier(nullptr);
+    for (size_t slot : slots_)
+        threads_.removeStream(slot);
+}
+
+bool InferenceScheduler::start(const TranscriptionStream::TextCallback &onText) {
+    if (running_ || streams_.empty())
+        return false;
+    onText_ = onText;
+    running_ = true;
+    for (int i = 0; i < config_.workers; i++) {
+        workers_.emplace_back(&InferenceScheduler::worker, this);
+    }
+    return true;
+}
+
+void InferenceScheduler::stop() {
+    running_ = false;
+    captured_.notify();
+    for (std::thread &worker : workers_) {
+        if (worker.joinable())
+            worker.join();
+    }
+    workers_.clear();
+}
+
+void InferenceScheduler::worker() {
+    const size_t count = streams_.size();
+    threads_.pinCurrentThread();
+    while (running_) {
+        // Read before the scan, so a chunk that arrives during it ends the wait.
+        const uint64_t seen = chunksCaptured();
+        size_t first = cursor_.fetch_add(1, std::memory_order_relaxed) % count;
+        bool worked = false;
+        for (size_t k = 0; k < count && !worked; k++) {
+            size_t index = (first + k) % count;
+            worked = streams_[index]->process(threads_, slots_[index], onText_);
+        }
+        if (!worked) {
+            captured_.waitFor([this, seen]() { return !running_ || chunksCaptured() != seen; },
+                              std::chrono::milliseconds(config_.idleMs));
+        }
+    }
+}
+
+uint64_t InferenceScheduler::chunksCaptured() const {
+    uint64_t chunks = 0;
+    for (const TranscriptionStream *stream : streams_)
+        chunks += stream->chunksCaptured();
+    return chunks;
+}
@@ -0,0 +1,665 @@
+#include "IpcServer.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <afunix.h>
+#else
+#include <fcntl.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+static const IpcServer::Socket kNoSocket = -1;
+// Upper bound on how long stop() waits for the threads to notice.
+static const int kPollMs = 200;
+
+#ifdef MSG_NOSIGNAL
+static const int kSendFlags = MSG_NOSIGNAL;     // A closed client must not raise SIGPIPE.
+#else
+static const int kSendFlags = 0;
+#endif
+
+//----------------------------------------------------------------------------
+// IpcRequest
+//----------------------------------------------------------------------------
+
+std::string IpcRequest::get(const std::string &key, const std::string &fallback) const {
+    auto it = values.find(key);
+    return it == values.end() ? fallback : it->second;
+}
+
+double IpcRequest::number(const std::string &key, double fallback) const {
+    auto it = values.find(key);
+    if (it == values.end())
+        return fallback;
+    char *end = nullptr;
+    double value = std::strtod(it->second.c_str(), &end);
+    return (end == it->second.c_str() || *end != '\0') ? fallback : value;
+}
+
+const std::vector<std::string> *IpcRequest::list(const std::string &key) const {
+    auto it = lists.find(key);
+    return it == lists.end() ? nullptr : &it->second;
+}
+
+static void skipSpace(const char *&p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+        p++;
+}
+
+static void appendUtf8(std::string &out, uint32_t code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+static bool parseHex4(const char *&p, const char *end, uint32_t &code) {
+    if (end - p < 4)
+        return false;
+    code = 0;
+    for (int i = 0; i < 4; i++, p++) {
+        char c = *p;
+        code <<= 4;
+        if (c >= '0' && c <= '9')
+            code |= static_cast<uint32_t>(c - '0');
+        else if (c >= 'a' && c <= 'f')
+            code |= static_cast<uint32_t>(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F')
+            code |= static_cast<uint32_t>(c - 'A' + 10);
+        else
+            return false;
+    }
+    return true;
+}
+
+// A JSON string starting at the opening quote.
+static bool parseString(const char *&p, const char *end, std::string &out) {
+    if (p >= end || *p != '"')
+        return false;
+    p++;
+    out.clear();
+    while (p < end && *p != '"') {
+        if (*p != '\\') {
+            out += *p++;
+            continue;
+        }
+        if (++p >= end)
+            return false;
+        char c = *p++;
+        switch (c) {
+            case '"':  out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/':  out += '/'; break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case 'n':  out += '\n'; break;
+            case 'r':  out += '\r'; break;
+            case 't':  out += '\t'; break;
+            case 'u': {
+                uint32_t code;
+                if (!parseHex4(p, end, code))
+                    return false;
+                // A high surrogate followed by a low one encodes one code point.
+                if (code >= 0xD800 && code < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                    const char *q = p + 2;
+                    uint32_t low;
+                    if (parseHex4(q, end, low) && low >= 0xDC00 && low < 0xE000) {
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        p = q;
+                    }
+                }
+                appendUtf8(out, code);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    if (p >= end)
+        return false;
+    p++;
+    return true;
+}
+
+// A string, or a number/true/false/null token kept as written.
+static bool parseScalar(const char *&p, const char *end, std::string &out) {
+    if (p < end && *p == '"')
+        return parseString(p, end, out);
+    const char *start = p;
+    while (p < end && (std::isalnum(static_cast<unsigned char>(*p)) || *p == '-' || *p == '+' || *p == '.'))
+        p++;
+    out.assign(start, p);
+    return p > start;
+}
+
+bool IpcRequest::parse(const char *data, size_t size, IpcRequest &out) {
+    out.values.clear();
+    out.lists.clear();
+    const char *p = data;
+    const char *end = data + size;
+    skipSpace(p, end);
+    if (p >= end || *p++ != '{')
+        return false;
+    skipSpace(p, end);
+    if (p < end && *p == '}')
+        return true;
+    std::string key;
+    std::string value;
+    for (;;) {
+        skipSpace(p, end);
+        if (!parseString(p, end, key))
+            return false;
+        skipSpace(p, end);
+        if (p >= end || *p++ != ':')
+            return false;
+        skipSpace(p, end);
+        if (p < end && *p == '[') {
+            p++;
+            std::vector<std::string> &items = out.lists[key];
+            items.clear();
+            skipSpace(p, end);
+            if (p < end && *p == ']') {
+                p++;
+            } else {
+                for (;;) {
+                    skipSpace(p, end);
+                    if (!parseScalar(p, end, value))
+                        return false;
+                    items.push_back(value);
+                    skipSpace(p, end);
+                    if (p < end && *p == ',') {
+                        p++;
+                        continue;
+                    }
+                    if (p >= end || *p++ != ']')
+                        return false;
+                    break;
+                }
+            }
+        } else {
+            if (!parseScalar(p, end, value))
+                return false;
+            out.values[key] = value;
+        }
+        skipSpace(p, end);
+        if (p < end && *p == ',') {
+            p++;
+            continue;
+        }
+        if (p >= end || *p++ != '}')
+            return false;
+        skipSpace(p, end);
+        return p == end;
+    }
+}
+
+//----------------------------------------------------------------------------
+// IpcServer
+//----------------------------------------------------------------------------
+
+IpcServer::IpcServer(const IpcServerConfig &config)
+    : config_(config), listener_(kNoSocket), ownsPath_(false), socketFile_(0), nextId_(1), batches_(0), events_(0), replaced_(0), running_(false) {}
+
+IpcServer::~IpcServer() {
+    stop();
+}
+
+bool IpcServer::start(const RequestHandler &onRequest) {
+    if (running_)
+        return true;
+    if (!listenOn())
+        return false;
+    onRequest_ = onRequest;
+    running_ = true;
+    thread_ = std::thread(&IpcServer::run, this);
+    senderThread_ = std::thread(&IpcServer::sender, this);
+    return true;
+}
+
+void IpcServer::stop() {
+    running_ = false;
+    eventReady_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
+    if (senderThread_.joinable())
+        senderThread_.join();
+    if (listener_ == kNoSocket)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const std::unique_ptr<Client> &client : clients_)
+            closeSocket(client->socket);
+        clients_.clear();
+    }
+    closeSocket(listener_);
+    listener_ = kNoSocket;
+    removeOwnSocket();
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+// Whether connecting to the socket at `path` is refused: nobody listens on
+// it any more.
+static bool socketIsStale(const std::string &path) {
+    IpcServer::Socket fd = static_cast<IpcServer::Socket>(socket(AF_UNIX, SOCK_STREAM, 0));
+    if (fd == kNoSocket)
+        return false;
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    bool refused = connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0;
+#ifdef _WIN32
+    refused = refused && WSAGetLastError() == WSAECONNREFUSED;
+    closesocket(static_cast<SOCKET>(fd));
+#else
+    refused = refused && errno == ECONNREFUSED;
+    ::close(static_cast<int>(fd));
+#endif
+    return refused;
+}
+
+// Makes `path` free for a new socket. Only a stale socket, left by a run
+// that did not stop cleanly, is removed; anything else is an error.
+static bool claimPath(const std::string &path) {
+#ifdef _WIN32
+    DWORD attributes = GetFileAttributesA(path.c_str());
+    if (attributes == INVALID_FILE_ATTRIBUTES)
+        return true;
+    bool isSocket = (attributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+#else
+    struct stat info;
+    if (lstat(path.c_str(), &info) != 0) {
+        if (errno == ENOENT)
+            return true;
+        std::cerr << "Cannot inspect IPC socket path " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    bool isSocket = S_ISSOCK(info.st_mode);
+#endif
+    if (!isSocket) {
+        std::cerr << "IPC socket path " << path << " exists and is not a socket." << std::endl;
+        return false;
+    }
+    if (!socketIsStale(path)) {
+        std::cerr << "IPC socket " << path << ": address in use." << std::endl;
+        return false;
+    }
+    if (std::remove(path.c_str()) != 0) {
+        std::cerr << "Failed to remove the stale IPC socket " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool IpcServer::listenOn() {
+    sockaddr_un addr{};
+    if (config_.path.empty() || config_.path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "IPC socket path must be 1 to " << sizeof(addr.sun_path) - 1 << " characters." << std::endl;
+        return false;
+    }
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        std::cerr << "WSAStartup failed; IPC server disabled." << std::endl;
+        return false;
+    }
+#endif
+    if (!claimPath(config_.path)) {
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+    Socket fd = static_cast<Socket>(socket(AF_UNIX, SOCK_STREAM, 0));
+    if (fd == kNoSocket) {
+        std::cerr << "Failed to create IPC socket." << std::endl;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+#ifdef _WIN32
+    std::memcpy(addr.sun_path, config_.path.c_str(), config_.path.size() + 1);
+    bool bound = bind(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) == 0;
+#else
+    // The socket is bound in a directory only this user can enter, made
+    // owner-only there and then renamed into place, so it is never
+    // reachable by others with the wrong mode and the process umask, which
+    // other threads' files depend on, is left alone.
+    size_t slash = config_.path.rfind('/');
+    std::string directory = (slash == std::string::npos ? std::string() : config_.path.substr(0, slash + 1)) +
+                            ".ipc-XXXXXX";
+    std::string staging = directory + "/socket";
+    bool bound = false;
+    if (staging.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "IPC socket path " << config_.path << " is too long to create safely." << std::endl;
+    } else if (!mkdtemp(&directory[0])) {
+        std::cerr << "Failed to create a private directory next to " << config_.path << ": "
+                  << std::strerror(errno) << std::endl;
+    } else {
+        staging = directory + "/socket";
+        std::memcpy(addr.sun_path, staging.c_str(), staging.size() + 1);
+        bound = bind(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) == 0 &&
+                chmod(staging.c_str(), S_IRUSR | S_IWUSR) == 0 &&
+                rename(staging.c_str(), config_.path.c_str()) == 0;
+        std::remove(staging.c_str());   // left over only if a step failed
+        rmdir(directory.c_str());
+    }
+#endif
+    if (!bound) {
+        std::cerr << "Failed to bind IPC socket " << config_.path << std::endl;
+        closeSocket(fd);
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+    listener_ = fd;
+#ifndef _WIN32
+    struct stat info;
+    if (lstat(config_.path.c_str(), &info) == 0)
+        socketFile_ = static_cast<uint64_t>(info.st_ino);
+#endif
+    ownsPath_ = true;
+    if (listen(fd, 4) != 0) {
+        std::cerr << "Failed to listen on IPC socket " << config_.path << std::endl;
+        closeSocket(fd);
+        listener_ = kNoSocket;
+        removeOwnSocket();
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+    return true;
+}
+
+// Removes the socket file this process created, unless it has been
+// replaced since.
+void IpcServer::removeOwnSocket() {
+    if (!ownsPath_)
+        return;
+    ownsPath_ = false;
+#ifndef _WIN32
+    struct stat info;
+    if (lstat(config_.path.c_str(), &info) != 0 || !S_ISSOCK(info.st_mode) ||
+        static_cast<uint64_t>(info.st_ino) != socketFile_)
+        return;
+#endif
+    std::remove(config_.path.c_str());
+}
+
+void IpcServer::run() {
+    std::vector<std::pair<ClientId, IpcRequest>> requests;
+    std::vector<IpcRequest> received;
+    while (running_) {
+        fd_set readable;
+        fd_set writable;
+        FD_ZERO(&readable);
+        FD_ZERO(&writable);
+        FD_SET(listener_, &readable);
+        Socket highest = listener_;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const std::unique_ptr<Client> &client : clients_) {
+                FD_SET(client->socket, &readable);
+                if (!client->output.empty())
+                    FD_SET(client->socket, &writable);
+                highest = std::max(highest, client->socket);
+            }
+        }
+        timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = kPollMs * 1000;
+        if (select(static_cast<int>(highest + 1), &readable, &writable, nullptr, &timeout) <= 0)
+            continue;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto it = clients_.begin(); it != clients_.end();) {
+                Client &client = **it;
+                bool alive = true;
+                if (FD_ISSET(client.socket, &readable)) {
+                    received.clear();
+                    alive = receive(client, received);
+                    for (IpcRequest &request : received)
+                        requests.emplace_back(client.id, std::move(request));
+                }
+                if (alive && FD_ISSET(client.socket, &writable))
+                    alive = drain(client);
+                if (alive) {
+                    ++it;
+                } else {
+                    closeSocket(client.socket);
+                    it = clients_.erase(it);
+                }
+            }
+            if (FD_ISSET(listener_, &readable)) {
+                Socket socket = static_cast<Socket>(accept(listener_, nullptr, nullptr));
+                if (socket != kNoSocket) {
+#ifdef _WIN32
+                    u_long nonBlocking = 1;
+                    ioctlsocket(static_cast<SOCKET>(socket), FIONBIO, &nonBlocking);
+#else
+                    int flags = fcntl(static_cast<int>(socket), F_GETFL, 0);
+                    fcntl(static_cast<int>(socket), F_SETFL, flags | O_NONBLOCK);
+#endif
+                    std::unique_ptr<Client> client(new Client());
+                    client->id = nextId_++;
+                    client->socket = socket;
+                    clients_.push_back(std::move(client));
+                }
+            }
+        }
+
+        // Outside the lock: the handler answers through send().
+        for (const auto &request : requests)
+            onRequest_(request.first, request.second);
+        requests.clear();
+    }
+}
+
+// Reads what the socket has and splits off complete frames. A frame that
+// does not parse becomes an empty request, which the handler rejects.
+// Returns false if the client is gone or broke the framing.
+bool IpcServer::receive(Client &client, std::vector<IpcRequest> &requests) {
+    char buffer[4096];
+    int got = static_cast<int>(recv(client.socket, buffer, sizeof(buffer), 0));
+    if (got <= 0)
+        return false;
+    client.input.append(buffer, static_cast<size_t>(got));
+    size_t offset = 0;
+    while (client.input.size() - offset >= 4) {
+        const unsigned char *header = reinterpret_cast<const unsigned char *>(client.input.data() + offset);
+        size_t length = (static_cast<size_t>(header[0]) << 24) | (static_cast<size_t>(header[1]) << 16) |
+                        (static_cast<size_t>(header[2]) << 8) | static_cast<size_t>(header[3]);
+        if (length > config_.maxRequestBytes)
+            return false;
+        if (client.input.size() - offset - 4 < length)
+            break;
+        IpcRequest request;
+        if (!IpcRequest::parse(client.input.data() + offset + 4, length, request)) {
+            request.values.clear();
+            request.lists.clear();
+        }
+        requests.push_back(std::move(request));
+        offset += 4 + length;
+    }
+    client.input.erase(0, offset);
+    return true;
+}
+
+// Sends buffered bytes until the socket would block. Returns false if the
+// client is gone or too far behind. Called with mutex_ held.
+bool IpcServer::drain(Client &client) {
+    size_t sent = 0;
+    while (sent < client.output.size()) {
+        int n = static_cast<int>(::send(client.socket, client.output.data() + sent,
+                                        static_cast<int>(client.output.size() - sent), kSendFlags));
+        if (n < 0) {
+#ifdef _WIN32
+            bool wouldBlock = WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+            bool wouldBlock = errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+            if (!wouldBlock)
+                return false;
+            break;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    client.output.erase(0, sent);
+    return client.output.size() <= config_.maxPendingBytes;
+}
+
+IpcServer::Client *IpcServer::find(ClientId id) {
+    for (const std::unique_ptr<Client> &client : clients_) {
+        if (client->id == id)
+            return client.get();
+    }
+    return nullptr;
+}
+
+void IpcServer::send(ClientId id, const std::string &json) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Client *client = find(id);
+    if (!client)
+        return;
+    appendFrame(client->output, json);
+    if (!drain(*client)) {
+        closeSocket(client->socket);
+        clients_.erase(std::find_if(clients_.begin(), clients_.end(),
+                                    [client](const std::unique_ptr<Client> &c) { return c.get() == client; }));
+    }
+}
+
+void IpcServer::subscribe(ClientId id, const std::vector<std::string> &topics) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Client *client = find(id);
+    if (client)
+        client->topics = topics;
+}
+
+void IpcServer::publish(const std::string &topic, const std::string &key, bool replaceable, const std::string &json) {
+    std::lock_guard<std::mutex> lock(eventMutex_);
+    if (!key.empty()) {
+        size_t before = queued_.size();
+        queued_.erase(std::remove_if(queued_.begin(), queued_.end(),
+                                     [&key](const Event &event) { return event.replaceable && event.key == key; }),
+                      queued_.end());
+        replaced_ += before - queued_.size();
+    }
+    Event event;
+    event.topic = topic;
+    event.key = key;
+    event.replaceable = replaceable;
+    appendFrame(event.frame, json);
+    queued_.push_back(std::move(event));
+    eventReady_.notify_one();
+}
+
+void IpcServer::sender() {
+    const auto window = std::chrono::milliseconds(std::max(0, config_.coalesceMs));
+    std::unique_lock<std::mutex> eventLock(eventMutex_);
+    while (running_) {
+        eventReady_.wait_for(eventLock, std::chrono::milliseconds(kPollMs),
+                             [this]() { return !queued_.empty() || !running_; });
+        if (queued_.empty())
+            continue;
+        // Let the events that follow the first one within the window join it.
+        if (window.count() > 0)
+            eventReady_.wait_for(eventLock, window, [this]() { return !running_; });
+        sending_.swap(queued_);
+        eventLock.unlock();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto it = clients_.begin(); it != clients_.end();) {
+                Client &client = **it;
+                size_t count = 0;
+                for (const Event &event : sending_) {
+                    if (std::find(client.topics.begin(), client.topics.end(), event.topic) == client.topics.end())
+                        continue;
+                    client.output += event.frame;
+                    count++;
+                }
+                bool alive = true;
+                if (count > 0) {
+                    batches_++;
+                    events_ += count;
+                    alive = drain(client);
+                }
+                if (alive) {
+                    ++it;
+                } else {
+                    closeSocket(client.socket);
+                    it = clients_.erase(it);
+                }
+            }
+        }
+        sending_.clear();
+        eventLock.lock();
+    }
+}
+
+size_t IpcServer::clients() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return clients_.size();
+}
+
+uint64_t IpcServer::batches() const {
+    return batches_;
+}
+
+uint64_t IpcServer::events() const {
+    return events_;
+}
+
+uint64_t IpcServer::replaced() const {
+    return replaced_;
+}
+
+void IpcServer::appendFrame(std::string &out, const std::string &json) {
+    const uint32_t length = static_cast<uint32_t>(json.size());
+    out += static_cast<char>((length >> 24) & 0xFF);
+    out += static_cast<char>((length >> 16) & 0xFF);
+    out += static_cast<char>((length >> 8) & 0xFF);
+    out += static_cast<char>(length & 0xFF);
+    out += json;
+}
+
+void IpcServer::closeSocket(Socket socket) {
+#ifdef _WIN32
+    closesocket(static_cast<SOCKET>(socket));
+#else
+    ::close(static_cast<int>(socket));
+#endif
+}
@@ -0,0 +1,174 @@
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Metric names in the Prometheus output.
+static const char *kPrefix = "transcriber_";
+
+static int floorLog2(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(v);
+#endif
+}
+
+Histogram::Histogram() : sumUs_(0), maxUs_(0) {
+    for (std::atomic<uint64_t> &bucket : buckets_)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+// Bucket 0 holds sub-microsecond samples; bucket 1 + 4 * octave + sub holds
+// [2^octave * (1 + sub / 4), 2^octave * (1 + (sub + 1) / 4)) us.
+size_t Histogram::bucketFor(uint64_t us) {
+    if (us == 0)
+        return 0;
+    int octave = floorLog2(us);
+    uint64_t sub = octave >= 2 ? (us >> (octave - 2)) & 3 : (us << (2 - octave)) & 3;
+    return std::min(kBuckets - 1, static_cast<size_t>(1 + 4 * octave + sub));
+}
+
+// Midpoint of the bucket's range, the estimate reported for its quantiles.
+double Histogram::midpointMs(size_t bucket) {
+    if (bucket == 0)
+        return 0.0005;
+    size_t octave = (bucket - 1) / 4;
+    size_t sub = (bucket - 1) % 4;
+    return static_cast<double>(uint64_t(1) << octave) * (1.0 + (sub + 0.5) / 4.0) / 1000.0;
+}
+
+void Histogram::record(double ms) {
+    uint64_t us = ms > 0.0 ? static_cast<uint64_t>(ms * 1000.0 + 0.5) : 0;
+    buckets_[bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+    sumUs_.fetch_add(us, std::memory_order_relaxed);
+    uint64_t seen = maxUs_.load(std::memory_order_relaxed);
+    while (us > seen && !maxUs_.compare_exchange_weak(seen, us, std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::record(std::chrono::steady_clock::duration elapsed) {
+    record(std::chrono::duration<double, std::milli>(elapsed).count());
+}
+
+// Reads each bucket once; samples recorded meanwhile may or may not be
+// included, which only shifts the quantiles by a sample.
+HistogramSnapshot Histogram::snapshot() const {
+    HistogramSnapshot out;
+    std::array<uint64_t, kBuckets> counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBuckets; i++) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    out.count = total;
+    out.sumMs = static_cast<double>(sumUs_.load(std::memory_order_relaxed)) / 1000.0;
+    out.maxMs = static_cast<double>(maxUs_.load(std::memory_order_relaxed)) / 1000.0;
+    if (total == 0)
+        return out;
+
+    const double quantiles[3] = {0.50, 0.95, 0.99};
+    double *targets[3] = {&out.p50Ms, &out.p95Ms, &out.p99Ms};
+    size_t q = 0;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets && q < 3; i++) {
+        seen += counts[i];
+        while (q < 3 && static_cast<double>(seen) >= quantiles[q] * static_cast<double>(total)) {
+            *targets[q] = std::min(midpointMs(i), out.maxMs);
+            q++;
+        }
+    }
+    return out;
+}
+
+template <typename T>
+T &MetricsRegistry::findOrAdd(std::vector<Entry<T>> &entries, const std::string &name, const std::string &help) {
+    for (Entry<T> &entry : entries) {
+        if (entry.name == name)
+            return *entry.metric;
+    }
+    entries.push_back(Entry<T>{name, help, std::unique_ptr<T>(new T())});
+    return *entries.back().metric;
+}
+
+Counter &MetricsRegistry::counter(const std::string &name, const std::string &help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return findOrAdd(counters_, name, help);
+}
+
+Gauge &MetricsRegistry::gauge(const std::string &name, const std::string &help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return findOrAdd(gauges_, name, help);
+}
+
+Histogram &MetricsRegistry::histogram(const std::string &name, const std::string &help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return findOrAdd(histograms_, name, help);
+}
+
+// Fixed notation keeps the JSON valid (no "inf"/"nan" from iostreams).
+static std::string number(double v) {
+    if (!(v == v) || v > 1e300 || v < -1e300)
+        return "0";
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.6g", v);
+    return buf;
+}
+
+std::string MetricsRegistry::toJson() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream out;
+    char ts[32];
+    std::snprintf(ts, sizeof(ts), "%.3f",
+                  std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count());
+    out << "{\"ts\":" << ts;
+    for (const Entry<Counter> &c : counters_)
+        out << ",\"" << c.name << "\":" << c.metric->value();
+    for (const Entry<Gauge> &g : gauges_)
+        out << ",\"" << g.name << "\":" << number(g.metric->value());
+    for (const Entry<Histogram> &h : histograms_) {
+        HistogramSnapshot s = h.metric->snapshot();
+        out << ",\"" << h.name << "_ms\":{\"count\":" << s.count
+            << ",\"mean\":" << number(s.count ? s.sumMs / static_cast<double>(s.count) : 0.0)
+            << ",\"p50\":" << number(s.p50Ms) << ",\"p95\":" << number(s.p95Ms)
+            << ",\"p99\":" << number(s.p99Ms) << ",\"max\":" << number(s.maxMs) << "}";
+    }
+    out << "}";
+    return out.str();
+}
+
+std::string MetricsRegistry::toPrometheus() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream out;
+    for (const Entry<Counter> &c : counters_) {
+        std::string name = kPrefix + c.name + "_total";
+        out << "# HELP " << name << " " << c.help << "\n"
+            << "# TYPE " << name << " counter\n"
+            << name << " " << c.metric->value() << "\n";
+    }
+    for (const Entry<Gauge> &g : gauges_) {
+        std::string name = kPrefix + g.name;
+        out << "# HELP " << name << " " << g.help << "\n"
+            << "# TYPE " << name << " gauge\n"
+            << name << " " << number(g.metric->value()) << "\n";
+    }
+    for (const Entry<Histogram> &h : histograms_) {
+        std::string name = kPrefix + h.name + "_seconds";
+        HistogramSnapshot s = h.metric->snapshot();
+        out << "# HELP " << name << " " << h.help << "\n"
+            << "# TYPE " << name << " summary\n"
+            << name << "{quantile=\"0.5\"} " << number(s.p50Ms / 1000.0) << "\n"
+            << name << "{quantile=\"0.95\"} " << number(s.p95Ms / 1000.0) << "\n"
+            << name << "{quantile=\"0.99\"} " << number(s.p99Ms / 1000.0) << "\n"
+            << name << "_sum " << number(s.sumMs / 1000.0) << "\n"
+            << name << "_count " << s.count << "\n";
+    }
+    return out.str();
+}
@@ -0,0 +1,172 @@
+#include "MetricsReporter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+static const MetricsReporter::Socket kNoSocket = -1;
+// Upper bound on how long stop() waits for the thread to notice.
+static const int kPollMs = 200;
+
+#ifdef MSG_NOSIGNAL
+static const int kSendFlags = MSG_NOSIGNAL;     // A scraper that hangs up must not raise SIGPIPE.
+#else
+static const int kSendFlags = 0;
+#endif
+
+MetricsReporter::MetricsReporter(const MetricsRegistry &registry, const MetricsReporterConfig &config,
+                                 std::ostream &log)
+    : registry_(registry), config_(config), log_(log), listener_(kNoSocket), running_(false) {}
+
+MetricsReporter::~MetricsReporter() {
+    stop();
+}
+
+bool MetricsReporter::start() {
+    if (running_)
+        return true;
+    if (config_.intervalSeconds <= 0.0 && config_.port <= 0)
+        return true;    // nothing to publish
+    if (config_.port > 0 && !listenOn())
+        return false;
+    running_ = true;
+    thread_ = std::thread(&MetricsReporter::run, this);
+    return true;
+}
+
+void MetricsReporter::stop() {
+    running_ = false;
+    if (thread_.joinable())
+        thread_.join();
+    if (listener_ != kNoSocket) {
+        closeSocket(listener_);
+        listener_ = kNoSocket;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+}
+
+bool MetricsReporter::listenOn() {
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        std::cerr << "WSAStartup failed; metrics endpoint disabled." << std::endl;
+        return false;
+    }
+#endif
+    Socket fd = static_cast<Socket>(socket(AF_INET, SOCK_STREAM, 0));
+    if (fd == kNoSocket) {
+        std::cerr << "Failed to create metrics socket." << std::endl;
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(config_.port));
+    if (inet_pton(AF_INET, config_.bindAddress.c_str(), &addr.sin_addr) != 1 ||
+        bind(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+        std::cerr << "Failed to listen for metrics on " << config_.bindAddress << ":" << config_.port << std::endl;
+        closeSocket(fd);
+        return false;
+    }
+    listener_ = fd;
+    std::cout << "Metrics at http://" << config_.bindAddress << ":" << config_.port << "/metrics" << std::endl;
+    return true;
+}
+
+void MetricsReporter::run() {
+    using Clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(config_.intervalSeconds));
+    auto nextLog = Clock::now() + period;
+
+    while (running_) {
+        if (config_.intervalSeconds > 0.0 && Clock::now() >= nextLog) {
+            log_ << registry_.toJson() << std::endl;
+            nextLog += period;
+        }
+        auto untilLog = config_.intervalSeconds > 0.0
+            ? std::chrono::duration_cast<std::chrono::milliseconds>(nextLog - Clock::now()).count()
+            : kPollMs;
+        long waitMs = static_cast<long>(std::max<long long>(0, std::min<long long>(kPollMs, untilLog)));
+        if (listener_ == kNoSocket) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(waitMs));
+            continue;
+        }
+        // Wait for a client or the next log line, whichever comes first.
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(listener_, &readable);
+        timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = waitMs * 1000;
+        if (select(static_cast<int>(listener_ + 1), &readable, nullptr, nullptr, &timeout) <= 0)
+            continue;
+        Socket client = static_cast<Socket>(accept(listener_, nullptr, nullptr));
+        if (client != kNoSocket) {
+            serve(client);
+            closeSocket(client);
+        }
+    }
+}
+
+// Minimal HTTP/1.0: reads the request line, answers GET /metrics, closes.
+void MetricsReporter::serve(Socket client) {
+    // A client that never sends its request must not stall the log line.
+#ifdef _WIN32
+    DWORD timeoutMs = 1000;
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char *>(&timeoutMs), sizeof(timeoutMs));
+#else
+    timeval timeout{1, 0};
+    setsockopt(static_cast<int>(client), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#endif
+    char request[1024];
+    int got = static_cast<int>(recv(client, request, sizeof(request) - 1, 0));
+    if (got <= 0)
+        return;
+    request[got] = '\0';
+
+    std::string status = "200 OK";
+    std::string body;
+    if (std::strncmp(request, "GET /metrics", 12) == 0) {
+        body = registry_.toPrometheus();
+    } else {
+        status = "404 Not Found";
+        body = "Try /metrics\n";
+    }
+    std::string response = "HTTP/1.0 " + status + "\r\n"
+                           "Content-Type: text/plain; version=0.0.4\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "Connection: close\r\n\r\n" + body;
+    size_t sent = 0;
+    while (sent < response.size()) {
+        int n = static_cast<int>(send(client, response.data() + sent, static_cast<int>(response.size() - sent),
+                                      kSendFlags));
+        if (n <= 0)
+            break;
+        sent += static_cast<size_t>(n);
+    }
+}
+
+void MetricsReporter::closeSocket(Socket socket) {
+#ifdef _WIN32
+    closesocket(static_cast<SOCKET>(socket));
+#else
+    close(static_cast<int>(socket));
+#endif
+}
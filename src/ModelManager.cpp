@@ -0,0 +1,162 @@
+#include "ModelManager.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Whisper's input rate; the warmup feeds one second of silence.
+static const int kWarmupSamples = 16000;
+static const int kWarmupThreads = 4;
+
+static double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+ModelManager::ModelManager() {}
+
+ModelManager::~ModelManager() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &entry : models_) {
+        whisper_context *ctx = entry.second->context.get();
+        if (ctx)
+            whisper_free(ctx);
+    }
+}
+
+void ModelManager::preload(const std::string &path, const whisper_context_params &params, bool warmup) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (models_.count(path))
+        return;
+    std::unique_ptr<Model> model(new Model());
+    ModelLoadStats *stats = &model->stats;
+    model->context = std::async(std::launch::async, [path, params, warmup, stats]() {
+        return load(path, params, warmup, *stats);
+    }).share();
+    models_[path] = std::move(model);
+}
+
+whisper_context *ModelManager::get(const std::string &path, const whisper_context_params &params, bool warmup) {
+    preload(path, params, warmup);
+    std::shared_future<whisper_context *> context;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        context = models_[path]->context;
+    }
+    return context.get();
+}
+
+ModelLoadStats ModelManager::stats(const std::string &path) const {
+    std::shared_future<whisper_context *> context;
+    const ModelLoadStats *stats = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = models_.find(path);
+        if (it == models_.end())
+            return ModelLoadStats();
+        context = it->second->context;
+        stats = &it->second->stats;
+    }
+    context.wait();
+    return *stats;
+}
+
+whisper_context *ModelManager::load(const std::string &path, const whisper_context_params &params, bool warmup,
+                                    ModelLoadStats &stats) {
+    whisper_context *ctx = initMapped(path, params, stats);
+    if (!ctx) {
+        // Not mappable (or whisper rejected the buffer): let whisper read the file itself.
+        auto start = std::chrono::steady_clock::now();
+        ctx = whisper_init_from_file_with_params(path.c_str(), params);
+        stats.initMs = millisSince(start);
+        stats.mapped = false;
+    }
+    if (!ctx) {
+        std::cerr << "Failed to load Whisper model: " << path << std::endl;
+        return nullptr;
+    }
+    if (warmup) {
+        auto start = std::chrono::steady_clock::now();
+        warmUp(ctx);
+        stats.warmupMs = millisSince(start);
+    }
+    return ctx;
+}
+
+whisper_context *ModelManager::initMapped(const std::string &path, const whisper_context_params &params,
+                                          ModelLoadStats &stats) {
+    auto start = std::chrono::steady_clock::now();
+    whisper_context *ctx = nullptr;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    void *base = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping)
+        base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (base) {
+        stats.bytes = static_cast<size_t>(size.QuadPart);
+        stats.mapMs = millisSince(start);
+        start = std::chrono::steady_clock::now();
+        ctx = whisper_init_from_buffer_with_params(base, stats.bytes, params);
+        stats.initMs = millisSince(start);
+        UnmapViewOfFile(base);
+    }
+    if (mapping)
+        CloseHandle(mapping);
+    CloseHandle(file);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    struct stat st;
+    void *addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        return nullptr;
+    stats.bytes = static_cast<size_t>(st.st_size);
+    // Start reading the whole file now; whisper walks it front to back.
+    madvise(addr, stats.bytes, MADV_WILLNEED);
+    madvise(addr, stats.bytes, MADV_SEQUENTIAL);
+    stats.mapMs = millisSince(start);
+    start = std::chrono::steady_clock::now();
+    ctx = whisper_init_from_buffer_with_params(addr, stats.bytes, params);
+    stats.initMs = millisSince(start);
+    munmap(addr, stats.bytes);
+#endif
+    stats.mapped = ctx != nullptr;
+    return ctx;
+}
+
+void ModelManager::warmUp(whisper_context *ctx) {
+    std::vector<float> silence(kWarmupSamples, 0.0f);
+    whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    wparams.print_progress = false;
+    wparams.print_realtime = false;
+    wparams.print_special = false;
+    wparams.print_timestamps = false;
+    wparams.no_context = true;
+    wparams.single_segment = true;
+    wparams.n_threads = std::max(1, std::min(kWarmupThreads, static_cast<int>(std::thread::hardware_concurrency())));
+    whisper_full(ctx, wparams, silence.data(), static_cast<int>(silence.size()));
+}
@@ -0,0 +1,167 @@
+#include "OverloadController.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+
+// Gaps shorter than this between two drops of the same reason are merged.
+static const double kMergeSeconds = 0.05;
+
+OverloadController::OverloadController(const OverloadConfig &config, std::ostream &log)
+    : config_(config), log_(log), level_(0), load_(-1.0), overloaded_(0), eased_(0),
+      hasOpen_(false), spans_(0) {
+    config_.escalateCalls = std::max(1, config_.escalateCalls);
+    config_.relaxCalls = std::max(1, config_.relaxCalls);
+}
+
+OverloadController::~OverloadController() {
+    flush();
+}
+
+bool OverloadController::parseOrder(const std::string &text, std::vector<Degradation> &order) {
+    order.clear();
+    if (text == "off" || text == "none")
+        return true;
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        if (item == "silence")
+            order.push_back(Degradation::SkipSilence);
+        else if (item == "fast")
+            order.push_back(Degradation::FastDecode);
+        else if (item == "model")
+            order.push_back(Degradation::SmallModel);
+        else if (item == "coalesce")
+            order.push_back(Degradation::Coalesce);
+        else
+            return false;
+    }
+    return !order.empty();
+}
+
+const char *OverloadController::name(Degradation step) {
+    switch (step) {
+        case Degradation::SkipSilence: return "skip non-speech";
+        case Degradation::FastDecode:  return "fast decoding";
+        case Degradation::SmallModel:  return "fallback model";
+        case Degradation::Coalesce:    return "coalesce backlog";
+    }
+    return "?";
+}
+
+void OverloadController::disable(Degradation step) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_.order.erase(std::remove(config_.order.begin(), config_.order.end(), step), config_.order.end());
+    level_ = std::min(level_, static_cast<int>(config_.order.size()));
+}
+
+void OverloadController::update(double elapsedSeconds, double budgetSeconds, double backlog) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (budgetSeconds <= 0.0)
+        return;
+    double load = elapsedSeconds / budgetSeconds;
+    load_ = load_ < 0.0 ? load : load_ + config_.smoothing * (load - load_);
+
+    bool behind = load_ > config_.enterLoad || backlog > config_.backlogHigh;
+    bool eased = load_ < config_.exitLoad && backlog < config_.backlogHigh / 2.0;
+    overloaded_ = behind ? overloaded_ + 1 : 0;
+    eased_ = eased ? eased_ + 1 : 0;
+
+    char line[160];
+    if (overloaded_ >= config_.escalateCalls && level_ < static_cast<int>(config_.order.size())) {
+        std::snprintf(line, sizeof(line), "load %.2f, backlog %.0f%%: enabling %s (level %d)",
+                      load_, backlog * 100.0, name(config_.order[level_]), level_ + 1);
+        log_ << "[Overload] " << line << std::endl;
+        level_++;
+        overloaded_ = 0;
+    } else if (eased_ >= config_.relaxCalls && level_ > 0) {
+        level_--;
+        std::snprintf(line, sizeof(line), "load %.2f, backlog %.0f%%: disabling %s (level %d)",
+                      load_, backlog * 100.0, name(config_.order[level_]), level_);
+        log_ << "[Overload] " << line << std::endl;
+        eased_ = 0;
+    }
+}
+
+bool OverloadController::active(Degradation step) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return isActive(step);
+}
+
+bool OverloadController::isActive(Degradation step) const {
+    for (int i = 0; i < level_; i++) {
+        if (config_.order[i] == step)
+            return true;
+    }
+    return false;
+}
+
+int OverloadController::level() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return level_;
+}
+
+double OverloadController::load() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::max(0.0, load_);
+}
+
+void OverloadController::tune(whisper_full_params &params, size_t samples, int sampleRate) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!isActive(Degradation::FastDecode))
+        return;
+    params.temperature_inc = 0.0f;      // no re-decoding at higher temperatures
+    params.greedy.best_of = 1;
+    params.beam_search.beam_size = 1;
+    // Timestamps stay on: the stitcher and the SRT/VTT/JSONL times need them.
+    // 1500 encoder positions cover 30 s; keep one second of margin.
+    int positions = static_cast<int>(samples * 50 / static_cast<size_t>(sampleRate)) + 50;
+    params.audio_ctx = std::min(1500, positions);
+}
+
+void OverloadController::drop(double start, double end, const char *reason) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (end <= start)
+        return;
+    seconds_[reason] += end - start;
+    if (hasOpen_ && open_.reason == reason && start <= open_.end + kMergeSeconds) {
+        open_.end = std::max(open_.end, end);
+        return;
+    }
+    closeSpan();
+    open_.start = start;
+    open_.end = end;
+    open_.reason = reason;
+    hasOpen_ = true;
+}
+
+void OverloadController::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closeSpan();
+}
+
+void OverloadController::closeSpan() {
+    if (!hasOpen_)
+        return;
+    report(open_);
+    hasOpen_ = false;
+}
+
+void OverloadController::report(const DroppedSpan &span) {
+    char line[160];
+    std::snprintf(line, sizeof(line), "%.2f-%.2f s (%.2f s): %s", span.start, span.end, span.end - span.start,
+                  span.reason.c_str());
+    log_ << "[Dropped] " << line << std::endl;
+    spans_++;
+}
+
+uint64_t OverloadController::droppedSpans() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return spans_ + (hasOpen_ ? 1 : 0);
+}
+
+double OverloadController::droppedSeconds(const std::string &reason) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = seconds_.find(reason);
+    return it == seconds_.end() ? 0.0 : it->second;
+}
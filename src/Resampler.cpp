@@ -0,0 +1,416 @@
+#include "Resampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RESAMPLER_SSE2 1
+#endif
+// GCC and Clang build the AVX2 kernel for any x86 target and check the CPU
+// at run time; MSVC only has it with /arch:AVX2.
+#if defined(__GNUC__) || defined(__clang__)
+#define RESAMPLER_AVX2 1
+#define RESAMPLER_AVX2_TARGET __attribute__((target("avx2,fma")))
+#elif defined(__AVX2__)
+#define RESAMPLER_AVX2 1
+#define RESAMPLER_AVX2_TARGET
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define RESAMPLER_NEON 1
+#endif
+
+// Input frames downmixed per internal block.
+static const size_t kBlockFrames = 4096;
+// Pass band edge relative to the output Nyquist frequency.
+static const double kRolloff = 0.92;
+static const double kKaiserBeta = 8.0;
+static const double kPi = 3.14159265358979323846;
+
+//---------------------------------------------------------------------------
+// Inner loop: dot product over `n` floats, n is a multiple of 8.
+//---------------------------------------------------------------------------
+static float dotScalar(const float *a, const float *b, size_t n) {
+    float acc[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (size_t i = 0; i < n; i += 8) {
+        for (size_t j = 0; j < 8; j++) {
+            acc[j] += a[i + j] * b[i + j];
+        }
+    }
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+}
+
+#if defined(RESAMPLER_SSE2)
+static float dotSse2(const float *a, const float *b, size_t n) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (size_t i = 0; i < n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    __m128 sum = _mm_add_ps(acc0, acc1);
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+    return _mm_cvtss_f32(sum);
+}
+#endif
+
+#if defined(RESAMPLER_AVX2)
+RESAMPLER_AVX2_TARGET static float dotAvx2(const float *a, const float *b, size_t n) {
+    __m256 acc = _mm256_setzero_ps();
+    for (size_t i = 0; i < n; i += 8) {
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc);
+    }
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+    return _mm_cvtss_f32(sum);
+}
+#endif
+
+#if defined(RESAMPLER_NEON)
+static float dotNeon(const float *a, const float *b, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (size_t i = 0; i < n; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float32x4_t sum = vaddq_f32(acc0, acc1);
+    float32x2_t half = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+    return vget_lane_f32(vpadd_f32(half, half), 0);
+}
+#endif
+
+static Resampler::DotFunction kernelFunction(ResamplerKernel kernel) {
+    switch (kernel) {
+        case ResamplerKernel::Scalar:
+            return dotScalar;
+        case ResamplerKernel::Sse2:
+#if defined(RESAMPLER_SSE2)
+            return dotSse2;
+#else
+            return nullptr;
+#endif
+        case ResamplerKernel::Avx2:
+#if defined(RESAMPLER_AVX2) && (defined(__GNUC__) || defined(__clang__))
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ? dotAvx2 : nullptr;
+#elif defined(RESAMPLER_AVX2)
+            return dotAvx2;
+#else
+            return nullptr;
+#endif
+        case ResamplerKernel::Neon:
+#if defined(RESAMPLER_NEON)
+            return dotNeon;
+#else
+            return nullptr;
+#endif
+    }
+    return nullptr;
+}
+
+bool Resampler::kernelSupported(ResamplerKernel kernel) {
+    return kernelFunction(kernel) != nullptr;
+}
+
+ResamplerKernel Resampler::bestKernel() {
+    static const ResamplerKernel best = kernelSupported(ResamplerKernel::Avx2)   ? ResamplerKernel::Avx2
+                                        : kernelSupported(ResamplerKernel::Sse2) ? ResamplerKernel::Sse2
+                                        : kernelSupported(ResamplerKernel::Neon) ? ResamplerKernel::Neon
+                                                                                 : ResamplerKernel::Scalar;
+    return best;
+}
+
+const char *Resampler::kernelName(ResamplerKernel kernel) {
+    switch (kernel) {
+        case ResamplerKernel::Scalar: return "scalar";
+        case ResamplerKernel::Sse2:   return "sse2";
+        case ResamplerKernel::Avx2:   return "avx2";
+        case ResamplerKernel::Neon:   return "neon";
+    }
+    return "unknown";
+}
+
+//---------------------------------------------------------------------------
+// Filter design
+//---------------------------------------------------------------------------
+static double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+static std::shared_ptr<ResamplerFilterBank> designFilterBank(int up, int down) {
+    auto bank = std::make_shared<ResamplerFilterBank>();
+    bank->up = up;
+    bank->down = down;
+
+    // Longer filters for steeper decimation; at least enough history to cover
+    // one output step so the streaming buffer never has to skip input.
+    double ratio = static_cast<double>(down) / static_cast<double>(up);
+    size_t realTaps = static_cast<size_t>(std::ceil(32.0 * std::max(1.0, ratio)));
+    realTaps = std::max(realTaps, static_cast<size_t>(std::ceil(ratio)) + 2);
+    bank->taps = (realTaps + 7) & ~static_cast<size_t>(7);
+
+    // Prototype low-pass at the upsampled rate.
+    size_t length = realTaps * static_cast<size_t>(up);
+    double cutoff = 0.5 * kRolloff / static_cast<double>(std::max(up, down));
+    double center = 0.5 * static_cast<double>(length - 1);
+    bank->delay = center / static_cast<double>(up);
+    double i0Beta = besselI0(kKaiserBeta);
+    std::vector<double> prototype(length);
+    for (size_t i = 0; i < length; i++) {
+        double t = static_cast<double>(i) - center;
+        double sinc = (t == 0.0) ? 2.0 * cutoff : std::sin(2.0 * kPi * cutoff * t) / (kPi * t);
+        double r = t / center;
+        double window = besselI0(kKaiserBeta * std::sqrt(std::max(0.0, 1.0 - r * r))) / i0Beta;
+        prototype[i] = sinc * window * up;
+    }
+
+    // Split into phases, time-reversed; the zero padding sits at the oldest end.
+    bank->coeffs.assign(static_cast<size_t>(up) * bank->taps, 0.0f);
+    for (int p = 0; p < up; p++) {
+        float *dst = bank->coeffs.data() + static_cast<size_t>(p) * bank->taps;
+        double sum = 0.0;
+        for (size_t k = 0; k < realTaps; k++) {
+            double c = prototype[static_cast<size_t>(p) + k * up];
+            dst[bank->taps - 1 - k] = static_cast<float>(c);
+            sum += c;
+        }
+        // Normalise each phase to unity DC gain to avoid phase-dependent ripple.
+        if (sum != 0.0) {
+            for (size_t k = 0; k < bank->taps; k++) {
+                dst[k] = static_cast<float>(dst[k] / sum);
+            }
+        }
+    }
+    return bank;
+}
+
+std::shared_ptr<const ResamplerFilterBank> Resampler::getFilterBank(int up, int down) {
+    static std::mutex cacheMutex;
+    static std::map<std::pair<int, int>, std::weak_ptr<const ResamplerFilterBank>> cache;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    std::pair<int, int> key(up, down);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        if (auto existing = it->second.lock())
+            return existing;
+    }
+    std::shared_ptr<const ResamplerFilterBank> bank = designFilterBank(up, down);
+    cache[key] = bank;
+    return bank;
+}
+
+//---------------------------------------------------------------------------
+// Resampler
+//---------------------------------------------------------------------------
+Resampler::Resampler(double inputRate, int outputRate, int channels)
+    : filled_(0), base_(0), phase_(0), channels_(std::max(channels, 1)), passthrough_(false),
+      kernel_(bestKernel()), dot_(kernelFunction(kernel_)) {
+    // Rates such as 44100.0 are integral in practice; round to get a clean ratio.
+    long in = std::lround(inputRate);
+    long out = outputRate;
+    long g = std::gcd(in, out);
+    int up = static_cast<int>(out / g);
+    int down = static_cast<int>(in / g);
+    passthrough_ = (up == 1 && down == 1);
+    if (passthrough_) {
+        bank_ = nullptr;
+        buffer_.resize(kBlockFrames);
+        return;
+    }
+    bank_ = getFilterBank(up, down);
+    buffer_.resize(bank_->taps - 1 + kBlockFrames);
+    reset();
+}
+
+Resampler::~Resampler() {}
+
+bool Resampler::setKernel(ResamplerKernel kernel) {
+    DotFunction dot = kernelFunction(kernel);
+    if (!dot)
+        return false;
+    kernel_ = kernel;
+    dot_ = dot;
+    return true;
+}
+
+ResamplerKernel Resampler::kernel() const {
+    return kernel_;
+}
+
+void Resampler::reset() {
+    phase_ = 0;
+    if (passthrough_)
+        return;
+    std::fill(buffer_.begin(), buffer_.begin() + (bank_->taps - 1), 0.0f);
+    filled_ = bank_->taps - 1;
+    base_ = bank_->taps - 1;
+}
+
+size_t Resampler::maxOutput(size_t frames) const {
+    if (passthrough_)
+        return frames;
+    return (frames * static_cast<size_t>(bank_->up)) / static_cast<size_t>(bank_->down) + 2;
+}
+
+int Resampler::upFactor() const {
+    return passthrough_ ? 1 : bank_->up;
+}
+
+int Resampler::downFactor() const {
+    return passthrough_ ? 1 : bank_->down;
+}
+
+double Resampler::delay() const {
+    return passthrough_ ? 0.0 : bank_->delay;
+}
+
+int Resampler::channels() const {
+    return channels_;
+}
+
+// Produces every output whose newest input sample is already buffered, then
+// keeps taps - 1 samples of history for the next block.
+size_t Resampler::run(float *out) {
+    const size_t taps = bank_->taps;
+    const int up = bank_->up;
+    const int down = bank_->down;
+    size_t written = 0;
+    while (base_ < filled_) {
+        out[written++] = dot_(bank_->phase(phase_), &buffer_[base_ + 1 - taps], taps);
+        phase_ += down;
+        base_ += static_cast<size_t>(phase_ / up);
+        phase_ %= up;
+    }
+    size_t shift = base_ - (taps - 1);
+    std::memmove(buffer_.data(), buffer_.data() + shift, (filled_ - shift) * sizeof(float));
+    filled_ -= shift;
+    base_ -= shift;
+    return written;
+}
+
+//---------------------------------------------------------------------------
+// Downmix: `frames` interleaved frames -> mono float in [-1, 1).
+//---------------------------------------------------------------------------
+static void downmixInt16(const uint8_t *bytes, size_t frames, int channels, float *mono) {
+    const float scale = 1.0f / (32768.0f * static_cast<float>(channels));
+    if (channels == 1) {
+        for (size_t i = 0; i < frames; i++) {
+            int16_t sample;
+            std::memcpy(&sample, bytes + i * 2, sizeof(sample));
+            mono[i] = static_cast<float>(sample) * scale;
+        }
+        return;
+    }
+    // Exact N-channel downmix.
+    for (size_t i = 0; i < frames; i++) {
+        const uint8_t *frame = bytes + i * 2 * channels;
+        int32_t sum = 0;
+        for (int c = 0; c < channels; c++) {
+            int16_t sample;
+            std::memcpy(&sample, frame + c * 2, sizeof(sample));
+            sum += sample;
+        }
+        mono[i] = static_cast<float>(sum) * scale;
+    }
+}
+
+static void downmixInt24(const uint8_t *bytes, size_t frames, int channels, float *mono) {
+    const float scale = 1.0f / (8388608.0f * static_cast<float>(channels));
+    for (size_t i = 0; i < frames; i++) {
+        const uint8_t *frame = bytes + i * 3 * channels;
+        int32_t sum = 0;
+        for (int c = 0; c < channels; c++) {
+            const uint8_t *p = frame + c * 3;
+            // Sign-extend through the top byte.
+            sum += static_cast<int32_t>(static_cast<uint32_t>(p[0]) << 8 | static_cast<uint32_t>(p[1]) << 16 |
+                                        static_cast<uint32_t>(p[2]) << 24) >> 8;
+        }
+        mono[i] = static_cast<float>(sum) * scale;
+    }
+}
+
+static void downmixInt32(const uint8_t *bytes, size_t frames, int channels, float *mono) {
+    const double scale = 1.0 / (2147483648.0 * channels);
+    for (size_t i = 0; i < frames; i++) {
+        const uint8_t *frame = bytes + i * 4 * channels;
+        int64_t sum = 0;
+        for (int c = 0; c < channels; c++) {
+            int32_t sample;
+            std::memcpy(&sample, frame + c * 4, sizeof(sample));
+            sum += sample;
+        }
+        mono[i] = static_cast<float>(static_cast<double>(sum) * scale);
+    }
+}
+
+static void downmixFloat32(const uint8_t *bytes, size_t frames, int channels, float *mono) {
+    const float scale = 1.0f / static_cast<float>(channels);
+    for (size_t i = 0; i < frames; i++) {
+        const uint8_t *frame = bytes + i * 4 * channels;
+        float sum = 0.0f;
+        for (int c = 0; c < channels; c++) {
+            float sample;
+            std::memcpy(&sample, frame + c * 4, sizeof(sample));
+            sum += sample;
+        }
+        mono[i] = sum * scale;
+    }
+}
+
+size_t Resampler::feed(const AudioView &in, float *out, void (*downmix)(const uint8_t *, size_t, int, float *)) {
+    const size_t frameBytes = in.frameBytes();
+    const uint8_t *bytes = in.data;
+    size_t frames = in.frames;
+    size_t written = 0;
+    while (frames > 0) {
+        size_t block = std::min(frames, kBlockFrames);
+        float *mono = passthrough_ ? out + written : buffer_.data() + filled_;
+        downmix(bytes, block, channels_, mono);
+        if (passthrough_) {
+            written += block;
+        } else {
+            filled_ += block;
+            written += run(out + written);
+        }
+        bytes += block * frameBytes;
+        frames -= block;
+    }
+    return written;
+}
+
+size_t Resampler::process(const AudioView &in, float *out) {
+    switch (in.format) {
+        case SampleFormat::Int16:   return feed(in, out, downmixInt16);
+        case SampleFormat::Int24:   return feed(in, out, downmixInt24);
+        case SampleFormat::Int32:   return feed(in, out, downmixInt32);
+        case SampleFormat::Float32: return feed(in, out, downmixFloat32);
+    }
+    return 0;
+}
+
+size_t Resampler::process(const int16_t *in, size_t frames, float *out) {
+    AudioView view;
+    view.data = reinterpret_cast<const uint8_t *>(in);
+    view.frames = frames;
+    view.channels = channels_;
+    view.format = SampleFormat::Int16;
+    return feed(view, out, downmixInt16);
+}
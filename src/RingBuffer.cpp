@@ -0,0 +1,281 @@
+#include "RingBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>    // WaitOnAddress, in Synchronization.lib
+#elif defined(__linux__)
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <thread>
+#endif
+
+// Sleeps while `word` still holds `expected`, for at most `timeout`.
+// Spurious returns are fine: the caller re-checks its condition.
+static void waitOnWord(std::atomic<uint32_t> &word, uint32_t expected, std::chrono::nanoseconds timeout) {
+#ifdef _WIN32
+    DWORD ms = static_cast<DWORD>((timeout.count() + 999999) / 1000000);
+    WaitOnAddress(&word, &expected, sizeof(expected), ms);
+#elif defined(__linux__)
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+    ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+#else
+    // No address wait here: fall back to short polls.
+    if (word.load(std::memory_order_acquire) == expected)
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::milliseconds(1)));
+#endif
+}
+
+static void wakeWord(std::atomic<uint32_t> &word) {
+#ifdef _WIN32
+    WakeByAddressSingle(&word);
+#elif defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+static size_t roundUpPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+RingBuffer::RingBuffer(size_t capacityFrames, int channels, OverflowPolicy policy)
+    : capacity_(roundUpPowerOfTwo(std::max<size_t>(capacityFrames, 1))),
+      mask_(0),
+      channels_(std::max(channels, 1)),
+      policy_(policy),
+      head_(0),
+      reserve_(0),
+      tail_(0),
+      overruns_(0),
+      droppedFrames_(0),
+      waitTarget_(0),
+      wakeSeq_(0),
+      wakeups_(0) {
+    mask_ = capacity_ - 1;
+    buffer_.resize(capacity_ * static_cast<size_t>(channels_));
+}
+
+RingBuffer::~RingBuffer() {}
+
+void RingBuffer::copyIn(uint64_t position, const int16_t *data, size_t frames) {
+    size_t index = static_cast<size_t>(position & mask_);
+    size_t first = std::min(frames, capacity_ - index);
+    size_t frameBytes = static_cast<size_t>(channels_) * sizeof(int16_t);
+    std::memcpy(&buffer_[index * channels_], data, first * frameBytes);
+    if (first < frames) {
+        std::memcpy(&buffer_[0], data + first * channels_, (frames - first) * frameBytes);
+    }
+}
+
+void RingBuffer::copyOut(uint64_t position, int16_t *out, size_t frames) const {
+    size_t index = static_cast<size_t>(position & mask_);
+    size_t first = std::min(frames, capacity_ - index);
+    size_t frameBytes = static_cast<size_t>(channels_) * sizeof(int16_t);
+    std::memcpy(out, &buffer_[index * channels_], first * frameBytes);
+    if (first < frames) {
+        std::memcpy(out + first * channels_, &buffer_[0], (frames - first) * frameBytes);
+    }
+}
+
+size_t RingBuffer::push(const int16_t *data, size_t frames) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+
+    if (policy_ == OverflowPolicy::DropNewest) {
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        size_t freeFrames = capacity_ - static_cast<size_t>(head - tail);
+        if (frames > freeFrames) {
+            overruns_.fetch_add(1, std::memory_order_relaxed);
+            droppedFrames_.fetch_add(frames - freeFrames, std::memory_order_relaxed);
+            frames = freeFrames;
+        }
+        if (frames == 0)
+            return 0;
+        copyIn(head, data, frames);
+        head_.store(head + frames, std::memory_order_release);
+        wakeConsumer(head + frames);
+        return frames;
+    }
+
+    // OverwriteOldest: a block larger than the ring only keeps its newest part.
+    // The skipped frames still advance the position so the consumer accounts
+    // for them as lost.
+    size_t skipped = 0;
+    if (frames > capacity_) {
+        skipped = frames - capacity_;
+        data += skipped * channels_;
+        frames = capacity_;
+    }
+    // Announce the region about to be overwritten before touching it, so a
+    // consumer copying from that region can detect the overlap afterwards.
+    uint64_t end = head + skipped + frames;
+    reserve_.store(end, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    copyIn(head + skipped, data, frames);
+    head_.store(end, std::memory_order_release);
+    wakeConsumer(end);
+    return frames;
+}
+
+void RingBuffer::wakeConsumer(uint64_t head) {
+    // Pairs with the fence in waitFor(): either the consumer sees the new
+    // head before sleeping or this sees its target.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t target = waitTarget_.load(std::memory_order_relaxed);
+    if (target == 0 || head < target)
+        return;
+    // Claim the wakeup so only the block that reaches the target pays for it.
+    if (!waitTarget_.compare_exchange_strong(target, 0, std::memory_order_relaxed))
+        return;
+    wakeSeq_.fetch_add(1, std::memory_order_release);
+    wakeups_.fetch_add(1, std::memory_order_relaxed);
+    wakeWord(wakeSeq_);
+}
+
+bool RingBuffer::waitFor(size_t frames, std::chrono::milliseconds timeout) {
+    if (frames > capacity_)
+        return false;
+    if (available() >= frames)
+        return true;
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (;;) {
+        uint32_t seq = wakeSeq_.load(std::memory_order_acquire);
+        waitTarget_.store(tail_.load(std::memory_order_relaxed) + frames, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (available() >= frames)
+            break;
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+            break;
+        waitOnWord(wakeSeq_, seq, deadline - now);
+    }
+    waitTarget_.store(0, std::memory_order_relaxed);
+    return available() >= frames;
+}
+
+uint64_t RingBuffer::skipOverwritten(uint64_t tail) {
+    uint64_t reserved = reserve_.load(std::memory_order_acquire);
+    if (reserved - tail > capacity_) {
+        uint64_t lost = reserved - tail - capacity_;
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+        droppedFrames_.fetch_add(lost, std::memory_order_relaxed);
+        tail += lost;
+    }
+    return tail;
+}
+
+bool RingBuffer::pop(size_t frames, int16_t *out) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+
+    if (policy_ == OverflowPolicy::DropNewest) {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        if (head - tail < frames)
+            return false;
+        copyOut(tail, out, frames);
+        tail_.store(tail + frames, std::memory_order_release);
+        return true;
+    }
+
+    for (;;) {
+        tail = skipOverwritten(tail);
+        uint64_t head = head_.load(std::memory_order_acquire);
+        if (head < tail || head - tail < frames) {
+            tail_.store(tail, std::memory_order_release);
+            return false;
+        }
+        copyOut(tail, out, frames);
+        // Seqlock-style validation: if the producer started overwriting any
+        // of the frames we just copied, drop them and try again further on.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t reserved = reserve_.load(std::memory_order_relaxed);
+        if (reserved - tail > capacity_)
+            continue;
+        tail_.store(tail + frames, std::memory_order_release);
+        return true;
+    }
+}
+
+bool RingBuffer::peek(size_t frames, RingBufferView &view) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (policy_ == OverflowPolicy::OverwriteOldest) {
+        tail = skipOverwritten(tail);
+        tail_.store(tail, std::memory_order_release);
+    }
+    uint64_t head = head_.load(std::memory_order_acquire);
+    if (head < tail || head - tail < frames)
+        return false;
+
+    size_t index = static_cast<size_t>(tail & mask_);
+    size_t first = std::min(frames, capacity_ - index);
+    view.first = &buffer_[index * channels_];
+    view.firstFrames = first;
+    view.second = (first < frames) ? &buffer_[0] : nullptr;
+    view.secondFrames = frames - first;
+    view.position = tail;
+    return true;
+}
+
+bool RingBuffer::consume(const RingBufferView &view) {
+    if (policy_ == OverflowPolicy::OverwriteOldest) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t reserved = reserve_.load(std::memory_order_relaxed);
+        if (reserved - view.position > capacity_) {
+            tail_.store(skipOverwritten(view.position), std::memory_order_release);
+            return false;
+        }
+    }
+    tail_.store(view.position + view.frames(), std::memory_order_release);
+    return true;
+}
+
+bool RingBuffer::pop(size_t frames, std::vector<int16_t> &out) {
+    // resize() only allocates when the caller's buffer has never been this large.
+    out.resize(frames * channels_);
+    return pop(frames, out.data());
+}
+
+size_t RingBuffer::available() const {
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+    uint64_t head = head_.load(std::memory_order_acquire);
+    if (head < tail)
+        return 0;
+    return static_cast<size_t>(std::min<uint64_t>(head - tail, capacity_));
+}
+
+size_t RingBuffer::capacity() const {
+    return capacity_;
+}
+
+int RingBuffer::channels() const {
+    return channels_;
+}
+
+OverflowPolicy RingBuffer::policy() const {
+    return policy_;
+}
+
+uint64_t RingBuffer::overruns() const {
+    return overruns_.load(std::memory_order_relaxed);
+}
+
+uint64_t RingBuffer::droppedFrames() const {
+    return droppedFrames_.load(std::memory_order_relaxed);
+}
+
+uint64_t RingBuffer::wakeups() const {
+    return wakeups_.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,195 @@
+#include "StreamingTranscriber.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+// Largest window step() lets through: the budget plus the step that
+// triggers the forced commit.
+static size_t maxWindowSamples(const StreamingConfig &config) {
+    return static_cast<size_t>(config.maxWindowMs + config.stepMs) * config.sampleRate / 1000;
+}
+
+// Whisper's byte-pair tokens start a new word with a space.
+static bool startsWord(const SessionToken &token) {
+    return token.text[0] == ' ';
+}
+
+StreamingTranscriber::StreamingTranscriber(whisper_context *ctx, const StreamingConfig &config)
+    : ctx_(ctx), state_(nullptr), config_(config), begin_(0), newSamples_(0), windowStart_(0), pushedSamples_(0),
+      decodedSamples_(0) {
+    buffer_.reserve(2 * maxWindowSamples(config_));
+    prompt_.reserve(static_cast<size_t>(config_.maxPromptTokens) * 2);
+}
+
+StreamingTranscriber::~StreamingTranscriber() {
+    session_.reset();
+    if (state_)
+        whisper_free_state(state_);
+}
+
+bool StreamingTranscriber::init() {
+    state_ = whisper_init_state(ctx_);
+    if (!state_) {
+        std::cerr << "Failed to allocate Whisper state for streaming." << std::endl;
+        return false;
+    }
+    WhisperSessionConfig sessionConfig;
+    sessionConfig.language = config_.language;
+    // The prompt is managed here from committed text only.
+    sessionConfig.noContext = true;
+    sessionConfig.collectTokens = true;
+    // Words are committed and cut at token times.
+    sessionConfig.tokenTimestamps = true;
+    sessionConfig.threads = config_.threads;
+    session_.reset(new WhisperSession(ctx_, state_, sessionConfig));
+    return true;
+}
+
+void StreamingTranscriber::push(const float *samples, size_t count) {
+    // The window is bounded by step(); this only guards against callers that
+    // push without stepping.
+    const size_t size = windowSize();
+    if (size + count > maxWindowSamples(config_)) {
+        size_t drop = std::min(size, size + count - maxWindowSamples(config_));
+        begin_ += drop;
+        windowStart_ += drop;
+    }
+    // Compact: the window holds at most half the buffer, so this moves at
+    // most one window per half a buffer of audio pushed.
+    if (buffer_.size() + count > buffer_.capacity()) {
+        buffer_.erase(buffer_.begin(), buffer_.begin() + begin_);
+        begin_ = 0;
+    }
+    buffer_.insert(buffer_.end(), samples, samples + count);
+    newSamples_ += count;
+    pushedSamples_ += count;
+}
+
+bool StreamingTranscriber::ready() const {
+    return newSamples_ >= static_cast<size_t>(config_.stepMs) * config_.sampleRate / 1000;
+}
+
+void StreamingTranscriber::setThreads(int threads) {
+    config_.threads = std::max(1, threads);
+}
+
+const float *StreamingTranscriber::window() const {
+    return buffer_.data() + begin_;
+}
+
+size_t StreamingTranscriber::windowSize() const {
+    return buffer_.size() - begin_;
+}
+
+bool StreamingTranscriber::decode() {
+    whisper_full_params &wparams = session_->prepare(config_.threads);
+    wparams.prompt_tokens    = prompt_.empty() ? nullptr : prompt_.data();
+    wparams.prompt_n_tokens  = static_cast<int>(prompt_.size());
+    if (config_.trimAudioContext) {
+        // 1500 encoder positions cover 30 s; keep one second of margin.
+        int positions = static_cast<int>(windowSize() * 50 / config_.sampleRate) + 50;
+        wparams.audio_ctx = std::min(1500, positions);
+    }
+
+    newSamples_ = 0;
+    decodedSamples_ += windowSize();
+    if (!session_->decode(window(), windowSize())) {
+        std::cerr << "whisper_full_with_state() failed!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void StreamingTranscriber::commit(size_t count, std::string &committed) {
+    const std::vector<SessionToken> &tokens = session_->tokens();
+    int64_t cutCs = 0;
+    for (size_t i = 0; i < count; i++) {
+        committed += tokens[i].text;
+        prompt_.push_back(tokens[i].id);
+        cutCs = tokens[i].t1;
+    }
+    if (prompt_.size() > static_cast<size_t>(config_.maxPromptTokens)) {
+        prompt_.erase(prompt_.begin(), prompt_.end() - config_.maxPromptTokens);
+    }
+
+    size_t cut = 0;
+    if (count > 0) {
+        cut = static_cast<size_t>(cutCs) * config_.sampleRate / 100;
+    } else if (tokens.empty()) {
+        // Nothing recognised: keep only the hold-back tail in case a word is starting.
+        size_t keep = static_cast<size_t>(config_.holdbackMs) * config_.sampleRate / 1000;
+        cut = windowSize() > keep ? windowSize() - keep : 0;
+    }
+    cut = std::min(cut, windowSize());
+    begin_ += cut;
+    windowStart_ += cut;
+
+    // The remaining tokens become the reference for the next agreement check.
+    previous_.clear();
+    tentative_.clear();
+    for (size_t i = count; i < tokens.size(); i++) {
+        SessionToken token = tokens[i];
+        token.t0 -= cutCs;
+        token.t1 -= cutCs;
+        tentative_ += token.text;
+        previous_.push_back(token);
+    }
+}
+
+bool StreamingTranscriber::step(std::string &committed) {
+    if (windowSize() == 0)
+        return true;
+    if (!decode())
+        return false;
+
+    const std::vector<SessionToken> &tokens = session_->tokens();
+    const int64_t windowCs = static_cast<int64_t>(windowSize()) * 100 / config_.sampleRate;
+    const int64_t stableBefore = windowCs - config_.holdbackMs / 10;
+    size_t stable = 0;
+    for (size_t i = 0; i < tokens.size(); i++) {
+        bool agreed = i < previous_.size() && previous_[i].id == tokens[i].id;
+        if (tokens[i].t1 <= stableBefore || agreed) {
+            stable = i + 1;
+        } else {
+            break;
+        }
+    }
+    // Never cut inside a word.
+    while (stable > 0 && stable < tokens.size() && !startsWord(tokens[stable]))
+        stable--;
+    // Do not let the window run past its budget: keep at most the last word.
+    if (windowCs * 10 >= config_.maxWindowMs && !tokens.empty()) {
+        size_t forced = tokens.size() - 1;
+        while (forced > 0 && !startsWord(tokens[forced]))
+            forced--;
+        stable = std::max(stable, forced > 0 ? forced : tokens.size());
+    }
+    commit(stable, committed);
+    return true;
+}
+
+bool StreamingTranscriber::flush(std::string &committed) {
+    if (windowSize() == 0)
+        return true;
+    if (!decode())
+        return false;
+    commit(session_->tokens().size(), committed);
+    windowStart_ += windowSize();
+    buffer_.clear();
+    begin_ = 0;
+    previous_.clear();
+    tentative_.clear();
+    return true;
+}
+
+const std::string &StreamingTranscriber::tentative() const {
+    return tentative_;
+}
+
+uint64_t StreamingTranscriber::windowStart() const {
+    return windowStart_;
+}
+
+double StreamingTranscriber::decodeRatio() const {
+    return pushedSamples_ ? static_cast<double>(decodedSamples_) / static_cast<double>(pushedSamples_) : 0.0;
+}
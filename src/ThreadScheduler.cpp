@@ -0,0 +1,212 @@
+#include "ThreadScheduler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// A step is taken only if the neighbouring count is measured this much better.
+static const double kMinGain = 0.9;
+// A stream below this fraction of the target tries one thread fewer.
+static const double kShrinkBelow = 0.5;
+
+ThreadScheduler::ThreadScheduler(const ThreadSchedulerConfig &config, std::ostream &log)
+    : config_(config), log_(log), inFlight_(0), threadsInUse_(0) {
+    std::vector<int> allowed = allowedCores();
+    for (int core : allowed) {
+        if (core != config_.audioCore)
+            cores_.push_back(core);
+    }
+    if (cores_.empty())
+        cores_ = allowed;   // a single core: nothing to keep free
+    maxThreads_ = static_cast<int>(cores_.size());
+    if (config_.maxThreads > 0)
+        maxThreads_ = std::min(maxThreads_, config_.maxThreads);
+    if (config_.fixedThreads > 0)
+        maxThreads_ = std::max(maxThreads_, config_.fixedThreads);
+    config_.settleCalls = std::max(1, config_.settleCalls);
+
+    log_ << "[Threads] " << allowed.size() << " cores, " << cores_.size() << " for inference";
+    if (cores_.size() < allowed.size())
+        log_ << " (core " << config_.audioCore << " kept for audio)";
+    if (config_.fixedThreads > 0)
+        log_ << ", fixed at " << config_.fixedThreads << " threads";
+    else
+        log_ << ", adaptive up to " << maxThreads_ << " threads, target load " << config_.targetLoad;
+    log_ << std::endl;
+}
+
+ThreadScheduler::~ThreadScheduler() {}
+
+size_t ThreadScheduler::addStream(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    StreamState s;
+    s.name = name;
+    s.preferred = config_.fixedThreads > 0 ? config_.fixedThreads
+                                           : std::max(1, std::min(config_.initialThreads, maxThreads_));
+    s.load.assign(static_cast<size_t>(maxThreads_) + 1, -1.0);
+    s.calls.assign(static_cast<size_t>(maxThreads_) + 1, 0);
+    log_ << "[Threads] " << name << ": starting at " << s.preferred << " threads" << std::endl;
+    for (size_t i = 0; i < streams_.size(); i++) {
+        if (streams_[i].removed) {
+            streams_[i] = s;
+            return i;
+        }
+    }
+    streams_.push_back(s);
+    return streams_.size() - 1;
+}
+
+void ThreadScheduler::removeStream(size_t stream) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stream >= streams_.size())
+        return;
+    streams_[stream].removed = true;
+    streams_[stream].started = false;
+}
+
+int ThreadScheduler::begin(size_t stream) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    StreamState &s = streams_[stream];
+    const auto now = std::chrono::steady_clock::now();
+    const auto window = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(config_.activeSeconds));
+    s.lastBegin = now;
+    s.started = true;
+    int active = 0;
+    for (const StreamState &other : streams_) {
+        if (other.started && now - other.lastBegin <= window)
+            active++;
+    }
+    inFlight_++;
+    active = std::max(active, inFlight_);
+    int share = maxThreads_ / active;
+    int unclaimed = maxThreads_ - threadsInUse_;
+    int threads = std::max(1, std::min(s.preferred, std::min(share, unclaimed)));
+    threadsInUse_ += threads;
+    if (threads < s.preferred && (!s.capped || threads != s.granted)) {
+        log_ << "[Threads] " << s.name << ": granted " << threads << " of " << s.preferred << " threads ("
+             << active << " active streams, " << inFlight_ << " calls in flight)" << std::endl;
+    }
+    s.granted = threads;
+    s.capped = threads < s.preferred;
+    return threads;
+}
+
+void ThreadScheduler::end(size_t stream, int threads, double elapsedSeconds, double budgetSeconds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    StreamState &s = streams_[stream];
+    inFlight_ = std::max(0, inFlight_ - 1);
+    threadsInUse_ = std::max(0, threadsInUse_ - threads);
+    if (budgetSeconds <= 0.0 || threads < 1 || threads > maxThreads_)
+        return;
+
+    double load = elapsedSeconds / budgetSeconds;
+    size_t n = static_cast<size_t>(threads);
+    s.load[n] = s.calls[n] == 0 ? load : s.load[n] + config_.smoothing * (load - s.load[n]);
+    s.calls[n]++;
+    // Capped calls still teach us about their thread count, but only calls
+    // at the preferred count decide whether to move away from it.
+    if (config_.fixedThreads > 0 || threads != s.preferred)
+        return;
+    if (++s.sinceChange >= config_.settleCalls)
+        adapt(s, threads);
+}
+
+void ThreadScheduler::adapt(StreamState &s, int threads) {
+    const double current = s.load[threads];
+    int next = threads;
+    if (current > config_.targetLoad && threads < maxThreads_) {
+        double fewer = threads > 1 ? s.load[threads - 1] : -1.0;
+        double more = s.load[threads + 1];
+        bool lastStepPaid = fewer < 0.0 || current < fewer * kMinGain;
+        if (more >= 0.0 ? more < current * kMinGain : lastStepPaid)
+            next = threads + 1;
+    } else if (current < config_.targetLoad * kShrinkBelow && threads > 1) {
+        double fewer = s.load[threads - 1];
+        if (fewer < 0.0 || fewer <= config_.targetLoad)
+            next = threads - 1;
+    }
+    if (next == threads)
+        return;
+
+    char line[160];
+    double known = s.load[next];
+    if (known >= 0.0)
+        std::snprintf(line, sizeof(line), "%d -> %d threads (load %.2f at %d, %.2f at %d, target %.2f)",
+                      threads, next, current, threads, known, next, config_.targetLoad);
+    else
+        std::snprintf(line, sizeof(line), "%d -> %d threads (load %.2f at %d, %d untried, target %.2f)",
+                      threads, next, current, threads, next, config_.targetLoad);
+    log_ << "[Threads] " << s.name << ": " << line << std::endl;
+    s.preferred = next;
+    s.sinceChange = 0;
+}
+
+bool ThreadScheduler::pinCurrentThread() const {
+    if (config_.audioCore < 0 || cores_.empty())
+        return false;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int core : cores_)
+        CPU_SET(core, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for (int core : cores_) {
+        if (core < static_cast<int>(sizeof(DWORD_PTR) * 8))
+            mask |= static_cast<DWORD_PTR>(1) << core;
+    }
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    return false;   // macOS has no hard affinity; affinity tags are only hints
+#endif
+}
+
+int ThreadScheduler::usableCores() const {
+    return static_cast<int>(cores_.size());
+}
+
+int ThreadScheduler::preferredThreads(size_t stream) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return streams_[stream].preferred;
+}
+
+std::vector<int> ThreadScheduler::allowedCores() {
+    std::vector<int> cores;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int i = 0; i < CPU_SETSIZE; i++) {
+            if (CPU_ISSET(i, &set))
+                cores.push_back(i);
+        }
+    }
+#elif defined(_WIN32)
+    DWORD_PTR processMask = 0;
+    DWORD_PTR systemMask = 0;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+        for (int i = 0; i < static_cast<int>(sizeof(DWORD_PTR) * 8); i++) {
+            if (processMask & (static_cast<DWORD_PTR>(1) << i))
+                cores.push_back(i);
+        }
+    }
+#endif
+    if (cores.empty()) {
+        int count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        for (int i = 0; i < count; i++)
+            cores.push_back(i);
+    }
+    return cores;
+}
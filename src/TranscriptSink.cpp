@@ -0,0 +1,466 @@
+#include "TranscriptSink.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+static const SocketTranscriptWriter::Socket kNoSocket = -1;
+// Upper bound on how long close() waits for the thread to notice.
+static const int kPollMs = 200;
+// A client this far behind is not reading; it is dropped rather than
+// letting its queue grow without bound.
+static const size_t kMaxPendingBytes = 1 << 20;
+
+static const size_t kFormats = 3;
+
+#ifdef MSG_NOSIGNAL
+static const int kSendFlags = MSG_NOSIGNAL;     // A closed client must not raise SIGPIPE.
+#else
+static const int kSendFlags = 0;
+#endif
+
+//----------------------------------------------------------------------------
+// StreamTranscriptWriter
+//----------------------------------------------------------------------------
+
+StreamTranscriptWriter::StreamTranscriptWriter(TranscriptFormat format, std::ostream &out)
+    : TranscriptWriter(format), out_(out) {}
+
+bool StreamTranscriptWriter::open() {
+    out_ << TranscriptSink::header(format_);
+    return static_cast<bool>(out_);
+}
+
+void StreamTranscriptWriter::append(const std::shared_ptr<const std::string> &bytes) {
+    out_.write(bytes->data(), static_cast<std::streamsize>(bytes->size()));
+}
+
+void StreamTranscriptWriter::flush() {
+    out_.flush();
+}
+
+//----------------------------------------------------------------------------
+// FileTranscriptWriter
+//----------------------------------------------------------------------------
+
+FileTranscriptWriter::FileTranscriptWriter(TranscriptFormat format, const std::string &path)
+    : TranscriptWriter(format), path_(path) {}
+
+bool FileTranscriptWriter::open() {
+    out_.open(path_, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!out_.is_open()) {
+        std::cerr << "Failed to open transcript file " << path_ << std::endl;
+        return false;
+    }
+    out_ << TranscriptSink::header(format_);
+    out_.flush();
+    return true;
+}
+
+void FileTranscriptWriter::append(const std::shared_ptr<const std::string> &bytes) {
+    out_.write(bytes->data(), static_cast<std::streamsize>(bytes->size()));
+}
+
+void FileTranscriptWriter::flush() {
+    out_.flush();
+}
+
+void FileTranscriptWriter::close() {
+    if (out_.is_open())
+        out_.close();
+}
+
+//----------------------------------------------------------------------------
+// SocketTranscriptWriter
+//----------------------------------------------------------------------------
+
+SocketTranscriptWriter::SocketTranscriptWriter(TranscriptFormat format, int port, const std::string &bindAddress)
+    : TranscriptWriter(format), port_(port), bindAddress_(bindAddress), listener_(kNoSocket), running_(false) {}
+
+SocketTranscriptWriter::~SocketTranscriptWriter() {
+    close();
+}
+
+bool SocketTranscriptWriter::open() {
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        std::cerr << "WSAStartup failed; transcript socket disabled." << std::endl;
+        return false;
+    }
+#endif
+    Socket fd = static_cast<Socket>(socket(AF_INET, SOCK_STREAM, 0));
+    if (fd == kNoSocket) {
+        std::cerr << "Failed to create transcript socket." << std::endl;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port_));
+    if (inet_pton(AF_INET, bindAddress_.c_str(), &addr.sin_addr) != 1 ||
+        bind(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+        std::cerr << "Failed to listen for transcript clients on " << bindAddress_ << ":" << port_ << std::endl;
+        closeSocket(fd);
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+    listener_ = fd;
+    running_ = true;
+    thread_ = std::thread(&SocketTranscriptWriter::run, this);
+    std::cerr << "Transcript at tcp://" << bindAddress_ << ":" << port_ << std::endl;
+    return true;
+}
+
+void SocketTranscriptWriter::append(const std::shared_ptr<const std::string> &bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = clients_.begin(); it != clients_.end();) {
+        it->pending.push_back(bytes);
+        it->bytes += bytes->size();
+        // Send what the socket takes now; the thread sends the rest.
+        if (it->bytes > kMaxPendingBytes || !drain(*it)) {
+            closeSocket(it->socket);
+            it = clients_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void SocketTranscriptWriter::close() {
+    running_ = false;
+    if (thread_.joinable())
+        thread_.join();
+    if (listener_ == kNoSocket)
+        return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Client &client : clients_)
+        closeSocket(client.socket);
+    clients_.clear();
+    closeSocket(listener_);
+    listener_ = kNoSocket;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+void SocketTranscriptWriter::run() {
+    const char *header = TranscriptSink::header(format_);
+    std::shared_ptr<const std::string> headerBytes;
+    if (*header)
+        headerBytes = std::make_shared<const std::string>(header);
+    std::vector<char> scratch(1024);
+
+    while (running_) {
+        fd_set readable;
+        fd_set writable;
+        FD_ZERO(&readable);
+        FD_ZERO(&writable);
+        FD_SET(listener_, &readable);
+        Socket highest = listener_;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const Client &client : clients_) {
+                FD_SET(client.socket, &readable);       // to notice a hangup
+                if (!client.pending.empty())
+                    FD_SET(client.socket, &writable);
+                highest = std::max(highest, client.socket);
+            }
+        }
+        timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = kPollMs * 1000;
+        if (select(static_cast<int>(highest + 1), &readable, &writable, nullptr, &timeout) <= 0)
+            continue;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = clients_.begin(); it != clients_.end();) {
+            bool alive = true;
+            if (FD_ISSET(it->socket, &readable)) {
+                // Clients have nothing to say; what they send is discarded.
+                int got = static_cast<int>(recv(it->socket, scratch.data(), static_cast<int>(scratch.size()), 0));
+                alive = got > 0;
+            }
+            if (alive && FD_ISSET(it->socket, &writable))
+                alive = drain(*it);
+            if (alive) {
+                ++it;
+            } else {
+                closeSocket(it->socket);
+                it = clients_.erase(it);
+            }
+        }
+        if (!FD_ISSET(listener_, &readable))
+            continue;
+        Socket socket = static_cast<Socket>(accept(listener_, nullptr, nullptr));
+        if (socket == kNoSocket)
+            continue;
+#ifdef _WIN32
+        u_long nonBlocking = 1;
+        ioctlsocket(static_cast<SOCKET>(socket), FIONBIO, &nonBlocking);
+#else
+        int flags = fcntl(static_cast<int>(socket), F_GETFL, 0);
+        fcntl(static_cast<int>(socket), F_SETFL, flags | O_NONBLOCK);
+#endif
+        Client client;
+        client.socket = socket;
+        if (headerBytes) {
+            client.pending.push_back(headerBytes);
+            client.bytes = headerBytes->size();
+        }
+        if (drain(client))
+            clients_.push_back(std::move(client));
+        else
+            closeSocket(socket);
+    }
+}
+
+// Sends queued bytes until the socket would block. Returns false if the
+// client is gone. Called with mutex_ held.
+bool SocketTranscriptWriter::drain(Client &client) {
+    while (!client.pending.empty()) {
+        const std::string &bytes = *client.pending.front();
+        int n = static_cast<int>(send(client.socket, bytes.data() + client.offset,
+                                      static_cast<int>(bytes.size() - client.offset), kSendFlags));
+        if (n < 0) {
+#ifdef _WIN32
+            return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+        }
+        client.offset += static_cast<size_t>(n);
+        if (client.offset < bytes.size())
+            return true;
+        client.bytes -= bytes.size();
+        client.offset = 0;
+        client.pending.pop_front();
+    }
+    return true;
+}
+
+void SocketTranscriptWriter::closeSocket(Socket socket) {
+#ifdef _WIN32
+    closesocket(static_cast<SOCKET>(socket));
+#else
+    ::close(static_cast<int>(socket));
+#endif
+}
+
+//----------------------------------------------------------------------------
+// TranscriptSink
+//----------------------------------------------------------------------------
+
+static size_t formatIndex(TranscriptFormat format) {
+    return static_cast<size_t>(format);
+}
+
+// "HH:MM:SS<sep>mmm", as SRT (',') and WebVTT ('.') want it.
+static void appendTimestamp(std::string &out, double seconds, char separator) {
+    long long ms = std::llround(std::max(0.0, seconds) * 1000.0);
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%02lld:%02lld:%02lld%c%03lld", ms / 3600000, (ms / 60000) % 60,
+                  (ms / 1000) % 60, separator, ms % 1000);
+    out += buffer;
+}
+
+void TranscriptSink::appendJsonString(std::string &out, std::string_view text) {
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned char>(c));
+                    out += buffer;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+static std::string_view trim(std::string_view text) {
+    const char *space = " \t\r\n";
+    size_t first = text.find_first_not_of(space);
+    if (first == std::string_view::npos)
+        return std::string_view();
+    size_t last = text.find_last_not_of(space);
+    return text.substr(first, last - first + 1);
+}
+
+TranscriptSink::TranscriptSink() : stdout_(false), next_(1) {}
+
+TranscriptSink::~TranscriptSink() {
+    close();
+}
+
+bool TranscriptSink::parseFormat(const std::string &name, TranscriptFormat &format) {
+    if (name == "jsonl" || name == "json")
+        format = TranscriptFormat::Jsonl;
+    else if (name == "srt")
+        format = TranscriptFormat::Srt;
+    else if (name == "vtt" || name == "webvtt")
+        format = TranscriptFormat::WebVtt;
+    else
+        return false;
+    return true;
+}
+
+bool TranscriptSink::add(const std::string &spec) {
+    size_t colon = spec.find(':');
+    TranscriptFormat format;
+    if (colon == std::string::npos || !parseFormat(spec.substr(0, colon), format)) {
+        std::cerr << "Invalid output '" << spec << "': expected <jsonl|srt|vtt>:<file|-|tcp:PORT>" << std::endl;
+        return false;
+    }
+    std::string target = spec.substr(colon + 1);
+    if (target.empty()) {
+        std::cerr << "Invalid output '" << spec << "': missing target" << std::endl;
+        return false;
+    }
+    if (target == "-" || target == "stdout") {
+        if (!add(std::unique_ptr<TranscriptWriter>(new StreamTranscriptWriter(format, std::cout))))
+            return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        stdout_ = true;
+        return true;
+    }
+    if (target.compare(0, 4, "tcp:") == 0) {
+        char *end = nullptr;
+        long port = std::strtol(target.c_str() + 4, &end, 10);
+        if (end == target.c_str() + 4 || *end != '\0' || port <= 0 || port > 65535) {
+            std::cerr << "Invalid output '" << spec << "': bad port" << std::endl;
+            return false;
+        }
+        return add(std::unique_ptr<TranscriptWriter>(new SocketTranscriptWriter(format, static_cast<int>(port))));
+    }
+    return add(std::unique_ptr<TranscriptWriter>(new FileTranscriptWriter(format, target)));
+}
+
+bool TranscriptSink::add(std::unique_ptr<TranscriptWriter> writer) {
+    if (!writer->open())
+        return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    writers_.push_back(std::move(writer));
+    return true;
+}
+
+bool TranscriptSink::empty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return writers_.empty();
+}
+
+bool TranscriptSink::writesStdout() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stdout_;
+}
+
+void TranscriptSink::publish(int stream, double start, double end, std::string_view text) {
+    text = trim(text);
+    if (text.empty())
+        return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (writers_.empty())
+        return;
+    TranscriptSegment segment;
+    segment.index = next_++;
+    segment.stream = stream;
+    segment.start = std::max(0.0, start);     // a first window can reach back before capture
+    segment.end = std::max(segment.start, end);
+    segment.text.assign(text.data(), text.size());
+
+    // Each format in use is rendered once; its writers share the bytes.
+    std::shared_ptr<const std::string> rendered[kFormats];
+    for (const std::unique_ptr<TranscriptWriter> &writer : writers_) {
+        std::shared_ptr<const std::string> &bytes = rendered[formatIndex(writer->format())];
+        if (!bytes) {
+            auto out = std::make_shared<std::string>();
+            format(writer->format(), segment, *out);
+            bytes = std::move(out);
+        }
+        writer->append(bytes);
+    }
+}
+
+void TranscriptSink::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const std::unique_ptr<TranscriptWriter> &writer : writers_)
+        writer->flush();
+}
+
+void TranscriptSink::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const std::unique_ptr<TranscriptWriter> &writer : writers_) {
+        writer->flush();
+        writer->close();
+    }
+    writers_.clear();
+}
+
+const char *TranscriptSink::header(TranscriptFormat format) {
+    return format == TranscriptFormat::WebVtt ? "WEBVTT\n\n" : "";
+}
+
+void TranscriptSink::format(TranscriptFormat format, const TranscriptSegment &segment, std::string &out) {
+    switch (format) {
+        case TranscriptFormat::Jsonl: {
+            char times[96];
+            std::snprintf(times, sizeof(times), "{\"index\":%llu,\"stream\":%d,\"start\":%.3f,\"end\":%.3f,\"text\":",
+                          static_cast<unsigned long long>(segment.index), segment.stream, segment.start, segment.end);
+            out += times;
+            appendJsonString(out, segment.text);
+            out += "}\n";
+            break;
+        }
+        case TranscriptFormat::Srt:
+            out += std::to_string(segment.index);
+            out += '\n';
+            appendTimestamp(out, segment.start, ',');
+            out += " --> ";
+            appendTimestamp(out, segment.end, ',');
+            out += '\n';
+            out += segment.text;
+            out += "\n\n";
+            break;
+        case TranscriptFormat::WebVtt:
+            appendTimestamp(out, segment.start, '.');
+            out += " --> ";
+            appendTimestamp(out, segment.end, '.');
+            out += '\n';
+            out += segment.text;
+            out += "\n\n";
+            break;
+    }
+}
@@ -0,0 +1,97 @@
+#include "TranscriptStitcher.hpp"
+
+#include <cmath>
+
+TranscriptStitcher::TranscriptStitcher(const StitcherConfig &config)
+    : config_(config), windowStart_(0), overlapEnd_(0), lastSkip_(0) {
+    previous_.reserve(config_.reserveTokens);
+    current_.reserve(config_.reserveTokens);
+    failure_.reserve(config_.reserveTokens);
+}
+
+TranscriptStitcher::~TranscriptStitcher() {}
+
+void TranscriptStitcher::beginWindow(double startSeconds, double overlapSeconds) {
+    current_.clear();
+    windowStart_ = static_cast<int64_t>(std::llround(startSeconds * 100.0));
+    overlapEnd_ = windowStart_ + static_cast<int64_t>(std::llround(overlapSeconds * 100.0));
+}
+
+void TranscriptStitcher::addToken(whisper_token id, int64_t t0, int64_t t1, const char *text) {
+    current_.push_back({id, windowStart_ + t0, windowStart_ + t1, text ? text : ""});
+}
+
+void TranscriptStitcher::addTokens(const WhisperSession &session) {
+    for (const SessionToken &token : session.tokens())
+        addToken(token.id, token.t0, token.t1, token.text);
+}
+
+size_t TranscriptStitcher::align() const {
+    const int64_t slack = config_.slackMs / 10;
+    // Head of the new window: tokens starting inside the overlap.
+    size_t m = 0;
+    while (m < current_.size() && current_[m].t0 < overlapEnd_ + slack)
+        m++;
+    // Tail of the previous window: tokens ending inside it.
+    size_t prevBegin = previous_.size();
+    while (prevBegin > 0 && previous_[prevBegin - 1].t1 > windowStart_ - slack)
+        prevBegin--;
+    if (m == 0 || prevBegin == previous_.size())
+        return 0;
+
+    // KMP: failure_[i] is the longest proper prefix of head[0..i] that is
+    // also its suffix.
+    failure_.resize(m);
+    failure_[0] = 0;
+    size_t k = 0;
+    for (size_t i = 1; i < m; i++) {
+        while (k > 0 && current_[i].id != current_[k].id)
+            k = failure_[k - 1];
+        if (current_[i].id == current_[k].id)
+            k++;
+        failure_[i] = k;
+    }
+    // Run the tail through the automaton; the final state is the longest
+    // head prefix that ends the tail.
+    size_t q = 0;
+    for (size_t i = prevBegin; i < previous_.size(); i++) {
+        while (q > 0 && (q == m || previous_[i].id != current_[q].id))
+            q = failure_[q - 1];
+        if (previous_[i].id == current_[q].id)
+            q++;
+    }
+    return q;
+}
+
+size_t TranscriptStitcher::commit(std::string &committed) {
+    size_t skip = align();
+    if (skip < config_.minMatchTokens) {
+        // No alignment: drop what the previous window already covered.
+        skip = 0;
+        if (!previous_.empty()) {
+            const int64_t covered = previous_.back().t1;
+            while (skip < current_.size() && (current_[skip].t0 + current_[skip].t1) / 2 < covered)
+                skip++;
+        }
+    }
+    for (size_t i = skip; i < current_.size(); i++)
+        committed += current_[i].text;
+    previous_.swap(current_);
+    current_.clear();
+    lastSkip_ = skip;
+    return skip;
+}
+
+bool TranscriptStitcher::committedSpan(double &start, double &end) const {
+    if (lastSkip_ >= previous_.size())
+        return false;
+    start = previous_[lastSkip_].t0 / 100.0;
+    end = previous_.back().t1 / 100.0;
+    return true;
+}
+
+void TranscriptStitcher::reset() {
+    previous_.clear();
+    current_.clear();
+    lastSkip_ = 0;
+}
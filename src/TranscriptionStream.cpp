@@ -0,0 +1,224 @@
+#include "TranscriptionStream.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+// Latencies kept per stream for the percentile estimates.
+static const size_t kLatencyWindow = 512;
+
+// Stores captured blocks in the ring and counts them off in chunks of the
+// assembler's size. Runs on the capture callback: the count is a relaxed
+// increment and Notifier::notify() only takes a lock while a worker waits.
+class TranscriptionStream::ChunkSink : public RingBufferSink {
+    public:
+        ChunkSink(RingBuffer &ring, size_t chunkFrames, Notifier *notifier)
+            : RingBufferSink(ring), chunkFrames_(std::max<size_t>(1, chunkFrames)), notifier_(notifier),
+              frames_(0), chunks_(0) {}
+
+        void onAudio(const CaptureBlock &block) override {
+            RingBufferSink::onAudio(block);
+            frames_ += block.audio.frames;
+            if (frames_ < chunkFrames_)
+                return;
+            frames_ %= chunkFrames_;
+            chunks_.fetch_add(1, std::memory_order_relaxed);
+            if (Notifier *notifier = notifier_.load(std::memory_order_acquire))
+                notifier->notify();
+        }
+
+        void setNotifier(Notifier *notifier) { notifier_.store(notifier, std::memory_order_release); }
+        uint64_t chunks() const { return chunks_.load(std::memory_order_relaxed); }
+    private:
+        const size_t chunkFrames_;
+        std::atomic<Notifier *> notifier_;
+        size_t frames_;             // Callback thread only.
+        std::atomic<uint64_t> chunks_;
+};
+
+TranscriptionStream::TranscriptionStream(int id, whisper_context *ctx, const StreamConfig &config)
+    : id_(id),
+      name_("stream " + std::to_string(id)),
+      ctx_(ctx),
+      state_(nullptr),
+      config_(config),
+      notifier_(nullptr),
+      partialSamples_(0),
+      pushedSamples_(0),
+      deviceRate_(0.0),
+      latencyNext_(0) {
+    config_.segmenter.sampleRate = config_.whisperRate;
+    latencies_.reserve(kLatencyWindow);
+}
+
+TranscriptionStream::~TranscriptionStream() {
+    if (capture_)
+        capture_->close();
+    if (state_)
+        whisper_free_state(state_);
+}
+
+bool TranscriptionStream::open(PaDeviceIndex device) {
+    std::unique_ptr<AAudioDevice> info = AAudioDevice::createInstance(device);
+    capture_ = AudioCapture::createInstance();
+    if (!info || !capture_) {
+        std::cerr << "Audio capture is not supported on this platform." << std::endl;
+        return false;
+    }
+    if (info->getID() < 0 || info->getDeviceInfo().maxInputChannels <= 0) {
+        std::cerr << "Device " << device << " has no input channels." << std::endl;
+        return false;
+    }
+    name_ = info->getDeviceInfo().name;
+
+    state_ = whisper_init_state(ctx_);
+    if (!state_) {
+        std::cerr << "Failed to allocate Whisper state for " << name_ << std::endl;
+        return false;
+    }
+    WhisperSessionConfig sessionConfig;
+    sessionConfig.language = config_.language;
+    session_.reset(new WhisperSession(ctx_, state_, sessionConfig));
+
+    capture_->setFramesPerBuffer(static_cast<unsigned long>(config_.framesPerBuffer));
+    if (!capture_->open(info.get(), SampleFormat::Int16)) {
+        std::cerr << "Failed to open " << name_ << std::endl;
+        return false;
+    }
+    const CaptureFormat &format = capture_->getFormat();
+    deviceRate_ = format.sampleRate;
+    size_t chunkFrames = static_cast<size_t>(format.sampleRate * config_.chunkMs / 1000.0);
+    size_t ringFrames = static_cast<size_t>(format.sampleRate) * static_cast<size_t>(config_.ringSeconds);
+    ring_.reset(new RingBuffer(ringFrames, format.channels));
+    sink_.reset(new ChunkSink(*ring_, chunkFrames, notifier_));
+    capture_->setSink(sink_.get());
+    assembler_.reset(new ChunkAssembler(chunkFrames, 0, format.channels, format.sampleRate, config_.whisperRate));
+    segmenter_.reset(new UtteranceSegmenter(config_.segmenter, config_.vad));
+    utterance_.samples.reserve(static_cast<size_t>(config_.segmenter.maxUtteranceMs) * config_.whisperRate / 1000);
+    return true;
+}
+
+bool TranscriptionStream::start() {
+    if (!capture_)
+        return false;
+    lastPush_ = std::chrono::steady_clock::now();
+    return capture_->start();
+}
+
+void TranscriptionStream::stop() {
+    if (capture_)
+        capture_->stop();
+}
+
+void TranscriptionStream::setNotifier(Notifier *notifier) {
+    notifier_ = notifier;
+    if (sink_)
+        sink_->setNotifier(notifier);
+}
+
+uint64_t TranscriptionStream::chunksCaptured() const {
+    return sink_ ? sink_->chunks() : 0;
+}
+
+void TranscriptionStream::pump() {
+    while (assembler_->assemble(*ring_)) {
+        segmenter_->push(assembler_->data(), assembler_->size());
+        pushedSamples_ += assembler_->size();
+        lastPush_ = std::chrono::steady_clock::now();
+        assembler_->advance();
+    }
+}
+
+bool TranscriptionStream::process(ThreadScheduler &threads, size_t slot, const TextCallback &onText) {
+    std::unique_lock<std::mutex> lock(busy_, std::try_to_lock);
+    if (!lock.owns_lock() || !state_)
+        return false;
+    pump();
+    const size_t partialStep = static_cast<size_t>(std::max(0, config_.partialMs)) * config_.whisperRate / 1000;
+    bool partial = false;
+    if (segmenter_->pop(utterance_)) {
+        partialSamples_ = 0;
+    } else if (partialStep > 0 && segmenter_->peekOpen(utterance_, partialSamples_ + partialStep)) {
+        partial = true;
+    } else {
+        return false;
+    }
+
+    const double utteranceSeconds = static_cast<double>(utterance_.samples.size()) / config_.whisperRate;
+    // The next utterance can end as soon as this one's length after it; the
+    // next partial is due after partialMs.
+    const double budget = partial ? config_.partialMs / 1000.0 : utteranceSeconds;
+    const int n_threads = threads.begin(slot);
+    auto t0 = std::chrono::steady_clock::now();
+    session_->prepare(n_threads);
+    bool decoded = session_->decode(utterance_.samples.data(), utterance_.samples.size());
+    auto t1 = std::chrono::steady_clock::now();
+    // A failed call is not a load measurement; a zero budget only releases its threads.
+    threads.end(slot, n_threads, std::chrono::duration<double>(t1 - t0).count(), decoded ? budget : 0.0);
+    if (partial)
+        partialSamples_ = utterance_.samples.size();
+    if (!decoded) {
+        std::cerr << "whisper_full_with_state() failed on " << name_ << std::endl;
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.decodeFailures++;
+        return true;
+    }
+
+    // Wall time at which the utterance's last sample was captured, derived
+    // from the capture clock of the most recent push.
+    uint64_t end = utterance_.start + utterance_.samples.size();
+    double behindSeconds = static_cast<double>(pushedSamples_ - std::min(pushedSamples_, end)) / config_.whisperRate;
+    auto captured = lastPush_ - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                    std::chrono::duration<double>(behindSeconds));
+    double latencyMs = std::chrono::duration<double, std::milli>(t1 - captured).count();
+
+    if (!partial)
+        record(utteranceSeconds, std::chrono::duration<double>(t1 - t0).count(), latencyMs);
+    StreamResult result;
+    result.session = session_.get();
+    // The segmenter has seen everything up to the assembler's position.
+    result.startSeconds = static_cast<double>(assembler_->position()) / deviceRate_ -
+                          static_cast<double>(pushedSamples_ - std::min(pushedSamples_, utterance_.start)) /
+                              config_.whisperRate;
+    result.partial = partial;
+    result.captured = captured;
+    if (onText && !session_->text().empty())
+        onText(*this, result);
+    return true;
+}
+
+void TranscriptionStream::record(double audioSeconds, double inferenceSeconds, double latencyMs) {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    stats_.utterances++;
+    stats_.audioSeconds += audioSeconds;
+    stats_.inferenceSeconds += inferenceSeconds;
+    stats_.latencyMaxMs = std::max(stats_.latencyMaxMs, latencyMs);
+    stats_.latencyMeanMs += (latencyMs - stats_.latencyMeanMs) / static_cast<double>(stats_.utterances);
+    if (latencies_.size() < kLatencyWindow) {
+        latencies_.push_back(static_cast<float>(latencyMs));
+    } else {
+        latencies_[latencyNext_] = static_cast<float>(latencyMs);
+        latencyNext_ = (latencyNext_ + 1) % kLatencyWindow;
+    }
+}
+
+int TranscriptionStream::id() const {
+    return id_;
+}
+
+const std::string &TranscriptionStream::name() const {
+    return name_;
+}
+
+StreamStats TranscriptionStream::stats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    StreamStats out = stats_;
+    out.overruns = ring_ ? ring_->overruns() : 0;
+    if (!latencies_.empty()) {
+        std::vector<float> sorted(latencies_);
+        std::sort(sorted.begin(), sorted.end());
+        out.latencyP50Ms = sorted[sorted.size() / 2];
+        out.latencyP95Ms = sorted[std::min(sorted.size() - 1, sorted.size() * 95 / 100)];
+    }
+    return out;
+}
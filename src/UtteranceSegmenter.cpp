@@ -0,0 +1,194 @@
+#include "UtteranceSegmenter.hpp"
+
+#include <algorithm>
+
+UtteranceSegmenter::UtteranceSegmenter(const SegmenterConfig &config, const VadConfig &vadConfig)
+    : config_(config),
+      vad_(vadConfig),
+      bufferStart_(0),
+      inUtterance_(false),
+      utteranceStart_(0),
+      lastSpeechEnd_(0),
+      lastVoiceEnd_(0),
+      droppedShort_(0) {
+    size_t perMs = static_cast<size_t>(config_.sampleRate) / 1000;
+    minSamples_ = static_cast<size_t>(config_.minUtteranceMs) * perMs;
+    maxSamples_ = static_cast<size_t>(config_.maxUtteranceMs) * perMs;
+    silenceSamples_ = static_cast<size_t>(config_.silenceTimeoutMs) * perMs;
+    paddingSamples_ = static_cast<size_t>(config_.paddingMs) * perMs;
+    lookbackSamples_ = paddingSamples_ + static_cast<size_t>(std::max(vadConfig.onsetFrames, 0)) * vad_.frameSize();
+    splitSearchSamples_ = std::min(static_cast<size_t>(config_.splitSearchMs) * perMs, maxSamples_ / 2);
+
+    size_t capacity = maxSamples_ + silenceSamples_ + lookbackSamples_;
+    audio_.reserve(capacity * 2);
+    frames_.reserve(capacity / vad_.frameSize() * 2 + 2);
+    segments_.reserve(16);
+    ready_.reserve(16);
+}
+
+UtteranceSegmenter::~UtteranceSegmenter() {}
+
+void UtteranceSegmenter::emit(uint64_t start, uint64_t end, bool forced) {
+    if (end <= start)
+        return;
+    if (!forced && end - start < minSamples_) {
+        droppedShort_++;
+        return;
+    }
+    Range range;
+    range.start = start;
+    range.end = end;
+    range.forced = forced;
+    ready_.push_back(range);
+}
+
+void UtteranceSegmenter::handleSegments() {
+    for (const SpeechSegment &segment : segments_) {
+        // Closes a segment whose speech was already flushed by the timeout.
+        if (!inUtterance_ && segment.speechEnd <= lastVoiceEnd_)
+            continue;
+        uint64_t start = std::max(bufferStart_, segment.start > paddingSamples_ ? segment.start - paddingSamples_ : 0);
+        if (inUtterance_ && segment.start > lastVoiceEnd_ && segment.start - lastVoiceEnd_ > silenceSamples_) {
+            emit(utteranceStart_, lastSpeechEnd_, false);
+            inUtterance_ = false;
+        }
+        if (!inUtterance_) {
+            inUtterance_ = true;
+            utteranceStart_ = std::max(start, lastSpeechEnd_);
+        }
+        lastSpeechEnd_ = segment.end;
+        lastVoiceEnd_ = segment.speechEnd;
+    }
+    segments_.clear();
+
+    if (vad_.inSpeech()) {
+        uint64_t speechStart = vad_.speechStart();
+        uint64_t speechEnd = vad_.speechEnd();
+        if (inUtterance_ && speechStart > lastVoiceEnd_ && speechStart - lastVoiceEnd_ > silenceSamples_) {
+            emit(utteranceStart_, lastSpeechEnd_, false);
+            inUtterance_ = false;
+        }
+        if (!inUtterance_ && speechEnd > lastVoiceEnd_) {
+            inUtterance_ = true;
+            uint64_t start = speechStart > paddingSamples_ ? speechStart - paddingSamples_ : 0;
+            utteranceStart_ = std::max(std::max(bufferStart_, start), lastSpeechEnd_);
+            lastSpeechEnd_ = std::max(lastSpeechEnd_, speechStart);
+            lastVoiceEnd_ = speechEnd;
+        }
+        // In the hangover: flush once the timeout has passed since the last
+        // speech frame instead of waiting for the detector to close.
+        if (inUtterance_ && vad_.position() - speechEnd >= silenceSamples_) {
+            lastSpeechEnd_ = std::max(lastSpeechEnd_, vad_.position());
+            lastVoiceEnd_ = speechEnd;
+            emit(utteranceStart_, lastSpeechEnd_, false);
+            inUtterance_ = false;
+        }
+    } else if (inUtterance_ && vad_.position() - lastVoiceEnd_ >= silenceSamples_) {
+        emit(utteranceStart_, lastSpeechEnd_, false);
+        inUtterance_ = false;
+    }
+}
+
+// Cuts open speech that exceeds the maximum length at the quietest frame in
+// the search window before the limit.
+void UtteranceSegmenter::splitLongUtterance() {
+    uint64_t end = vad_.inSpeech() ? vad_.position() : lastSpeechEnd_;
+    while (inUtterance_ && end - utteranceStart_ > maxSamples_) {
+        uint64_t limit = utteranceStart_ + maxSamples_;
+        uint64_t searchFrom = limit - splitSearchSamples_;
+        uint64_t cut = limit;
+        float quietest = 0.0f;
+        bool found = false;
+        for (const VadFrame &frame : frames_) {
+            if (frame.start < searchFrom)
+                continue;
+            if (frame.start + vad_.frameSize() > limit)
+                break;
+            if (!found || frame.energyDb < quietest) {
+                quietest = frame.energyDb;
+                cut = frame.start + vad_.frameSize() / 2;
+                found = true;
+            }
+        }
+        emit(utteranceStart_, cut, true);
+        utteranceStart_ = cut;
+    }
+}
+
+void UtteranceSegmenter::trim() {
+    // Speech starts are back-dated to the first onset frame, so the padding
+    // is kept from there.
+    uint64_t keepFrom = vad_.position() > lookbackSamples_ ? vad_.position() - lookbackSamples_ : 0;
+    if (inUtterance_)
+        keepFrom = std::min(keepFrom, utteranceStart_);
+    if (!ready_.empty())
+        keepFrom = std::min(keepFrom, ready_.front().start);
+    if (keepFrom <= bufferStart_)
+        return;
+
+    size_t drop = static_cast<size_t>(std::min<uint64_t>(keepFrom - bufferStart_, audio_.size()));
+    audio_.erase(audio_.begin(), audio_.begin() + drop);
+    bufferStart_ += drop;
+    auto firstKept = std::find_if(frames_.begin(), frames_.end(),
+                                  [this](const VadFrame &frame) { return frame.start >= bufferStart_; });
+    frames_.erase(frames_.begin(), firstKept);
+}
+
+void UtteranceSegmenter::push(const float *samples, size_t count) {
+    audio_.insert(audio_.end(), samples, samples + count);
+    vad_.process(samples, count, frames_, segments_);
+    handleSegments();
+    splitLongUtterance();
+    trim();
+}
+
+bool UtteranceSegmenter::pop(Utterance &out) {
+    if (ready_.empty())
+        return false;
+    Range range = ready_.front();
+    ready_.erase(ready_.begin());
+
+    uint64_t start = std::max(range.start, bufferStart_);
+    uint64_t end = std::min<uint64_t>(range.end, bufferStart_ + audio_.size());
+    out.start = start;
+    out.forced = range.forced;
+    out.samples.assign(audio_.begin() + static_cast<size_t>(start - bufferStart_),
+                       audio_.begin() + static_cast<size_t>(end - bufferStart_));
+    trim();
+    return true;
+}
+
+bool UtteranceSegmenter::peekOpen(Utterance &out, size_t minSamples) const {
+    if (!inUtterance_)
+        return false;
+    uint64_t start = std::max(utteranceStart_, bufferStart_);
+    uint64_t end = bufferStart_ + audio_.size();
+    if (end <= start || end - start < std::max<uint64_t>(minSamples, 1))
+        return false;
+    out.start = start;
+    out.forced = false;
+    out.samples.assign(audio_.begin() + static_cast<size_t>(start - bufferStart_), audio_.end());
+    return true;
+}
+
+void UtteranceSegmenter::flush() {
+    vad_.finish(segments_);
+    handleSegments();
+    splitLongUtterance();
+    if (inUtterance_) {
+        emit(utteranceStart_, std::max(lastSpeechEnd_, utteranceStart_), false);
+        inUtterance_ = false;
+    }
+}
+
+size_t UtteranceSegmenter::pending() const {
+    return ready_.size();
+}
+
+uint64_t UtteranceSegmenter::droppedShort() const {
+    return droppedShort_;
+}
+
+const VoiceActivityDetector &UtteranceSegmenter::vad() const {
+    return vad_;
+}
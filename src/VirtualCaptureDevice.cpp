@@ -0,0 +1,136 @@
+#include "VirtualCaptureDevice.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+VirtualCaptureDevice::VirtualCaptureDevice()
+    : sink_(nullptr), fromFile_(false), running_(false), finished_(false) {}
+
+VirtualCaptureDevice::~VirtualCaptureDevice() {
+    stop();
+}
+
+bool VirtualCaptureDevice::open(const VirtualDeviceConfig &config) {
+    config_ = config;
+    fromFile_ = (config_.source != "null");
+    if (fromFile_) {
+        if (!reader_.open(config_.source))
+            return false;
+        config_.sampleRate = reader_.sampleRate();
+        config_.channels = reader_.channels();
+        name_ = "Virtual (" + config_.source + ")";
+    } else {
+        name_ = "Virtual (null)";
+    }
+    config_.framesPerBuffer = std::max(1ul, config_.framesPerBuffer);
+    buffer_.assign(config_.framesPerBuffer * static_cast<size_t>(config_.channels), 0);
+    finished_ = false;
+    return true;
+}
+
+bool VirtualCaptureDevice::start(AudioSink *sink) {
+    if (!sink || running_)
+        return false;
+    sink_ = sink;
+    running_ = true;
+    thread_ = std::thread(&VirtualCaptureDevice::run, this);
+    return true;
+}
+
+void VirtualCaptureDevice::stop() {
+    running_ = false;
+    if (thread_.joinable())
+        thread_.join();
+}
+
+// Converts the next frames of the file to int16; returns the frames read.
+size_t VirtualCaptureDevice::fill(int16_t *out, size_t frames) {
+    AudioView view = reader_.read(frames);
+    const size_t samples = view.frames * static_cast<size_t>(view.channels);
+    const uint8_t *in = view.data;
+    switch (view.format) {
+        case SampleFormat::Int16:
+            std::memcpy(out, in, samples * sizeof(int16_t));
+            break;
+        case SampleFormat::Int24:
+            for (size_t i = 0; i < samples; i++) {
+                out[i] = static_cast<int16_t>(in[i * 3 + 1] | (in[i * 3 + 2] << 8));
+            }
+            break;
+        case SampleFormat::Int32:
+            for (size_t i = 0; i < samples; i++) {
+                out[i] = static_cast<int16_t>(in[i * 4 + 2] | (in[i * 4 + 3] << 8));
+            }
+            break;
+        case SampleFormat::Float32:
+            for (size_t i = 0; i < samples; i++) {
+                float f;
+                std::memcpy(&f, in + i * 4, sizeof(f));
+                f = std::min(1.0f, std::max(-1.0f, f));
+                out[i] = static_cast<int16_t>(f * 32767.0f);
+            }
+            break;
+    }
+    return view.frames;
+}
+
+void VirtualCaptureDevice::run() {
+    using Clock = std::chrono::steady_clock;
+    const size_t period = config_.framesPerBuffer;
+    const auto step = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(config_.speed > 0.0 ? period / config_.sampleRate / config_.speed : 0.0));
+    size_t tailFrames = static_cast<size_t>(config_.tailSeconds * config_.sampleRate);
+    uint64_t frameIndex = 0;
+    auto deadline = Clock::now();
+
+    while (running_) {
+        size_t got = period;
+        if (fromFile_) {
+            got = fill(buffer_.data(), period);
+            if (got < period) {
+                // End of file: pad with silence, then count down the tail.
+                std::fill(buffer_.begin() + got * config_.channels, buffer_.end(), 0);
+                size_t silent = period - got;
+                tailFrames -= std::min(tailFrames, silent);
+                if (tailFrames == 0 && got == 0) {
+                    finished_ = true;
+                    break;
+                }
+            }
+        }
+
+        CaptureBlock block;
+        block.audio.data = reinterpret_cast<const uint8_t *>(buffer_.data());
+        block.audio.frames = period;
+        block.audio.channels = config_.channels;
+        block.audio.format = SampleFormat::Int16;
+        block.frameIndex = frameIndex;
+        block.adcTime = frameIndex / config_.sampleRate;
+        sink_->onAudio(block);
+        frameIndex += period;
+
+        if (config_.speed > 0.0) {
+            deadline += step;
+            std::this_thread::sleep_until(deadline);
+        }
+    }
+    running_ = false;
+}
+
+bool VirtualCaptureDevice::finished() const {
+    return finished_;
+}
+
+double VirtualCaptureDevice::sampleRate() const {
+    return config_.sampleRate;
+}
+
+int VirtualCaptureDevice::channels() const {
+    return config_.channels;
+}
+
+const std::string &VirtualCaptureDevice::name() const {
+    return name_;
+}
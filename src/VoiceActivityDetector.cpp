@@ -0,0 +1,245 @@
+#include "VoiceActivityDetector.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const float kPi = 3.14159265358979323846f;
+// Band used for spectral flatness; covers voiced speech formants.
+static const float kBandLowHz = 250.0f;
+static const float kBandHighHz = 4000.0f;
+// Frames used to learn the initial noise floor.
+static const uint64_t kTrainingFrames = 10;
+
+static size_t nextPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+VoiceActivityDetector::VoiceActivityDetector(const VadConfig &config)
+    : config_(config), pendingCount_(0) {
+    frameSize_ = static_cast<size_t>(std::max(1, config_.sampleRate * config_.frameMs / 1000));
+    fftSize_ = nextPowerOfTwo(frameSize_);
+
+    float binHz = static_cast<float>(config_.sampleRate) / static_cast<float>(fftSize_);
+    bandLow_ = std::max<size_t>(1, static_cast<size_t>(kBandLowHz / binHz));
+    bandHigh_ = std::min(fftSize_ / 2, static_cast<size_t>(kBandHighHz / binHz));
+    if (bandHigh_ <= bandLow_)
+        bandHigh_ = std::min(fftSize_ / 2, bandLow_ + 1);
+
+    window_.resize(frameSize_);
+    for (size_t i = 0; i < frameSize_; i++) {
+        window_[i] = 0.5f - 0.5f * std::cos(2.0f * kPi * static_cast<float>(i) / static_cast<float>(frameSize_));
+    }
+
+    twiddles_.resize(fftSize_ / 2);
+    for (size_t i = 0; i < fftSize_ / 2; i++) {
+        float angle = -2.0f * kPi * static_cast<float>(i) / static_cast<float>(fftSize_);
+        twiddles_[i] = std::complex<float>(std::cos(angle), std::sin(angle));
+    }
+
+    size_t bits = 0;
+    while ((static_cast<size_t>(1) << bits) < fftSize_) {
+        bits++;
+    }
+    bitReverse_.resize(fftSize_);
+    for (size_t i = 0; i < fftSize_; i++) {
+        uint32_t reversed = 0;
+        for (size_t b = 0; b < bits; b++) {
+            if (i & (static_cast<size_t>(1) << b))
+                reversed |= 1u << (bits - 1 - b);
+        }
+        bitReverse_[i] = reversed;
+    }
+
+    spectrum_.resize(fftSize_);
+    pending_.resize(frameSize_);
+    reset();
+}
+
+VoiceActivityDetector::~VoiceActivityDetector() {}
+
+void VoiceActivityDetector::reset() {
+    pendingCount_ = 0;
+    position_ = 0;
+    framesSeen_ = 0;
+    noiseFloorDb_ = config_.minEnergyDb;
+    onsetCount_ = 0;
+    hangover_ = 0;
+    inSpeech_ = false;
+    candidateStart_ = 0;
+    speechStart_ = 0;
+    speechEnd_ = 0;
+}
+
+// In-place iterative radix-2 FFT of spectrum_ (input already bit-reversed).
+void VoiceActivityDetector::fft() {
+    for (size_t size = 2; size <= fftSize_; size <<= 1) {
+        size_t half = size >> 1;
+        size_t step = fftSize_ / size;
+        for (size_t start = 0; start < fftSize_; start += size) {
+            for (size_t k = 0; k < half; k++) {
+                std::complex<float> t = twiddles_[k * step] * spectrum_[start + k + half];
+                std::complex<float> u = spectrum_[start + k];
+                spectrum_[start + k] = u + t;
+                spectrum_[start + k + half] = u - t;
+            }
+        }
+    }
+}
+
+void VoiceActivityDetector::analyseFrame(const float *frame, VadFrame &out, bool &voiced, bool &unvoiced) {
+    // Energy and zero crossings in the time domain.
+    double energy = 0.0;
+    size_t crossings = 0;
+    for (size_t i = 0; i < frameSize_; i++) {
+        energy += static_cast<double>(frame[i]) * frame[i];
+        if (i > 0 && ((frame[i] >= 0.0f) != (frame[i - 1] >= 0.0f)))
+            crossings++;
+    }
+    float energyDb = 10.0f * std::log10(static_cast<float>(energy / frameSize_) + 1e-10f);
+    float zcr = static_cast<float>(crossings) / static_cast<float>(frameSize_);
+
+    // Spectral flatness (geometric / arithmetic mean of the power spectrum).
+    std::fill(spectrum_.begin(), spectrum_.end(), std::complex<float>(0.0f, 0.0f));
+    for (size_t i = 0; i < frameSize_; i++) {
+        spectrum_[bitReverse_[i]] = std::complex<float>(frame[i] * window_[i], 0.0f);
+    }
+    fft();
+    double logSum = 0.0;
+    double linSum = 0.0;
+    for (size_t k = bandLow_; k < bandHigh_; k++) {
+        float power = std::norm(spectrum_[k]) + 1e-12f;
+        logSum += std::log(power);
+        linSum += power;
+    }
+    double bins = static_cast<double>(bandHigh_ - bandLow_);
+    float flatness = static_cast<float>(std::exp(logSum / bins) / (linSum / bins));
+
+    // Raw decisions: loud enough above the floor and tonal (voiced), or
+    // clearly louder with a fricative-like zero-crossing rate (unvoiced).
+    // Unvoiced frames look like broadband noise, so they only extend speech.
+    bool aboveFloor = energyDb > noiseFloorDb_ + config_.energyMarginDb && energyDb > config_.minEnergyDb;
+    voiced = aboveFloor && flatness < config_.flatnessMax;
+    unvoiced = aboveFloor && !voiced && zcr > config_.fricativeZcr &&
+               energyDb > noiseFloorDb_ + 2.0f * config_.energyMarginDb;
+    bool raw = voiced || unvoiced;
+
+    // Noise floor: learn quickly at start, then fall fast / rise slowly on
+    // non-speech frames. Inside speech (including pauses held by the
+    // hangover) it only drifts up very slowly, so a permanently louder
+    // background is eventually absorbed but a long talker is not.
+    if (framesSeen_ < kTrainingFrames) {
+        noiseFloorDb_ = (framesSeen_ == 0) ? energyDb : 0.5f * (noiseFloorDb_ + energyDb);
+        voiced = false;
+        unvoiced = false;
+    } else if (energyDb < noiseFloorDb_) {
+        noiseFloorDb_ += (energyDb - noiseFloorDb_) * config_.floorFall;
+    } else if (!raw && !inSpeech_) {
+        noiseFloorDb_ += (energyDb - noiseFloorDb_) * config_.floorRise;
+    } else {
+        noiseFloorDb_ += (energyDb - noiseFloorDb_) * config_.floorRise * 0.005f;
+    }
+    framesSeen_++;
+
+    out.energyDb = energyDb;
+}
+
+void VoiceActivityDetector::process(const float *samples, size_t count,
+                                    std::vector<VadFrame> &frames, std::vector<SpeechSegment> &segments) {
+    while (count > 0) {
+        const float *frame = nullptr;
+        if (pendingCount_ == 0 && count >= frameSize_) {
+            frame = samples;
+            samples += frameSize_;
+            count -= frameSize_;
+        } else {
+            size_t take = std::min(count, frameSize_ - pendingCount_);
+            std::memcpy(pending_.data() + pendingCount_, samples, take * sizeof(float));
+            pendingCount_ += take;
+            samples += take;
+            count -= take;
+            if (pendingCount_ < frameSize_)
+                break;
+            frame = pending_.data();
+            pendingCount_ = 0;
+        }
+
+        VadFrame result;
+        result.start = position_;
+        bool voiced = false;
+        bool unvoiced = false;
+        analyseFrame(frame, result, voiced, unvoiced);
+        uint64_t frameEnd = position_ + frameSize_;
+
+        if (!inSpeech_) {
+            if (voiced) {
+                if (onsetCount_ == 0)
+                    candidateStart_ = position_;
+                if (++onsetCount_ >= config_.onsetFrames) {
+                    inSpeech_ = true;
+                    speechStart_ = candidateStart_;
+                    speechEnd_ = frameEnd;
+                    hangover_ = config_.hangoverFrames;
+                }
+            } else {
+                onsetCount_ = 0;
+            }
+        } else if (voiced || unvoiced) {
+            speechEnd_ = frameEnd;
+            hangover_ = config_.hangoverFrames;
+        } else if (--hangover_ <= 0) {
+            SpeechSegment segment;
+            segment.start = speechStart_;
+            segment.end = frameEnd;
+            segment.speechEnd = speechEnd_;
+            segments.push_back(segment);
+            inSpeech_ = false;
+            onsetCount_ = 0;
+        }
+
+        result.speech = inSpeech_;
+        frames.push_back(result);
+        position_ = frameEnd;
+    }
+}
+
+bool VoiceActivityDetector::finish(std::vector<SpeechSegment> &segments) {
+    if (!inSpeech_)
+        return false;
+    SpeechSegment segment;
+    segment.start = speechStart_;
+    segment.end = position_;
+    segment.speechEnd = speechEnd_;
+    segments.push_back(segment);
+    inSpeech_ = false;
+    onsetCount_ = 0;
+    return true;
+}
+
+bool VoiceActivityDetector::inSpeech() const {
+    return inSpeech_;
+}
+
+uint64_t VoiceActivityDetector::speechStart() const {
+    return speechStart_;
+}
+
+uint64_t VoiceActivityDetector::speechEnd() const {
+    return speechEnd_;
+}
+
+uint64_t VoiceActivityDetector::position() const {
+    return position_;
+}
+
+size_t VoiceActivityDetector::frameSize() const {
+    return frameSize_;
+}
+
+float VoiceActivityDetector::noiseFloorDb() const {
+    return noiseFloorDb_;
+}
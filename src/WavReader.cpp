@@ -0,0 +1,277 @@
+#include "WavReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Consumed data is handed back to the OS in steps of this many bytes.
+static const size_t kReleaseStep = 8 * 1024 * 1024;
+
+static const uint16_t kFormatPcm = 0x0001;
+static const uint16_t kFormatFloat = 0x0003;
+static const uint16_t kFormatExtensible = 0xFFFE;
+
+static uint32_t readLE32(const uint8_t *p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static uint16_t readLE16(const uint8_t *p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+WavReader::WavReader()
+    : base_(nullptr),
+      mappedBytes_(0),
+      data_(nullptr),
+      released_(0),
+#ifdef _WIN32
+      file_(INVALID_HANDLE_VALUE),
+      mapping_(nullptr),
+#else
+      fd_(-1),
+#endif
+      channels_(0),
+      sampleRate_(0),
+      format_(SampleFormat::Int16),
+      frameBytes_(0),
+      totalFrames_(0),
+      position_(0) {}
+
+WavReader::~WavReader() {
+    close();
+}
+
+bool WavReader::map(const std::string &path) {
+#ifdef _WIN32
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open WAV file: " << path << std::endl;
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) {
+        std::cerr << "Failed to get size of WAV file: " << path << std::endl;
+        return false;
+    }
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_) {
+        std::cerr << "Failed to map WAV file: " << path << std::endl;
+        return false;
+    }
+    base_ = static_cast<const uint8_t *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (!base_) {
+        std::cerr << "Failed to map WAV file: " << path << std::endl;
+        return false;
+    }
+    mappedBytes_ = static_cast<size_t>(size.QuadPart);
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        std::cerr << "Failed to open WAV file: " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || st.st_size == 0) {
+        std::cerr << "Failed to get size of WAV file: " << path << std::endl;
+        return false;
+    }
+    void *addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (addr == MAP_FAILED) {
+        std::cerr << "Failed to map WAV file: " << path << std::endl;
+        return false;
+    }
+    base_ = static_cast<const uint8_t *>(addr);
+    mappedBytes_ = static_cast<size_t>(st.st_size);
+    // Read-ahead is what makes the mapping faster than buffered reads.
+    madvise(addr, mappedBytes_, MADV_SEQUENTIAL);
+#endif
+    return true;
+}
+
+bool WavReader::parse(const std::string &path) {
+    if (mappedBytes_ < 12 || std::memcmp(base_, "RIFF", 4) != 0 || std::memcmp(base_ + 8, "WAVE", 4) != 0) {
+        std::cerr << "Not a RIFF/WAVE file: " << path << std::endl;
+        return false;
+    }
+
+    // Walk the chunk list until the data chunk; fmt must come before it.
+    bool haveFormat = false;
+    size_t offset = 12;
+    while (offset + 8 <= mappedBytes_) {
+        const uint8_t *chunk = base_ + offset;
+        size_t size = readLE32(chunk + 4);
+        const uint8_t *body = chunk + 8;
+        size_t available = mappedBytes_ - (offset + 8);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            if (size < 16 || size > available) {
+                std::cerr << "Malformed fmt chunk in WAV file: " << path << std::endl;
+                return false;
+            }
+            uint16_t tag = readLE16(body);
+            channels_ = readLE16(body + 2);
+            sampleRate_ = static_cast<int>(readLE32(body + 4));
+            uint16_t blockAlign = readLE16(body + 12);
+            uint16_t bitsPerSample = readLE16(body + 14);
+            if (tag == kFormatExtensible) {
+                // cbSize, wValidBitsPerSample, dwChannelMask, then the sub-format
+                // GUID whose first two bytes are the actual format tag.
+                if (size < 40 || readLE16(body + 16) < 22) {
+                    std::cerr << "Malformed WAVE_FORMAT_EXTENSIBLE header: " << path << std::endl;
+                    return false;
+                }
+                tag = readLE16(body + 24);
+            }
+
+            bool supported = true;
+            if (tag == kFormatPcm && bitsPerSample == 16)
+                format_ = SampleFormat::Int16;
+            else if (tag == kFormatPcm && bitsPerSample == 24)
+                format_ = SampleFormat::Int24;
+            else if (tag == kFormatPcm && bitsPerSample == 32)
+                format_ = SampleFormat::Int32;
+            else if (tag == kFormatFloat && bitsPerSample == 32)
+                format_ = SampleFormat::Float32;
+            else
+                supported = false;
+            frameBytes_ = bytesPerSample(format_) * static_cast<size_t>(channels_);
+            if (!supported || channels_ == 0 || sampleRate_ <= 0 || blockAlign != frameBytes_) {
+                std::cerr << "Unsupported WAV format (tag " << tag << ", " << bitsPerSample
+                          << " bits, " << channels_ << " channels): " << path << std::endl;
+                return false;
+            }
+            haveFormat = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat) {
+                std::cerr << "WAV data chunk before fmt chunk: " << path << std::endl;
+                return false;
+            }
+            // Recorders that were cut off leave a stale (or 0xFFFFFFFF) size;
+            // trust the file length instead.
+            if (size > available)
+                size = available;
+            data_ = body;
+            totalFrames_ = size / frameBytes_;
+            position_ = 0;
+            released_ = 0;
+            return true;
+        }
+        // Chunks are word aligned.
+        offset += 8 + size + (size & 1);
+    }
+    std::cerr << "No data chunk in WAV file: " << path << std::endl;
+    return false;
+}
+
+bool WavReader::open(const std::string &path) {
+    close();
+    if (!map(path) || !parse(path)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void WavReader::close() {
+#ifdef _WIN32
+    if (base_)
+        UnmapViewOfFile(base_);
+    if (mapping_)
+        CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE)
+        CloseHandle(file_);
+    mapping_ = nullptr;
+    file_ = INVALID_HANDLE_VALUE;
+#else
+    if (base_)
+        munmap(const_cast<uint8_t *>(base_), mappedBytes_);
+    if (fd_ >= 0)
+        ::close(fd_);
+    fd_ = -1;
+#endif
+    base_ = nullptr;
+    mappedBytes_ = 0;
+    data_ = nullptr;
+    released_ = 0;
+    channels_ = 0;
+    sampleRate_ = 0;
+    format_ = SampleFormat::Int16;
+    frameBytes_ = 0;
+    totalFrames_ = 0;
+    position_ = 0;
+}
+
+// Drops already-consumed pages from the working set so a long sequential
+// read does not grow the resident size to the whole file.
+void WavReader::releaseConsumed() {
+#ifndef _WIN32
+    size_t consumed = static_cast<size_t>(position_) * frameBytes_;
+    if (consumed - released_ < kReleaseStep)
+        return;
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t from = (static_cast<size_t>(data_ - base_) + released_) / page * page;
+    size_t to = (static_cast<size_t>(data_ - base_) + consumed) / page * page;
+    if (to > from)
+        madvise(const_cast<uint8_t *>(base_) + from, to - from, MADV_DONTNEED);
+    released_ = consumed;
+#endif
+}
+
+AudioView WavReader::view(uint64_t frame, size_t frames) const {
+    AudioView out;
+    out.channels = channels_;
+    out.format = format_;
+    if (!data_ || frame >= totalFrames_)
+        return out;
+    out.frames = static_cast<size_t>(std::min<uint64_t>(frames, totalFrames_ - frame));
+    out.data = data_ + static_cast<size_t>(frame) * frameBytes_;
+    return out;
+}
+
+AudioView WavReader::read(size_t frames) {
+    // Release before advancing so the returned view itself stays resident.
+    releaseConsumed();
+    AudioView out = view(position_, frames);
+    position_ += out.frames;
+    return out;
+}
+
+bool WavReader::seek(uint64_t frame) {
+    if (!data_ || frame > totalFrames_)
+        return false;
+    position_ = frame;
+    released_ = std::min(released_, static_cast<size_t>(position_) * frameBytes_);
+    return true;
+}
+
+int WavReader::channels() const {
+    return channels_;
+}
+
+int WavReader::sampleRate() const {
+    return sampleRate_;
+}
+
+SampleFormat WavReader::format() const {
+    return format_;
+}
+
+uint64_t WavReader::totalFrames() const {
+    return totalFrames_;
+}
+
+uint64_t WavReader::position() const {
+    return position_;
+}
@@ -0,0 +1,248 @@
+#include "WavWriter.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WAVWRITER_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+// stdio buffer for the session file; chunks are written in one call anyway.
+static const size_t kFileBuffer = 1 << 20;
+
+//---------------------------------------------------------------------------
+// float [-1, 1] -> int16 with clamping, 8 samples per step.
+//---------------------------------------------------------------------------
+static void floatToInt16(const float *in, int16_t *out, size_t count) {
+    size_t i = 0;
+#if defined(WAVWRITER_SSE2)
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), lo), hi);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4), lo), hi);
+        __m128i ia = _mm_cvtps_epi32(_mm_mul_ps(a, scale));
+        __m128i ib = _mm_cvtps_epi32(_mm_mul_ps(b, scale));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packs_epi32(ia, ib));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const float32x4_t lo = vdupq_n_f32(-1.0f);
+    const float32x4_t hi = vdupq_n_f32(1.0f);
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t a = vminq_f32(vmaxq_f32(vld1q_f32(in + i), lo), hi);
+        float32x4_t b = vminq_f32(vmaxq_f32(vld1q_f32(in + i + 4), lo), hi);
+        // Round to nearest by adding +-0.5 before the truncating conversion.
+        float32x4_t ha = vbslq_f32(vcltq_f32(a, vdupq_n_f32(0.0f)), vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f));
+        float32x4_t hb = vbslq_f32(vcltq_f32(b, vdupq_n_f32(0.0f)), vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f));
+        int32x4_t ia = vcvtq_s32_f32(vmlaq_n_f32(ha, a, 32767.0f));
+        int32x4_t ib = vcvtq_s32_f32(vmlaq_n_f32(hb, b, 32767.0f));
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(ia), vqmovn_s32(ib)));
+    }
+#endif
+    for (; i < count; i++) {
+        float f = std::min(1.0f, std::max(-1.0f, in[i])) * 32767.0f;
+        out[i] = static_cast<int16_t>(f < 0.0f ? f - 0.5f : f + 0.5f);
+    }
+}
+
+static void putLE32(uint8_t *p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+    p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+static void putLE16(uint8_t *p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+WavWriter::WavWriter(const WavWriterConfig &config)
+    : config_(config),
+      stopping_(false),
+      session_(nullptr),
+      sessionBytes_(0),
+      chunkIndex_(0),
+      running_(false),
+      written_(0),
+      dropped_(0) {
+    config_.slots = std::max<size_t>(config_.slots, 1);
+    slots_.resize(config_.slots);
+    free_.reserve(config_.slots);
+    for (size_t i = 0; i < config_.slots; i++) {
+        slots_[i].reserve(config_.slotSamples);
+        free_.push_back(i);
+    }
+    pcm_.reserve(config_.slotSamples);
+}
+
+WavWriter::~WavWriter() {
+    stop();
+}
+
+bool WavWriter::start() {
+    if (running_)
+        return true;
+    std::error_code ec;
+    std::filesystem::create_directories(config_.directory, ec);
+    if (ec) {
+        std::cerr << "Failed to create directory " << config_.directory << ": " << ec.message() << std::endl;
+        return false;
+    }
+    if (config_.mode == WavWriterMode::Session) {
+        std::filesystem::path path = std::filesystem::path(config_.directory) / (config_.prefix + ".wav");
+        session_ = std::fopen(path.string().c_str(), "wb");
+        if (!session_) {
+            std::cerr << "Failed to open session WAV: " << path.string() << std::endl;
+            return false;
+        }
+        std::setvbuf(session_, nullptr, _IOFBF, kFileBuffer);
+        sessionBytes_ = 0;
+        // Placeholder sizes, patched in stop().
+        if (!writeHeader(session_, 0)) {
+            std::fclose(session_);
+            session_ = nullptr;
+            return false;
+        }
+    }
+    stopping_ = false;
+    running_ = true;
+    thread_ = std::thread(&WavWriter::worker, this);
+    return true;
+}
+
+void WavWriter::stop() {
+    if (!running_)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    if (thread_.joinable())
+        thread_.join();
+    closeSession();
+    running_ = false;
+}
+
+bool WavWriter::write(const float *samples, size_t count) {
+    if (!running_ || count == 0)
+        return false;
+    size_t slot;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.empty()) {
+            dropped_++;
+            return false;
+        }
+        slot = free_.back();
+        free_.pop_back();
+    }
+    // The slot is owned by this thread until it is queued.
+    slots_[slot].assign(samples, samples + count);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready_.push_back(slot);
+    }
+    wake_.notify_one();
+    return true;
+}
+
+void WavWriter::worker() {
+    for (;;) {
+        size_t slot;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this]() { return !ready_.empty() || stopping_; });
+            if (ready_.empty())
+                return;
+            slot = ready_.front();
+            ready_.pop_front();
+        }
+        writeChunk(slots_[slot]);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(slot);
+        }
+    }
+}
+
+void WavWriter::writeChunk(const std::vector<float> &samples) {
+    pcm_.resize(samples.size());
+    floatToInt16(samples.data(), pcm_.data(), samples.size());
+    size_t bytes = pcm_.size() * sizeof(int16_t);
+
+    if (config_.mode == WavWriterMode::Session) {
+        if (std::fwrite(pcm_.data(), 1, bytes, session_) != bytes) {
+            std::cerr << "Failed to append to session WAV." << std::endl;
+            return;
+        }
+        sessionBytes_ += bytes;
+        written_++;
+        return;
+    }
+
+    std::string name = config_.prefix + "_" + std::to_string(chunkIndex_++) + ".wav";
+    std::filesystem::path path = std::filesystem::path(config_.directory) / name;
+    FILE *fp = std::fopen(path.string().c_str(), "wb");
+    if (!fp) {
+        std::cerr << "Failed to open file for WAV: " << path.string() << std::endl;
+        return;
+    }
+    bool ok = writeHeader(fp, static_cast<uint32_t>(bytes)) && std::fwrite(pcm_.data(), 1, bytes, fp) == bytes;
+    std::fclose(fp);
+    if (!ok) {
+        std::cerr << "Failed to write WAV: " << path.string() << std::endl;
+        return;
+    }
+    written_++;
+}
+
+// Canonical 44-byte mono 16-bit PCM header.
+bool WavWriter::writeHeader(FILE *fp, uint32_t dataBytes) {
+    uint8_t header[44];
+    std::memcpy(header, "RIFF", 4);
+    putLE32(header + 4, 36 + dataBytes);
+    std::memcpy(header + 8, "WAVE", 4);
+    std::memcpy(header + 12, "fmt ", 4);
+    putLE32(header + 16, 16);
+    putLE16(header + 20, 1);                                        // PCM
+    putLE16(header + 22, 1);                                        // mono
+    putLE32(header + 24, static_cast<uint32_t>(config_.sampleRate));
+    putLE32(header + 28, static_cast<uint32_t>(config_.sampleRate) * 2);
+    putLE16(header + 32, 2);                                        // block align
+    putLE16(header + 34, 16);                                       // bits per sample
+    std::memcpy(header + 36, "data", 4);
+    putLE32(header + 40, dataBytes);
+    return std::fwrite(header, 1, sizeof(header), fp) == sizeof(header);
+}
+
+void WavWriter::closeSession() {
+    if (!session_)
+        return;
+    // RIFF sizes are 32-bit; longer sessions keep the maximum and readers
+    // fall back to the file length.
+    uint32_t dataBytes = static_cast<uint32_t>(std::min<uint64_t>(sessionBytes_, 0xFFFFFFFFu - 36));
+    if (std::fseek(session_, 0, SEEK_SET) != 0 || !writeHeader(session_, dataBytes))
+        std::cerr << "Failed to patch session WAV header." << std::endl;
+    std::fclose(session_);
+    session_ = nullptr;
+}
+
+bool WavWriter::running() const {
+    return running_;
+}
+
+uint64_t WavWriter::chunksWritten() const {
+    return written_;
+}
+
+uint64_t WavWriter::chunksDropped() const {
+    return dropped_;
+}
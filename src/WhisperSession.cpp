@@ -0,0 +1,132 @@
+#include "WhisperSession.hpp"
+
+WhisperSession::WhisperSession(whisper_context *ctx, whisper_state *state, const WhisperSessionConfig &config)
+    : ctx_(ctx), state_(state), config_(config) {
+    base_ = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    base_.print_progress   = false;
+    base_.print_special    = false;
+    base_.print_realtime   = false;
+    base_.print_timestamps = false;
+    base_.translate        = config_.translate;
+    base_.no_context       = config_.noContext;
+    base_.language         = config_.language.c_str();
+    base_.token_timestamps = config_.tokenTimestamps;
+    base_.n_threads        = config_.threads;
+    params_ = base_;
+    text_.reserve(config_.reserveText);
+    ends_.reserve(config_.reserveSegments);
+    segments_.reserve(config_.reserveSegments);
+    tokens_.reserve(config_.collectTokens ? config_.reserveTokens : 0);
+}
+
+WhisperSession::~WhisperSession() {}
+
+whisper_full_params &WhisperSession::prepare(int threads) {
+    params_ = base_;
+    params_.n_threads = threads;
+    return params_;
+}
+
+whisper_full_params &WhisperSession::params() {
+    return params_;
+}
+
+bool WhisperSession::decode(const float *samples, size_t count) {
+    text_.clear();
+    ends_.clear();
+    segments_.clear();
+    tokens_.clear();
+    int ret = state_ ? whisper_full_with_state(ctx_, state_, params_, samples, static_cast<int>(count))
+                     : whisper_full(ctx_, params_, samples, static_cast<int>(count));
+    if (ret != 0)
+        return false;
+    collect();
+    return true;
+}
+
+void WhisperSession::collect() {
+    const int n = segmentCount();
+    // Texts first, views second: the arena may still grow while appending.
+    for (int s = 0; s < n; s++) {
+        const char *text = segmentText(s);
+        if (text)
+            text_ += text;
+        ends_.push_back(text_.size());
+    }
+    size_t begin = 0;
+    for (int s = 0; s < n; s++) {
+        std::string_view text(text_.data() + begin, ends_[s] - begin);
+        segments_.push_back({text, segmentStart(s), segmentEnd(s), 0});
+        begin = ends_[s];
+    }
+    if (!config_.collectTokens)
+        return;
+
+    const whisper_token eot = whisper_token_eot(ctx_);
+    for (int s = 0; s < n; s++) {
+        const int64_t s0 = segments_[s].t0;
+        const int64_t s1 = segments_[s].t1;
+        const int count = tokenCount(s);
+        int64_t textTokens = 0;
+        const size_t first = tokens_.size();
+        for (int j = 0; j < count; j++) {
+            whisper_token_data data = tokenData(s, j);
+            if (data.id >= eot)     // skip special and timestamp tokens
+                continue;
+            tokens_.push_back({data.id, data.t0, data.t1, whisper_token_to_str(ctx_, data.id)});
+            textTokens++;
+        }
+        for (int64_t k = 0; k < textTokens; k++) {
+            SessionToken &token = tokens_[first + static_cast<size_t>(k)];
+            if (token.t0 < 0 || token.t1 < token.t0) {
+                token.t0 = s0 + (s1 - s0) * k / textTokens;
+                token.t1 = s0 + (s1 - s0) * (k + 1) / textTokens;
+            }
+        }
+        segments_[s].tokenEnd = tokens_.size();
+    }
+}
+
+std::string_view WhisperSession::text() const {
+    return text_;
+}
+
+const std::vector<SessionSegment> &WhisperSession::segments() const {
+    return segments_;
+}
+
+const std::vector<SessionToken> &WhisperSession::tokens() const {
+    return tokens_;
+}
+
+whisper_context *WhisperSession::context() const {
+    return ctx_;
+}
+
+int WhisperSession::segmentCount() const {
+    return state_ ? whisper_full_n_segments_from_state(state_) : whisper_full_n_segments(ctx_);
+}
+
+const char *WhisperSession::segmentText(int segment) const {
+    return state_ ? whisper_full_get_segment_text_from_state(state_, segment)
+                  : whisper_full_get_segment_text(ctx_, segment);
+}
+
+int64_t WhisperSession::segmentStart(int segment) const {
+    return state_ ? whisper_full_get_segment_t0_from_state(state_, segment)
+                  : whisper_full_get_segment_t0(ctx_, segment);
+}
+
+int64_t WhisperSession::segmentEnd(int segment) const {
+    return state_ ? whisper_full_get_segment_t1_from_state(state_, segment)
+                  : whisper_full_get_segment_t1(ctx_, segment);
+}
+
+int WhisperSession::tokenCount(int segment) const {
+    return state_ ? whisper_full_n_tokens_from_state(state_, segment) : whisper_full_n_tokens(ctx_, segment);
+}
+
+whisper_token_data WhisperSession::tokenData(int segment, int token) const {
+    return state_ ? whisper_full_get_token_data_from_state(state_, segment, token)
+                  : whisper_full_get_token_data(ctx_, segment, token);
+}
@@ -6,282 +6,613 @@
 #include <cstdio>
 #include <cstdlib>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <cmath>
 #include <algorithm>
-#include <mutex>
-#include <atomic>
-#include <cctype>
 #include <fstream>
-#include <sstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <csignal>
 
 // PortAudio
 #include "portaudio.h"
+#ifdef _WIN32
 #include "pa_win_wasapi.h"
+#endif
 
 // Whisper
 #include "whisper.h"
 
+#include "RingBuffer.hpp"
+#include "BoundedQueue.hpp"
+#include "ChunkAssembler.hpp"
+#include "StreamingTranscriber.hpp"
+#include "TranscriptStitcher.hpp"
+#include "TranscriptSink.hpp"
+#include "WhisperSession.hpp"
+#include "UtteranceSegmenter.hpp"
+#include "BatchTranscriber.hpp"
+#include "WavWriter.hpp"
+#include "TranscriptionStream.hpp"
+#include "InferenceScheduler.hpp"
+#include "ThreadScheduler.hpp"
+#include "AppConfig.hpp"
+#include "ModelManager.hpp"
+#include "OverloadController.hpp"
+#include "VirtualCaptureDevice.hpp"
+#include "AAudioDevice.hpp"
+#include "AudioCapture.hpp"
+#include "AudioSink.hpp"
+#include "Metrics.hpp"
+#include "MetricsReporter.hpp"
+#include "IpcServer.hpp"
+
 //TEST
 #include <filesystem>
 
 //---------------------------------------------------------------------------
-// 1) Save 16-bit mono WAV for debugging (unchanged)
-//--------------------------------------------------------------------------- 
-static bool save_wav_16bit(const std::string &filename,
-                           const float *samples,
-                           int numSamples,
-                           int sampleRate) {
-    //safe wav into debug folder
-    std::filesystem::path debugDir = "debug";
-    if (!std::filesystem::exists(debugDir)) {
-        std::filesystem::create_directory(debugDir);
-    }
-    std::filesystem::path filePath = debugDir / filename;
-    FILE* fp = nullptr;
-    errno_t err = fopen_s(&fp, filePath.string().c_str(), "wb");
-    if (err != 0 || !fp) {
-        char errMsg[256];
-        strerror_s(errMsg, sizeof(errMsg), err);
-        std::cerr << "Failed to open file for WAV: " << errMsg << std::endl;
-        return false;
-    }
-    uint32_t chunkSize      = 36 + (numSamples * 2);
-    uint16_t audioFormat    = 1;   // PCM
-    uint16_t numChannels    = 1;   // mono
-    uint32_t byteRate       = sampleRate * numChannels * 2;
-    uint16_t blockAlign     = numChannels * 2;
-    uint16_t bitsPerSample  = 16;
-    uint32_t dataSize       = numSamples * 2;
-
-    std::fwrite("RIFF", 1, 4, fp);
-    std::fwrite(&chunkSize, 4, 1, fp);
-    std::fwrite("WAVE", 1, 4, fp);
-    std::fwrite("fmt ", 1, 4, fp);
-    uint32_t subChunk1Size = 16;
-    std::fwrite(&subChunk1Size, 4, 1, fp);
-    std::fwrite(&audioFormat,   2, 1, fp);
-    std::fwrite(&numChannels,   2, 1, fp);
-    std::fwrite(&sampleRate,    4, 1, fp);
-    std::fwrite(&byteRate,      4, 1, fp);
-    std::fwrite(&blockAlign,    2, 1, fp);
-    std::fwrite(&bitsPerSample, 2, 1, fp);
-    std::fwrite("data", 1, 4, fp);
-    std::fwrite(&dataSize, 4, 1, fp);
-    for (int i = 0; i < numSamples; i++) {
-        float fval = samples[i];
-        if (fval < -1.0f) fval = -1.0f;
-        if (fval >  1.0f) fval =  1.0f;
-        int16_t sval = (int16_t)std::floor(fval * 32767.0f + 0.5f);
-        std::fwrite(&sval, sizeof(int16_t), 1, fp);
-    }
-    std::fclose(fp);
-    return true;
+// 1) AudioData Structure Using the Ring Buffer, and the Pipeline Hand-offs
+//---------------------------------------------------------------------------
+struct AudioData {
+    RingBuffer ringBuffer;
+    int channels;  // Set dynamically from selected device.
+    AudioData(size_t capacityFrames, int ch) : ringBuffer(capacityFrames, ch), channels(ch) {}
+};
+
+// The single-device loop runs as three stages on their own threads:
+// preprocessing (ring -> resampled, VAD-checked jobs), inference (Whisper
+// and stitching) and output (printing, the debug transcript file). Each
+// stage may run this many items ahead of the next.
+static const size_t kPipelineDepth = 4;
+// Longest a stage sleeps before re-checking for a stop request.
+static const std::chrono::milliseconds kStageWait(100);
+
+// Preprocessing -> inference: one fixed-mode window, one (possibly
+// coalesced) utterance or one streaming block.
+// Start of a stretch of continuous audio: a sample on some clock of its
+// own and its time on the stream clock.
+struct ClockMark {
+    uint64_t sample = 0;
+    double seconds = 0.0;
+};
+
+// Stream-clock time of `sample` on the clock described by `marks`, in
+// ascending order. An end sample that falls on a mark still belongs to the
+// stretch before it.
+static double clockSeconds(const std::vector<ClockMark> &marks, uint64_t sample, int rate, bool end = false) {
+    if (marks.empty())
+        return static_cast<double>(sample) / rate;
+    size_t i = marks.size() - 1;
+    while (i > 0 && (end ? marks[i].sample >= sample : marks[i].sample > sample))
+        i--;
+    return marks[i].seconds + (static_cast<double>(sample) - static_cast<double>(marks[i].sample)) / rate;
 }
 
+struct InferenceJob {
+    std::vector<float> audio;       // Mono at the Whisper rate.
+    size_t newSamples = 0;          // Not decoded before: the real-time budget.
+    double startSeconds = 0.0;      // Start of the audio since capture started (stream clock)...
+    double overlapSeconds = 0.0;    // ...and, fixed mode, how much the previous window covered.
+    bool discontinuous = false;     // Audio was skipped since the previous job.
+    std::vector<ClockMark> pieces;  // VAD mode: where each utterance starts in `audio`.
+    std::chrono::steady_clock::time_point captured;     // Capture of the last sample.
+    std::chrono::steady_clock::time_point queued;
+};
+
+// Part of a line's text and when it was spoken, in seconds on the stream
+// clock; published to the TranscriptSink.
+struct TimedSpan {
+    double start = 0.0;
+    double end = 0.0;
+    size_t offset = 0;              // Into TranscriptLine::text.
+    size_t length = 0;
+};
+
+// Inference -> output.
+struct TranscriptLine {
+    std::string text;               // Stitched or committed text; printed unless empty.
+    std::vector<TimedSpan> spans;   // Segments of `text` with their times.
+    std::string current;            // Debug: the window's own transcript.
+    std::string tentative;          // Debug: the streamer's uncommitted tail.
+    bool hasTentative = false;
+    size_t skipped = 0;             // Overlap tokens dropped by the stitcher.
+};
+
 //---------------------------------------------------------------------------
-// 2) Downmix + Resample from deviceSampleRate to 16 kHz (unchanged)
-//--------------------------------------------------------------------------- 
-static std::vector<float> downsample_mono_16k(const int16_t* inData,
-                                              size_t inFrames,
-                                              int inChannels,
-                                              double deviceSampleRate,
-                                              int whisperRate)
-{
-    float ratio = static_cast<float>(deviceSampleRate) / static_cast<float>(whisperRate);
-    size_t outFrames = static_cast<size_t>(std::floor(static_cast<float>(inFrames) / ratio));
-    std::vector<float> outData(outFrames);
-    for (size_t i = 0; i < outFrames; i++) {
-        float inPosF = i * ratio;
-        size_t inPos = static_cast<size_t>(std::floor(inPosF));
-        if (inPos >= inFrames) break;
-        float sampleMono = 0.0f;
-        if (inChannels == 1) {
-            sampleMono = static_cast<float>(inData[inPos]);
-        } else {
-            size_t sIdx = inPos * inChannels;
-            float left  = static_cast<float>(inData[sIdx]);
-            float right = static_cast<float>(inData[sIdx + 1]);
-            sampleMono  = 0.5f * (left + right);
+// 2) Capture Device Discovery (host-agnostic)
+//---------------------------------------------------------------------------
+// Host API to list devices from: the one named in the configuration, else
+// WASAPI on Windows (loopback support); PulseAudio (monitor sources for
+// loopback), JACK or ALSA on Linux. Returns paHostApiNotFound if the named
+// one does not exist.
+static PaHostApiIndex preferredHostApi(const std::string &name) {
+    if (!name.empty()) {
+        std::vector<std::string> names;
+        for (PaHostApiIndex i = 0; i < Pa_GetHostApiCount(); i++) {
+            const PaHostApiInfo* info = Pa_GetHostApiInfo(i);
+            names.push_back(info ? info->name : "");
         }
-        outData[i] = sampleMono / 32768.0f;
+        int index = AppConfig::match(name, names);
+        return index >= 0 ? static_cast<PaHostApiIndex>(index) : paHostApiNotFound;
+    }
+#if defined(_WIN32)
+    const PaHostApiTypeId preferred[] = {paWASAPI};
+#elif defined(__linux__)
+    const PaHostApiTypeId preferred[] = {paPulseAudio, paJACK, paALSA};
+#elif defined(__APPLE__)
+    const PaHostApiTypeId preferred[] = {paCoreAudio};
+#else
+    const PaHostApiTypeId preferred[] = {paInDevelopment};
+#endif
+    for (PaHostApiTypeId type : preferred) {
+        PaHostApiIndex index = Pa_HostApiTypeIdToHostApiIndex(type);
+        if (index >= 0)
+            return index;
     }
-    return outData;
+    return Pa_GetDefaultHostApi();
 }
 
-//---------------------------------------------------------------------------
-// 3) High-Performance Ring Buffer Implementation
-//--------------------------------------------------------------------------- 
-class RingBuffer {
-public:
-    RingBuffer(size_t capacity)
-        : buffer(capacity), capacity(capacity), head(0), tail(0), count(0) {}
-
-    // Push data into the ring buffer. Drops oldest data if necessary.
-    void push(const int16_t* data, size_t num) {
-        std::lock_guard<std::mutex> lock(mtx);
-        if (num > free_space()) {
-            size_t toDrop = num - free_space();
-            tail = (tail + toDrop) % capacity;
-            count -= toDrop;
-        }
-        for (size_t i = 0; i < num; i++) {
-            buffer[head] = data[i];
-            head = (head + 1) % capacity;
-        }
-        count += num;
-    }
+// Lists input and loopback devices of `hostApi` and returns their
+// PortAudio indices in display order.
+static std::vector<PaDeviceIndex> listCaptureDevices(PaHostApiIndex hostApi) {
+    std::vector<PaDeviceIndex> devices;
+    const PaHostApiInfo* hostInfo = Pa_GetHostApiInfo(hostApi);
+    if (!hostInfo)
+        return devices;
 
-    // Pop exactly num samples into out if available.
-    bool pop(size_t num, std::vector<int16_t>& out) {
-        std::lock_guard<std::mutex> lock(mtx);
-        if (count < num) return false;
-        out.resize(num);
-        for (size_t i = 0; i < num; i++) {
-            out[i] = buffer[tail];
-            tail = (tail + 1) % capacity;
-        }
-        count -= num;
-        return true;
+    std::cout << "Audio Api: " << hostInfo->name << std::endl;
+    std::cout << "--------------------------------------------------" << std::endl;
+    std::cout << "Devices (Input or Loopback):" << std::endl;
+    for (int i = 0; i < Pa_GetDeviceCount(); i++) {
+        const PaDeviceInfo* di = Pa_GetDeviceInfo(i);
+        if (!di || di->hostApi != hostApi) continue;
+        std::unique_ptr<AAudioDevice> device = AAudioDevice::createInstance(i);
+        bool isLoop = device && device->getDeviceType() == DeviceType::LoopBack;
+        if (di->maxInputChannels <= 0 && !isLoop) continue;
+        devices.push_back(i);
+        std::cout << "[" << devices.size() - 1 << "] " << di->name;
+        if (isLoop)
+            std::cout << " [Loopback]";
+        else
+            std::cout << " [Input]";
+        if (di->maxOutputChannels > 0)
+            std::cout << " [Output]";
+        if (hostInfo->defaultInputDevice == i || hostInfo->defaultOutputDevice == i)
+            std::cout << " (Default)";
+        std::cout << std::endl;
     }
+    return devices;
+}
 
-    size_t available() {
-        std::lock_guard<std::mutex> lock(mtx);
-        return count;
+// Resolves a configured device (list index or name) to a PortAudio index,
+// or paNoDevice.
+static PaDeviceIndex findCaptureDevice(const std::string &spec, const std::vector<PaDeviceIndex> &devices) {
+    std::vector<std::string> names;
+    for (PaDeviceIndex index : devices) {
+        const PaDeviceInfo* di = Pa_GetDeviceInfo(index);
+        names.push_back(di ? di->name : "");
     }
+    int choice = AppConfig::match(spec, names);
+    return choice >= 0 ? devices[choice] : paNoDevice;
+}
 
-private:
-    size_t free_space() const { return capacity - count; }
-    std::vector<int16_t> buffer;
-    size_t capacity;
-    size_t head;
-    size_t tail;
-    size_t count;
-    mutable std::mutex mtx;
-};
+// The host API's default input if it is in the list, else the first device.
+static PaDeviceIndex defaultCaptureDevice(PaHostApiIndex hostApi, const std::vector<PaDeviceIndex> &devices) {
+    const PaHostApiInfo* hostInfo = Pa_GetHostApiInfo(hostApi);
+    if (hostInfo && std::find(devices.begin(), devices.end(), hostInfo->defaultInputDevice) != devices.end())
+        return hostInfo->defaultInputDevice;
+    return devices.front();
+}
 
-//---------------------------------------------------------------------------
-// 4) AudioData Structure Using the Ring Buffer
-//---------------------------------------------------------------------------
-struct AudioData {
-    RingBuffer ringBuffer;
-    int channels;  // Set dynamically from selected device.
-    AudioData(size_t capacity, int ch) : ringBuffer(capacity), channels(ch) {}
-};
+static void stopCapture(AudioCapture* capture, VirtualCaptureDevice &virtualDevice) {
+    virtualDevice.stop();
+    if (capture)
+        capture->close();
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void logModelLoad(const std::string &path, const ModelLoadStats &stats) {
+    std::cerr << "[Startup] " << path << ": " << stats.bytes / (1024 * 1024) << " MB "
+              << (stats.mapped ? "mapped" : "read") << " in " << stats.mapMs << " ms, init "
+              << stats.initMs << " ms, warmup " << stats.warmupMs << " ms" << std::endl;
+}
 
 //---------------------------------------------------------------------------
-// 5) Asynchronous PortAudio Callback Function
+// 3) Shutdown on SIGINT / SIGTERM (no terminal input needed)
 //---------------------------------------------------------------------------
-static int audioCallback(const void *inputBuffer,
-                         void * /*outputBuffer*/,
-                         unsigned long framesPerBuffer,
-                         const PaStreamCallbackTimeInfo* /*timeInfo*/,
-                         PaStreamCallbackFlags /*statusFlags*/,
-                         void *userData) {
-    AudioData* audioData = reinterpret_cast<AudioData*>(userData);
-    if (!inputBuffer) return paContinue;
-    const int16_t* in = static_cast<const int16_t*>(inputBuffer);
-    size_t numSamples = framesPerBuffer * audioData->channels;
-    audioData->ringBuffer.push(in, numSamples);
-    return paContinue;
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void onStopSignal(int) {
+    stopRequested = 1;
 }
 
 //---------------------------------------------------------------------------
-// 6) Simple VAD function based on RMS energy
+// 4) Multi-Stream Server: several devices, one model, a shared worker pool
 //---------------------------------------------------------------------------
-bool simpleVAD(const std::vector<int16_t>& audio, int /*channels*/, int /*sampleRate*/, float threshold) {
-    if (audio.empty()) return false;
-    double sum = 0.0;
-    for (auto sample : audio) {
-        sum += std::abs(sample);
+// Devices captioned together: a TranscriptionStream (and whisper_state) per
+// device, decoded by one pool of workers.
+struct StreamGroup {
+    std::vector<std::unique_ptr<TranscriptionStream>> streams;
+    std::unique_ptr<InferenceScheduler> scheduler;
+};
+
+// Workers start from an even split of the cores; concurrent calls share
+// them and each stream adapts its count to its own load. One scheduler is
+// shared by every group of the process.
+static ThreadSchedulerConfig streamThreadConfig(const AppConfig &config) {
+    ThreadSchedulerConfig threadConfig = config.threads;
+    int cores = static_cast<int>(ThreadScheduler::allowedCores().size()) - (threadConfig.audioCore >= 0 ? 1 : 0);
+    threadConfig.initialThreads = std::max(1, cores / config.workers);
+    return threadConfig;
+}
+
+static bool openStreamGroup(whisper_context *wctx, const std::vector<PaDeviceIndex> &devices,
+                            const StreamConfig &streamConfig, const AppConfig &config, ThreadScheduler &threads,
+                            StreamGroup &group) {
+    // Each stream adds a whisper_state; the model weights stay shared.
+    std::vector<TranscriptionStream*> active;
+    for (size_t i = 0; i < devices.size(); i++) {
+        std::unique_ptr<TranscriptionStream> stream(new TranscriptionStream(static_cast<int>(i), wctx, streamConfig));
+        if (!stream->open(devices[i]))
+            return false;
+        active.push_back(stream.get());
+        group.streams.push_back(std::move(stream));
+    }
+
+    SchedulerConfig schedulerConfig;
+    schedulerConfig.workers = config.workers;
+    group.scheduler.reset(new InferenceScheduler(active, schedulerConfig, threads));
+    return true;
+}
+
+static bool startStreamGroup(StreamGroup &group, const TranscriptionStream::TextCallback &onText) {
+    for (const auto &stream : group.streams) {
+        if (!stream->start())
+            return false;
+    }
+    return group.scheduler->start(onText);
+}
+
+static void stopStreamGroup(StreamGroup &group) {
+    if (group.scheduler)
+        group.scheduler->stop();
+    for (const auto &stream : group.streams) {
+        stream->stop();
+    }
+}
+
+static StreamConfig makeStreamConfig(const AppConfig &config) {
+    StreamConfig streamConfig;
+    streamConfig.whisperRate     = config.whisperRate;
+    streamConfig.chunkMs         = config.chunkMs;
+    streamConfig.framesPerBuffer = config.framesPerBuffer;
+    streamConfig.vad             = config.vad;
+    return streamConfig;
+}
+
+static int runMultiStream(whisper_context *wctx,
+                          const std::vector<PaDeviceIndex> &devices,
+                          const AppConfig &config,
+                          TranscriptSink &sink,
+                          std::chrono::steady_clock::time_point processStart) {
+    ThreadScheduler threads(streamThreadConfig(config), std::cerr);
+    StreamGroup group;
+    if (!openStreamGroup(wctx, devices, makeStreamConfig(config), config, threads, group))
+        return 1;
+
+    std::mutex outputMutex;
+    bool firstText = true;
+    const bool printText = !sink.writesStdout();
+    auto onText = [&](const TranscriptionStream &stream, const StreamResult &result) {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        if (firstText) {
+            std::cerr << "[Startup] First transcript " << secondsSince(processStart) << " s after launch" << std::endl;
+            firstText = false;
+        }
+        for (const SessionSegment &segment : result.session->segments())
+            sink.publish(stream.id(), result.startSeconds + segment.t0 / 100.0,
+                         result.startSeconds + segment.t1 / 100.0, segment.text);
+        sink.flush();
+        if (printText)
+            std::cout << "[Transcription " << stream.id() << "] " << result.session->text() << std::endl;
+    };
+
+    if (!startStreamGroup(group, onText))
+        return 1;
+    for (const auto &stream : group.streams) {
+        std::cout << "Stream " << stream->id() << ": " << stream->name() << std::endl;
+    }
+    std::cout << "--------------------------------------------------" << std::endl;
+    std::cout << group.streams.size() << " streams, " << config.workers << " workers sharing "
+              << threads.usableCores() << " cores. Press Ctrl+C to stop..." << std::endl;
+    while (!stopRequested)
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    stopStreamGroup(group);
+
+    std::cout << "--------------------------------------------------" << std::endl;
+    std::cout << "Per-stream latency (end of speech -> text):" << std::endl;
+    for (const auto &stream : group.streams) {
+        StreamStats st = stream->stats();
+        std::cout << "[" << stream->id() << "] " << stream->name()
+                  << ": " << st.utterances << " utterances, " << st.audioSeconds << " s audio, "
+                  << st.inferenceSeconds << " s inference, latency mean " << st.latencyMeanMs
+                  << " ms, p50 " << st.latencyP50Ms << " ms, p95 " << st.latencyP95Ms
+                  << " ms, max " << st.latencyMaxMs << " ms, overruns " << st.overruns
+                  << ", decode failures " << st.decodeFailures << std::endl;
     }
-    double avg = sum / audio.size();
-    double normalized = avg / 32767.0;  // Normalize to [0,1]
-    return normalized > threshold;
+    return 0;
 }
 
 //---------------------------------------------------------------------------
-// 7) Deduplication Function: remove overlap between previous and current transcription
+// 5) IPC Server: sessions started and stopped by the desktop frontend
 //---------------------------------------------------------------------------
-std::string deduplicateTranscription(const std::string &prev, const std::string &curr) {
-    // Find the longest suffix of prev that matches a prefix of curr.
-    size_t maxOverlap = std::min(prev.size(), curr.size());
-    size_t overlap = 0;
-    // Require a minimum overlap length (e.g., 3 characters) for deduplication.
-    for (size_t len = maxOverlap; len >= 3; len--) {
-        if (prev.substr(prev.size() - len) == curr.substr(0, len)) {
-            overlap = len;
-            break;
+// Requests and replies (see IpcServer for the framing); `id` is echoed:
+//   {"type":"ping","id":1}                          -> {"type":"pong","id":1}
+//   {"type":"devices","id":2}                       -> {"type":"devices","id":2,"devices":[{"index":0,"name":"...","default":true},...]}
+//   {"type":"subscribe","id":3,"events":["partial","final"]}
+//                                                   -> {"type":"subscribed","id":3}
+//   {"type":"start","id":4,"devices":["0","Mic"],"partial_ms":1000}
+//                                                   -> {"type":"started","id":4,"session":1,"streams":[{"stream":0,"name":"..."},...]}
+//   {"type":"stop","id":5,"session":1}              -> {"type":"stopped","id":5,"session":1}
+// Failures answer {"type":"error","id":N,"message":"..."}. Events, to the
+// clients subscribed to their type:
+//   {"type":"partial"|"final","session":1,"stream":0,"start":1.25,"end":3.5,"text":"...",
+//    "captured_us":...,"ready_us":...}
+// start/end are seconds on the stream clock; captured_us (capture of the
+// last sample decoded) and ready_us (text ready) are steady_clock
+// microseconds, CLOCK_MONOTONIC on Linux, for latency measurements.
+static const int kDefaultPartialMs = 1000;
+
+static int64_t steadyMicros(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
+}
+
+static int runIpcServer(whisper_context *wctx,
+                        PaHostApiIndex hostApi,
+                        const std::vector<PaDeviceIndex> &captureDevices,
+                        const AppConfig &config,
+                        TranscriptSink &sink) {
+    IpcServerConfig serverConfig;
+    serverConfig.path = config.servePath;
+    IpcServer server(serverConfig);
+    // Declared before the sessions, which release their slots in it.
+    ThreadScheduler threads(streamThreadConfig(config), std::cerr);
+
+    std::mutex sessionMutex;
+    std::map<int, std::unique_ptr<StreamGroup>> sessions;
+    int nextSession = 1;
+
+    auto head = [](const char *type, const IpcRequest &request) {
+        std::string json = "{\"type\":\"";
+        json += type;
+        json += "\",\"id\":";
+        json += std::to_string(static_cast<long long>(request.number("id", 0)));
+        return json;
+    };
+    auto fail = [&](IpcServer::ClientId client, const IpcRequest &request, const std::string &message) {
+        std::string json = head("error", request);
+        json += ",\"message\":";
+        TranscriptSink::appendJsonString(json, message);
+        json += "}";
+        server.send(client, json);
+    };
+
+    auto onRequest = [&](IpcServer::ClientId client, const IpcRequest &request) {
+        const std::string type = request.get("type");
+        if (type == "ping") {
+            server.send(client, head("pong", request) + "}");
+        } else if (type == "devices") {
+            const PaHostApiInfo* hostInfo = Pa_GetHostApiInfo(hostApi);
+            std::string json = head("devices", request) + ",\"devices\":[";
+            for (size_t i = 0; i < captureDevices.size(); i++) {
+                const PaDeviceInfo* di = Pa_GetDeviceInfo(captureDevices[i]);
+                json += i ? ",{\"index\":" : "{\"index\":";
+                json += std::to_string(i);
+                json += ",\"name\":";
+                TranscriptSink::appendJsonString(json, di ? di->name : "");
+                json += ",\"default\":";
+                json += (hostInfo && hostInfo->defaultInputDevice == captureDevices[i]) ? "true}" : "false}";
+            }
+            server.send(client, json + "]}");
+        } else if (type == "subscribe") {
+            std::vector<std::string> topics;
+            if (const std::vector<std::string> *events = request.list("events"))
+                topics = *events;
+            else
+                topics.push_back("final");
+            for (const std::string &topic : topics) {
+                if (topic != "partial" && topic != "final")
+                    return fail(client, request, "unknown event type '" + topic + "'");
+            }
+            server.subscribe(client, topics);
+            server.send(client, head("subscribed", request) + "}");
+        } else if (type == "start") {
+            std::vector<PaDeviceIndex> devices;
+            if (const std::vector<std::string> *specs = request.list("devices")) {
+                for (const std::string &spec : *specs) {
+                    PaDeviceIndex device = findCaptureDevice(spec, captureDevices);
+                    if (device == paNoDevice)
+                        return fail(client, request, "device '" + spec + "' matches no single device");
+                    devices.push_back(device);
+                }
+            }
+            if (devices.empty())
+                devices.push_back(defaultCaptureDevice(hostApi, captureDevices));
+            StreamConfig streamConfig = makeStreamConfig(config);
+            streamConfig.partialMs = std::max(0, static_cast<int>(request.number("partial_ms", kDefaultPartialMs)));
+
+            std::lock_guard<std::mutex> lock(sessionMutex);
+            const int id = nextSession++;
+            std::unique_ptr<StreamGroup> group(new StreamGroup());
+            auto onText = [&server, &sink, id](const TranscriptionStream &stream, const StreamResult &result) {
+                const std::vector<SessionSegment> &segments = result.session->segments();
+                if (segments.empty())
+                    return;
+                std::string_view text = result.session->text();
+                while (!text.empty() && text.front() == ' ')
+                    text.remove_prefix(1);
+                char times[160];
+                std::snprintf(times, sizeof(times),
+                              "\"session\":%d,\"stream\":%d,\"start\":%.3f,\"end\":%.3f,\"captured_us\":%lld,"
+                              "\"ready_us\":%lld,\"text\":",
+                              id, stream.id(), result.startSeconds + segments.front().t0 / 100.0,
+                              result.startSeconds + segments.back().t1 / 100.0,
+                              static_cast<long long>(steadyMicros(result.captured)),
+                              static_cast<long long>(steadyMicros(std::chrono::steady_clock::now())));
+                std::string json = result.partial ? "{\"type\":\"partial\"," : "{\"type\":\"final\",";
+                json += times;
+                TranscriptSink::appendJsonString(json, text);
+                json += "}";
+                // A newer partial or the final text of the stream supersedes a queued partial.
+                server.publish(result.partial ? "partial" : "final",
+                               std::to_string(id) + ":" + std::to_string(stream.id()), result.partial, json);
+                if (result.partial)
+                    return;
+                for (const SessionSegment &segment : segments)
+                    sink.publish(stream.id(), result.startSeconds + segment.t0 / 100.0,
+                                 result.startSeconds + segment.t1 / 100.0, segment.text);
+                sink.flush();
+            };
+            if (!openStreamGroup(wctx, devices, streamConfig, config, threads, *group) ||
+                !startStreamGroup(*group, onText)) {
+                stopStreamGroup(*group);
+                return fail(client, request, "failed to open the capture devices");
+            }
+            std::string json = head("started", request) + ",\"session\":" + std::to_string(id) + ",\"streams\":[";
+            for (size_t i = 0; i < group->streams.size(); i++) {
+                json += i ? ",{\"stream\":" : "{\"stream\":";
+                json += std::to_string(group->streams[i]->id());
+                json += ",\"name\":";
+                TranscriptSink::appendJsonString(json, group->streams[i]->name());
+                json += "}";
+            }
+            sessions[id] = std::move(group);
+            std::cout << "Session " << id << " started (" << devices.size() << " device(s))" << std::endl;
+            server.send(client, json + "]}");
+        } else if (type == "stop") {
+            const int id = static_cast<int>(request.number("session", 0));
+            std::unique_ptr<StreamGroup> group;
+            {
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                auto it = sessions.find(id);
+                if (it != sessions.end()) {
+                    group = std::move(it->second);
+                    sessions.erase(it);
+                }
+            }
+            if (!group)
+                return fail(client, request, "no session " + std::to_string(id));
+            stopStreamGroup(*group);
+            std::cout << "Session " << id << " stopped" << std::endl;
+            server.send(client, head("stopped", request) + ",\"session\":" + std::to_string(id) + "}");
+        } else {
+            fail(client, request, type.empty() ? "malformed request" : "unknown request type '" + type + "'");
         }
+    };
+
+    if (!server.start(onRequest))
+        return 1;
+    std::cout << "Serving on " << config.servePath << ". Press Ctrl+C to stop..." << std::endl;
+    while (!stopRequested)
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Stop taking requests first, then the sessions they started.
+    server.stop();
+    for (auto &session : sessions) {
+        stopStreamGroup(*session.second);
     }
-    if (overlap > 0) {
-        return curr;
-    }
-    return curr.substr(overlap);
+    sessions.clear();
+    std::cerr << "[IPC] " << server.events() << " events in " << server.batches() << " writes, "
+              << server.replaced() << " partials superseded before delivery" << std::endl;
+    return 0;
 }
 
 //---------------------------------------------------------------------------
-// 8) Main Function: Dual Mode (Fixed vs. VAD) with Deduplication and Sliding Window Overlap
+// 6) Main Function: Dual Mode (Fixed vs. VAD) with Transcript Stitching and Sliding Window Overlap
 //---------------------------------------------------------------------------
 int main(int argc, char* argv[]) {
+    const auto processStart = std::chrono::steady_clock::now();
 #ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
 #endif
-    std::string arg = "";
-    std::string modelPath = "models/ggml-base.bin";
-    std::string mode = "fixed";
-    float vadThreshold = 0.6f;
-    float recordSeconds = 2.0f;
-    bool debug = false;
-    int framesPerBuffer = 256;
-    int chunkMs = 100;
-    int keepMs = 200;
-    int whisperRate = 16000;
-
     std::cout << std::endl << "+--------------------------+" << std::endl;
     std::cout << "|Audio Transcription Tool|" << std::endl;
     std::cout << "+--------------------------+" << std::endl;
-    for (int i = 1; i < argc; ++i) {
-        arg = argv[i];
-        if (arg == "-h" || arg == "--help") {
-            std::cout << "Usage: " << argv[0] << " [options]" << std::endl
-            << "Options:" << std::endl
-            << "  -h, --help           Show this help message" << std::endl
-            << "  -f, --fixed          Use fixed mode without VAD processing (default)" << std::endl
-            << "  -v, --vad            Enable Voice Activity Detection mode" << std::endl
-            << "  -m, --model <path>   Path to the Whisper model file" << std::endl
-            << "  -d, --debug          Enable debug mode (saves WAV files for each chunk)" << std::endl;
-            return 0;
-        }
-        if (arg == "-d" || arg == "--debug") {
-            debug = true;
-            std::cout << "Debug mode enabled: WAV files will be saved." << std::endl;
-        }
-        if (arg == "-f" || arg == "--fixed")
-            mode = "fixed";
-        if (arg == "-v" || arg == "--vad")
-            mode = "vad";
-        if (arg == "-m" || arg == "--model") {
-            i++;
-            if (i >= argc) {
-                std::cerr << "Error: No model path provided after -m/--model option." << std::endl;
-                return 1;
-            }
-            modelPath = argv[i];
-        }
+    AppConfig config;
+    if (!config.parse(argc, argv))
+        return 1;
+    if (config.help) {
+        AppConfig::printUsage(argv[0]);
+        return 0;
     }
-    std::cout << "Transcription mode: " << mode << std::endl;
-    std::cout << "Using Whisper model: " << modelPath << std::endl;
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+    if (config.debugSession)
+        std::cout << "Debug mode enabled: chunks will be appended to debug/session.wav." << std::endl;
+    else if (config.debug)
+        std::cout << "Debug mode enabled: WAV files will be saved." << std::endl;
+    if (!config.inputs.empty())
+        config.mode = "offline";
+    else if (!config.servePath.empty())
+        config.mode = "serve";
+    else if (config.devices.size() > 1)
+        config.mode = "multi-stream";
+    std::cout << "Transcription mode: " << config.mode << std::endl;
+    std::cout << "Using Whisper model: " << config.modelPath << std::endl;
 
     //check if model file exists
-    if (!std::filesystem::exists(modelPath)) {
-        std::cerr << "Error: Model file does not exist at " << modelPath << std::endl;
+    if (!std::filesystem::exists(config.modelPath)) {
+        std::cerr << "Error: Model file does not exist at " << config.modelPath << std::endl;
         return 1;
     }
 
+    // Load (and warm up) the models in the background while PortAudio
+    // enumerates devices and one is chosen; each mode waits with get().
+    whisper_context_params cparams = whisper_context_default_params();
+    ModelManager models;
+    models.preload(config.modelPath, cparams, config.warmup);
+    if (!config.fallbackModelPath.empty() && (config.mode == "fixed" || config.mode == "vad"))
+        models.preload(config.fallbackModelPath, cparams, config.warmup);
+
+    // Offline mode: no audio device, the files are read and decoded in parallel.
+    if (!config.inputs.empty()) {
+        struct whisper_context* wctx = models.get(config.modelPath, cparams, config.warmup);
+        if (!wctx) {
+            std::cerr << "Failed to init Whisper model" << std::endl;
+            return 1;
+        }
+        logModelLoad(config.modelPath, models.stats(config.modelPath));
+        // Split the cores between the parallel states.
+        int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        BatchConfig batchConfig;
+        batchConfig.jobs          = config.jobs;
+        batchConfig.threadsPerJob = config.threads.fixedThreads > 0 ? config.threads.fixedThreads
+                                                                  : std::max(1, cores / config.jobs);
+        batchConfig.whisperRate   = config.whisperRate;
+        batchConfig.segmenter.sampleRate = config.whisperRate;
+        batchConfig.vad           = config.vad;
+        BatchTranscriber batch(wctx, batchConfig);
+        bool ok = batch.run(config.inputs);
+        return ok ? 0 : 1;
+    }
+
+    // Timestamped transcript writers (--output); the plain "[Transcription]"
+    // lines stay on stdout unless one of them writes there.
+    TranscriptSink sink;
+    for (const std::string &spec : config.outputs) {
+        if (!sink.add(spec))
+            return 1;
+    }
+
     // Initialize PortAudio.
     PaError err = Pa_Initialize();
     if (err != paNoError) {
@@ -297,9 +628,7 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    const PaDeviceIndex defCapture = paNoDevice;
-    const PaDeviceIndex defLoopback = paNoDevice;
-    if (debug == true) {
+    if (config.debug == true) {
         std::cout << "Available Devices Across All Host APIs:" << std::endl;
         for (int i = 0; i < numDevices; i++) {
             const PaDeviceInfo* di = Pa_GetDeviceInfo(i);
@@ -320,257 +649,729 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    // Filter for WASAPI devices.
-    std::cout << "Audio Api: WASAPI" << std::endl;
-    std::cout << "--------------------------------------------------" << std::endl;
-    std::cout << "Devices (Input or Loopback):" << std::endl;
-    std::vector<PaDeviceIndex> wasapiInputDevices;
-    for (int i = 0; i < numDevices; i++) {
-        const PaDeviceInfo* di = Pa_GetDeviceInfo(i);
-        if (!di) continue;
-        const PaHostApiInfo* hai = Pa_GetHostApiInfo(di->hostApi);
-        if (!hai || hai->type != paWASAPI) continue;
-        bool hasInput = (di->maxInputChannels > 0);
-        int isLoop = PaWasapi_IsLoopback(i);
-        if (hasInput || (isLoop == 1)) {
-            wasapiInputDevices.push_back(i);
-            size_t idx = wasapiInputDevices.size() - 1;
-            std::cout << "[" << idx << "] " << di->name;
-            if (di->maxInputChannels > 0)
-                std::cout << " [Input]";
-            if (di->maxOutputChannels > 0)
-                std::cout << " [Output]";
-            if (hai->defaultInputDevice == i || hai->defaultOutputDevice == i)
-                std::cout << " (Default)";
-            std::cout << std::endl;
+    // Resolve the configured devices (or the default) without prompting.
+    std::vector<PaDeviceIndex> captureDevices;
+    std::vector<PaDeviceIndex> selected;
+    PaHostApiIndex hostApi = paHostApiNotFound;
+    if (config.virtualSource.empty()) {
+        hostApi = preferredHostApi(config.hostApi);
+        if (hostApi < 0) {
+            std::cerr << "Host API '" << config.hostApi << "' not found." << std::endl;
+            Pa_Terminate();
+            return 1;
+        }
+        captureDevices = listCaptureDevices(hostApi);
+        if (captureDevices.empty()) {
+            std::cerr << "No input/loopback devices found!" << std::endl;
+            Pa_Terminate();
+            return 1;
         }
+        for (const std::string &spec : config.devices) {
+            PaDeviceIndex device = findCaptureDevice(spec, captureDevices);
+            if (device == paNoDevice) {
+                std::cerr << "Device '" << spec << "' matches no single device in the list." << std::endl;
+                Pa_Terminate();
+                return 1;
+            }
+            selected.push_back(device);
+        }
+        if (selected.empty())
+            selected.push_back(defaultCaptureDevice(hostApi, captureDevices));
     }
-    if (wasapiInputDevices.empty()) {
-        std::cerr << "No WASAPI input/loopback devices found!" << std::endl;
+
+    // Frontend-driven: sessions pick their devices over IPC.
+    if (config.mode == "serve") {
+        if (captureDevices.empty()) {
+            std::cerr << "--serve captures from the listed devices; --virtual is not supported." << std::endl;
+            Pa_Terminate();
+            return 1;
+        }
+        struct whisper_context* wctx = models.get(config.modelPath, cparams, config.warmup);
+        if (!wctx) {
+            std::cerr << "Failed to init Whisper model" << std::endl;
+            Pa_Terminate();
+            return 1;
+        }
+        logModelLoad(config.modelPath, models.stats(config.modelPath));
+        int ret = runIpcServer(wctx, hostApi, captureDevices, config, sink);
+        std::cout << "Terminating... cleaning up resources." << std::endl;
         Pa_Terminate();
-        return 1;
+        return ret;
     }
 
-    // Let user pick a device.
-    bool selectionMade = false;
-    std::cout << std::endl << "Enter the index of the device you want or Press ENTER to stop..." << std::endl;
-    int userIndex = 0;
-    std::string line = "";
-    while (selectionMade == false) {
-        if (!std::getline(std::cin, line)) {      // EOF / stream error
-            std::cerr << "Input error - exiting..." << std::endl;
+    // Several devices: serve them all from one model.
+    if (selected.size() > 1) {
+        struct whisper_context* wctx = models.get(config.modelPath, cparams, config.warmup);
+        if (!wctx) {
+            std::cerr << "Failed to init Whisper model" << std::endl;
             Pa_Terminate();
             return 1;
         }
-        if (line.empty()) {
-            std::cout << "No selection made - exiting..." << std::endl;
+        logModelLoad(config.modelPath, models.stats(config.modelPath));
+        int ret = runMultiStream(wctx, selected, config, sink, processStart);
+        std::cout << "Terminating... cleaning up resources." << std::endl;
+        Pa_Terminate();
+        return ret;
+    }
+
+    // Capture format of the selected (or virtual) device.
+    VirtualCaptureDevice virtualDevice;
+    std::unique_ptr<AudioCapture> capture;
+    double deviceRate = 0.0;
+    int channels = 0;
+    std::string deviceName;
+    if (!config.virtualSource.empty()) {
+        VirtualDeviceConfig virtualConfig;
+        virtualConfig.source = config.virtualSource;
+        virtualConfig.framesPerBuffer = static_cast<unsigned long>(config.framesPerBuffer);
+        if (!virtualDevice.open(virtualConfig)) {
             Pa_Terminate();
-            return 0;
+            return 1;
         }
-        std::istringstream iss(line);
-        if (!(iss >> userIndex)) {                // text wasn’t a number
-            std::cerr << "That wasn’t a valid number - exiting..." << std::endl;
+        deviceRate = virtualDevice.sampleRate();
+        channels   = virtualDevice.channels();
+        deviceName = virtualDevice.name();
+    } else {
+        std::unique_ptr<AAudioDevice> device = AAudioDevice::createInstance(selected.front());
+        capture = AudioCapture::createInstance();
+        if (!device || !capture) {
+            std::cerr << "Audio capture is not supported on this platform." << std::endl;
             Pa_Terminate();
             return 1;
         }
-        if (userIndex > 0 && userIndex < static_cast<int>(wasapiInputDevices.size())) {
-            selectionMade = true;
-        } else {
-            std::cerr << "Invalid choice try again!" << std::endl;
+        // Negotiates channels and rate; the ring buffer below is sized from them.
+        capture->setFramesPerBuffer(static_cast<unsigned long>(config.framesPerBuffer));
+        if (!capture->open(device.get(), SampleFormat::Int16)) {
+            Pa_Terminate();
+            return 1;
         }
+        deviceRate = capture->getFormat().sampleRate;
+        channels   = capture->getFormat().channels;
+        deviceName = device->getDeviceInfo().name;
     }
 
-    PaDeviceIndex devIndex = wasapiInputDevices[userIndex];
-    const PaDeviceInfo* dInf = Pa_GetDeviceInfo(devIndex);
-    if (!dInf) {
-        std::cerr << "Failed to get device info!" << std::endl;
-        Pa_Terminate();
-        return 1;
-    }
-    bool inputCapable = (dInf->maxInputChannels > 0);
-    int isLoop = PaWasapi_IsLoopback(devIndex);
-    if (!inputCapable && (isLoop != 1)) {
-        std::cerr << "Selected device is neither input nor loopback." << std::endl;
-        Pa_Terminate();
-        return 1;
-    }
-
-    // Dynamic channel count.
-    int channels = dInf->maxInputChannels;
-
     // Calculate chunk sizes.
-    int chunkFrames  = static_cast<int>(dInf->defaultSampleRate * recordSeconds);
-    int chunkSamples = chunkFrames * channels;
-    int keepSamples  = static_cast<int>(dInf->defaultSampleRate * (keepMs / 1000.0f) * channels);
+    int chunkFrames  = static_cast<int>(deviceRate * config.recordSeconds);
+    int keepFrames   = static_cast<int>(deviceRate * (config.keepMs / 1000.0f));
 
-    // Preallocate ring buffer with capacity for 10 chunks.
-    size_t ringCapacity = static_cast<size_t>(chunkSamples * 10);
+    // Preallocate ring buffer with capacity for 10 chunks (rounded up to a power of two).
+    size_t ringCapacity = static_cast<size_t>(chunkFrames) * 10;
     AudioData audioData(ringCapacity, channels);
+    RingBufferSink captureSink(audioData.ringBuffer);
 
-    // Set up input stream parameters.
-    PaStreamParameters inParams{};
-    inParams.device = devIndex;
-    inParams.channelCount = channels;
-    inParams.sampleFormat = paInt16;
-    inParams.suggestedLatency = dInf->defaultHighInputLatency;
-    inParams.hostApiSpecificStreamInfo = nullptr;
-
-    // Open the stream in callback mode.
-    PaStream* stream = nullptr;
-    err = Pa_OpenStream(&stream,
-                        &inParams,
-                        nullptr, // no output
-                        dInf->defaultSampleRate,
-                        framesPerBuffer,
-                        paClipOff,
-                        audioCallback,
-                        &audioData);
-    if (err != paNoError) {
-        std::cerr << "Pa_OpenStream error: " << Pa_GetErrorText(err) << std::endl;
-        Pa_Terminate();
-        return 1;
+    // Chunk window (overlap + new audio at 16 kHz), allocated once up front.
+    // Streaming and VAD modes pull small chunkMs blocks without overlap
+    // instead; the rolling window / utterance lives in the next stage.
+    if (config.mode == "stream" || config.mode == "vad") {
+        chunkFrames = static_cast<int>(deviceRate * (config.chunkMs / 1000.0f));
+        keepFrames  = 0;
     }
-    err = Pa_StartStream(stream);
-    if (err != paNoError) {
-        std::cerr << "Pa_StartStream error: " << Pa_GetErrorText(err) << std::endl;
-        Pa_CloseStream(stream);
+    ChunkAssembler assembler(chunkFrames, keepFrames, channels, deviceRate, config.whisperRate);
+
+    // Wait for the preloaded model before any audio is accepted, so the
+    // first chunk never queues behind loading or warmup.
+    struct whisper_context* wctx = models.get(config.modelPath, cparams, config.warmup);
+    if (!wctx) {
+        std::cerr << "Failed to init Whisper model" << std::endl;
+        stopCapture(capture.get(), virtualDevice);
         Pa_Terminate();
         return 1;
     }
-    std::cout << "Selected device: " << dInf->name
-              << " at " << dInf->defaultSampleRate << " Hz, " << channels << " channels." << std::endl;;
+    ModelLoadStats modelStats = models.stats(config.modelPath);
+    logModelLoad(config.modelPath, modelStats);
+
+    // Real and virtual devices feed the same sink.
+    if (!config.virtualSource.empty()) {
+        virtualDevice.start(&captureSink);
+    } else {
+        capture->setSink(&captureSink);
+        if (!capture->start()) {
+            capture->close();
+            Pa_Terminate();
+            return 1;
+        }
+    }
+    std::cout << "Selected device: " << deviceName
+              << " at " << deviceRate << " Hz, " << channels << " channels." << std::endl;
+    const double startupSeconds = secondsSince(processStart);
+    std::cerr << "[Startup] Accepting audio " << startupSeconds << " s after launch" << std::endl;
     std::cout << "--------------------------------------------------" << std::endl;
-    // Initialize Whisper.
-    whisper_context_params cparams = whisper_context_default_params();
-    struct whisper_context* wctx = whisper_init_from_file_with_params(modelPath.c_str(), cparams);
-    if (!wctx) {
-        std::cerr << "Failed to init Whisper model" << std::endl;
-        Pa_StopStream(stream);
-        Pa_CloseStream(stream);
+
+    // Picks n_threads per call from the measured decode time against the
+    // audio time each call has to keep up with.
+    ThreadScheduler threadScheduler(config.threads, std::cerr);
+    size_t threadSlot = threadScheduler.addStream(config.mode);
+
+    StreamingConfig streamConfig;
+    streamConfig.sampleRate = config.whisperRate;
+    streamConfig.threads    = threadScheduler.preferredThreads(threadSlot);
+    StreamingTranscriber streamer(wctx, streamConfig);
+    if (config.mode == "stream" && !streamer.init()) {
+        stopCapture(capture.get(), virtualDevice);
         Pa_Terminate();
         return 1;
     }
 
-    // Overlap buffer to hold the last part of the previous chunk.
-    std::vector<int16_t> overlapBuffer = std::vector<int16_t>(keepSamples, 0);
+    // VAD-driven utterance segmentation; the utterance buffer is reused.
+    SegmenterConfig segmenterConfig;
+    segmenterConfig.sampleRate = config.whisperRate;
+    UtteranceSegmenter segmenter(segmenterConfig, config.vad);
+    Utterance utterance;
+    utterance.samples.reserve(static_cast<size_t>(segmenterConfig.maxUtteranceMs) * config.whisperRate / 1000);
+    Utterance nextUtterance;
 
-    int chunkCounter = 0;
-    std::string previousTranscript = "";
+    // Overload policy: what to give up, in order, when Whisper falls behind.
+    // The streamer builds its own decode parameters, so streaming mode only
+    // reports lost audio; VAD mode never decodes non-speech to begin with.
+    if (config.mode == "stream")
+        config.overload.order.clear();
+    OverloadController overload(config.overload, std::cerr);
+    if (config.mode != "fixed")
+        overload.disable(Degradation::SkipSilence);
+    struct whisper_context* fallbackCtx = nullptr;
+    if (!config.fallbackModelPath.empty() && config.mode != "stream") {
+        fallbackCtx = models.get(config.fallbackModelPath, cparams, config.warmup);
+        if (fallbackCtx)
+            logModelLoad(config.fallbackModelPath, models.stats(config.fallbackModelPath));
+        else
+            std::cerr << "Failed to load fallback model " << config.fallbackModelPath << "; continuing without it." << std::endl;
+    }
+    if (!fallbackCtx)
+        overload.disable(Degradation::SmallModel);
+    // Decode parameters and result buffers, set up once per model. They run
+    // on the contexts' own states, which the warmup has already exercised.
+    WhisperSessionConfig sessionConfig;
+    sessionConfig.language        = "en";
+    sessionConfig.tokenTimestamps = (config.mode == "fixed");   // for stitching
+    sessionConfig.collectTokens   = (config.mode == "fixed");
+    WhisperSession mainSession(wctx, nullptr, sessionConfig);
+    std::unique_ptr<WhisperSession> fallbackSession;
+    if (fallbackCtx)
+        fallbackSession.reset(new WhisperSession(fallbackCtx, nullptr, sessionConfig));
+    // Fixed mode: speech check of each chunk's new audio for SkipSilence.
+    VoiceActivityDetector chunkVad(config.vad);
+    std::vector<VadFrame> chunkVadFrames;
+    std::vector<SpeechSegment> chunkVadSegments;
+    // Fixed mode under Coalesce: overlap plus every chunk of the backlog.
+    std::vector<float> coalesced;
+    const size_t maxCoalesced = static_cast<size_t>(30 * config.whisperRate);  // Whisper's window
 
-    // Termination flag and input thread.
-    std::atomic<bool> running(true);
-    std::thread inputThread([&running]() {
-        std::cout << "Press ENTER to stop..." << std::endl;
-        std::cin.ignore(); // clear leftover newline
-        std::cin.get();
-        running = false;
-    });
+    // Debug WAVs are written on a background thread so disk I/O never delays inference.
+    WavWriterConfig writerConfig;
+    writerConfig.sampleRate = config.whisperRate;
+    if (config.debugSession) {
+        writerConfig.mode   = WavWriterMode::Session;
+        writerConfig.prefix = "session";
+    }
+    WavWriter debugWriter(writerConfig);
+    if (config.debug == true && !debugWriter.start())
+        std::cerr << "Failed to start debug WAV writer; continuing without it." << std::endl;
 
-    std::cout << "Audio callback running asynchronously. Processing chunks..." << std::endl;
+    // Per-stage instrumentation. Hot paths hold references; the reporter
+    // thread renders the registry as a JSON line and on /metrics.
+    using Clock = std::chrono::steady_clock;
+    MetricsRegistry metrics;
+    Histogram& waitHist     = metrics.histogram("ring_wait", "Time the preprocessing stage waited for the next chunk");
+    Histogram& resampleHist = metrics.histogram("resample", "Ring read, downmix and resampling of one chunk");
+    Histogram& vadHist      = metrics.histogram("vad", "VAD and utterance segmentation of one chunk");
+    Histogram& queueHist    = metrics.histogram("job_queue", "Time a job waited between preprocessing and inference");
+    Histogram& whisperHist  = metrics.histogram("whisper", "whisper_full per chunk, utterance or streaming step");
+    Histogram& latencyHist  = metrics.histogram("end_to_end", "Capture of the last decoded sample to transcript");
+    Gauge& ringFill         = metrics.gauge("ring_fill", "Ring buffer fill level, 0 to 1");
+    Gauge& realTimeFactor   = metrics.gauge("real_time_factor", "Whisper time over transcribed audio time");
+    Gauge& whisperThreads   = metrics.gauge("whisper_threads", "n_threads of the latest Whisper call");
+    Gauge& overloadLevel    = metrics.gauge("overload_level", "Overload degradation steps enabled");
+    Gauge& decodeRatio      = metrics.gauge("stream_decode_ratio", "Streaming: audio decoded over audio pushed");
+    Gauge& startupTime      = metrics.gauge("startup_seconds", "Launch to audio accepted, model load included");
+    Gauge& firstTranscript  = metrics.gauge("time_to_first_transcript_seconds", "Launch to the first transcript");
+    Gauge& modelLoadTime    = metrics.gauge("model_load_seconds", "Mapping and initializing the Whisper model");
+    Gauge& modelWarmupTime  = metrics.gauge("model_warmup_seconds", "Warmup inference before audio is accepted");
+    Counter& droppedSpans   = metrics.counter("dropped_spans", "Spans of audio not transcribed (overruns, skipped non-speech)");
+    Counter& ringOverruns   = metrics.counter("ring_overruns", "Ring buffer overflow events");
+    Counter& ringDropped    = metrics.counter("ring_dropped_frames", "Frames lost to ring buffer overflows");
+    Counter& captureOverflow = metrics.counter("capture_overflows", "Input overflows reported by the host API");
+    Counter& transcripts    = metrics.counter("transcripts", "Transcripts produced");
+    Counter& decodeFailures = metrics.counter("decode_failures", "Whisper calls that failed, left out of the load metrics");
+    startupTime.set(startupSeconds);
+    modelLoadTime.set((modelStats.mapMs + modelStats.initMs) / 1000.0);
+    modelWarmupTime.set(modelStats.warmupMs / 1000.0);
+    MetricsReporter reporter(metrics, config.metrics, std::cerr);
+    if (!reporter.start())
+        std::cerr << "Failed to start metrics reporter; continuing without it." << std::endl;
+
+    double audioSeconds = 0.0;      // Transcribed so far, for the real-time factor.
+    double whisperSeconds = 0.0;
+    uint64_t segmentedSamples = 0;  // Pushed to the segmenter (VAD mode).
+    size_t streamedSamples = 0;     // Pushed to the streamer since its last step.
+    uint64_t streamerSamples = 0;   // Pushed to the streamer in total, its own clock...
+    double streamerOffset = 0.0;    // ...and where it started on the stream clock (moves with gaps).
+    bool ringGap = false;           // assembleChunk() met overwritten audio not yet handled.
+    std::vector<ClockMark> segmenterClock;  // Segmenter clock -> stream clock (VAD mode).
+    Clock::time_point waitStart = Clock::now();
+    Clock::time_point chunkCaptured = waitStart;    // When the newest chunk's last frame was captured.
 
-    // Main processing loop.
-    while (running) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        
-        // Determine how many new samples we need to create a full chunk with overlap.
-        size_t requiredNewSamples = chunkSamples > overlapBuffer.size() ? chunkSamples - overlapBuffer.size() : 0;
-        std::vector<int16_t> newData;
-        if (requiredNewSamples > 0) {
-            if (!audioData.ringBuffer.pop(requiredNewSamples, newData))
-                continue;  // not enough new data yet
+    // The stages hand over preallocated jobs and lines; see BoundedQueue.
+    BoundedQueue<InferenceJob> jobs(kPipelineDepth);
+    BoundedQueue<TranscriptLine> lines(kPipelineDepth);
+
+    // Pulls the next chunk out of the ring and records the wait and resample
+    // time plus the ring health counters. Sets ringGap if audio before the
+    // chunk was overwritten.
+    auto assembleChunk = [&]() -> bool {
+        Clock::time_point t0 = Clock::now();
+        if (!assembler.assemble(audioData.ringBuffer))
+            return false;
+        Clock::time_point t1 = Clock::now();
+        resampleHist.record(t1 - t0);
+        waitHist.record(t0 - waitStart);
+        waitStart = t1;
+        size_t backlog = audioData.ringBuffer.available();
+        chunkCaptured = t1 - std::chrono::duration_cast<Clock::duration>(
+                                 std::chrono::duration<double>(backlog / deviceRate));
+        ringFill.set(static_cast<double>(backlog) / static_cast<double>(audioData.ringBuffer.capacity()));
+        ringOverruns.set(audioData.ringBuffer.overruns());
+        ringDropped.set(audioData.ringBuffer.droppedFrames());
+        captureOverflow.set(captureSink.overflows());
+        uint64_t gapStart = 0, gapEnd = 0;
+        if (assembler.takeGap(gapStart, gapEnd)) {
+            overload.drop(gapStart / deviceRate, gapEnd / deviceRate, "ring overrun");
+            ringGap = true;
+        }
+        return true;
+    };
+    // Sleeps until the capture side has pushed a chunk's worth of new frames;
+    // the callback wakes this thread once per chunk, not once per period.
+    const size_t chunkNewFrames = static_cast<size_t>(chunkFrames - keepFrames);
+    auto waitForAudio = [&]() {
+        audioData.ringBuffer.waitFor(chunkNewFrames, kStageWait);
+    };
+    // Accounts one successful Whisper run with `threads` threads over
+    // `samples` samples, `newSamples` of them not decoded before, whose last
+    // one was captured at `captured`.
+    auto recordDecode = [&](Clock::time_point t0, size_t samples, Clock::time_point captured,
+                            int threads, size_t newSamples) {
+        Clock::time_point t1 = Clock::now();
+        double elapsed = std::chrono::duration<double>(t1 - t0).count();
+        double budget = static_cast<double>(newSamples) / config.whisperRate;
+        // Audio waiting for inference sits in the ring or, converted, in the job queue.
+        double backlog = std::max(static_cast<double>(audioData.ringBuffer.available()) /
+                                      static_cast<double>(audioData.ringBuffer.capacity()),
+                                  static_cast<double>(jobs.size()) / static_cast<double>(jobs.capacity()));
+        threadScheduler.end(threadSlot, threads, elapsed, budget);
+        whisperThreads.set(threads);
+        overload.update(elapsed, budget, backlog);
+        overload.flush();   // transcription resumed: report what was dropped before it
+        overloadLevel.set(overload.level());
+        droppedSpans.set(overload.droppedSpans());
+        whisperHist.record(t1 - t0);
+        latencyHist.record(t1 - captured);
+        whisperSeconds += elapsed;
+        audioSeconds += static_cast<double>(samples) / config.whisperRate;
+        if (audioSeconds > 0.0)
+            realTimeFactor.set(whisperSeconds / audioSeconds);
+        if (transcripts.value() == 0) {
+            double first = secondsSince(processStart);
+            firstTranscript.set(first);
+            std::cerr << "[Startup] First transcript " << first << " s after launch" << std::endl;
+        }
+        transcripts.add();
+    };
+    // A failed run only releases its threads: its time says nothing about
+    // the load, so neither the thread scheduler nor the overload controller
+    // sees it.
+    auto recordFailure = [&](int threads) {
+        threadScheduler.end(threadSlot, threads, 0.0, 0.0);
+        decodeFailures.add();
+    };
+
+    // Runs the current chunk through the segmenter (VAD mode). No utterance
+    // spans a gap: the open one is closed and the segmenter clock starts a
+    // new stretch at the chunk that follows it.
+    auto segmentChunk = [&]() {
+        if (ringGap || segmenterClock.empty()) {
+            if (ringGap)
+                segmenter.flush();
+            ringGap = false;
+            ClockMark mark;
+            mark.sample = segmentedSamples;
+            mark.seconds = assembler.position() / deviceRate - static_cast<double>(assembler.size()) / config.whisperRate;
+            segmenterClock.push_back(mark);
+        }
+        {
+            ScopedTimer timer(vadHist);
+            segmenter.push(assembler.data(), assembler.size());
+        }
+        segmentedSamples += assembler.size();
+        assembler.advance();
+    };
+    // Whether the new audio of the current chunk contains speech (fixed mode).
+    auto chunkHasSpeech = [&]() -> bool {
+        ScopedTimer timer(vadHist);
+        chunkVadFrames.clear();
+        chunkVadSegments.clear();
+        size_t overlap = assembler.overlapSize();
+        chunkVad.process(assembler.data() + overlap, assembler.size() - overlap, chunkVadFrames, chunkVadSegments);
+        if (chunkVad.inSpeech() || !chunkVadSegments.empty())
+            return true;
+        for (const VadFrame &frame : chunkVadFrames) {
+            if (frame.speech)
+                return true;
         }
-        
-        // Build the full chunk: previous overlap + new data.
-        std::vector<int16_t> fullChunk;
-        fullChunk.reserve(overlapBuffer.size() + newData.size());
-        fullChunk.insert(fullChunk.end(), overlapBuffer.begin(), overlapBuffer.end());
-        fullChunk.insert(fullChunk.end(), newData.begin(), newData.end());
-        if (fullChunk.size() < static_cast<size_t>(chunkSamples))
-            continue;  // safety check
-
-        // For VAD mode: check if there's speech in this chunk.
-        if (mode == "vad") {
-            if (!simpleVAD(fullChunk, channels, static_cast<int>(dInf->defaultSampleRate), vadThreshold)) {
-                // No speech detected – update overlap buffer and wait.
-                if (fullChunk.size() >= static_cast<size_t>(keepSamples)) {
-                    overlapBuffer.assign(fullChunk.end() - keepSamples, fullChunk.end());
+        return false;
+    };
+
+    // A file-backed virtual device ends by itself; otherwise run until
+    // SIGINT/SIGTERM.
+    bool playsFile = !config.virtualSource.empty() && config.virtualSource != "null";
+    if (!playsFile)
+        std::cout << "Press Ctrl+C to stop..." << std::endl;
+
+    // Stage 1, preprocessing: resampling, VAD and the overload decisions
+    // that need no decoder. It prepares the next job while Whisper decodes
+    // the previous one and blocks only on the ring (no new audio) or on a
+    // full job queue (Whisper is kPipelineDepth jobs behind).
+    auto preprocess = [&]() {
+        InferenceJob job;
+        bool discontinuous = false;     // Audio skipped since the last job.
+        bool held = false;              // The assembler holds a chunk, after a gap, for the next job.
+        while (!stopRequested) {
+            if (playsFile && virtualDevice.finished() && !held && audioData.ringBuffer.available() < chunkNewFrames)
+                break;  // file (and its silence tail) fully processed
+
+            // VAD mode: dispatch whole utterances instead of fixed windows.
+            const float* audio = assembler.data();
+            size_t audioSize = 0;
+            uint64_t utteranceEnd = 0;
+            double windowEnd = 0.0;         // Stream time after the window (fixed and stream mode).
+            if (config.mode == "vad") {
+                if (segmenter.pending() == 0) {
+                    if (!assembleChunk()) {
+                        waitForAudio();
+                        continue;  // not enough new data yet
+                    }
+                    segmentChunk();
                 }
-                continue;
+                if (!segmenter.pop(utterance))
+                    continue;  // utterance still open
+                utteranceEnd = utterance.start + utterance.samples.size();
+                // Marks before the one this utterance starts in are not needed again.
+                while (segmenterClock.size() > 1 && segmenterClock[1].sample <= utterance.start)
+                    segmenterClock.erase(segmenterClock.begin());
+                job.pieces.clear();
+                ClockMark piece;
+                piece.seconds = clockSeconds(segmenterClock, utterance.start, config.whisperRate);
+                job.pieces.push_back(piece);
+                if (overload.active(Degradation::Coalesce)) {
+                    // Segment the whole backlog and decode the finished utterances
+                    // in one call, as long as any further utterance still fits.
+                    // The silence between them is left out; each one's start is
+                    // kept in job.pieces to time its segments.
+                    while (assembleChunk())
+                        segmentChunk();
+                    size_t longest = static_cast<size_t>(segmenterConfig.maxUtteranceMs + segmenterConfig.paddingMs) *
+                                     config.whisperRate / 1000;
+                    while (utterance.samples.size() + longest <= maxCoalesced && segmenter.pop(nextUtterance)) {
+                        piece.sample = utterance.samples.size();
+                        piece.seconds = clockSeconds(segmenterClock, nextUtterance.start, config.whisperRate);
+                        job.pieces.push_back(piece);
+                        utterance.samples.insert(utterance.samples.end(), nextUtterance.samples.begin(),
+                                                 nextUtterance.samples.end());
+                        utteranceEnd = nextUtterance.start + nextUtterance.samples.size();
+                    }
+                }
+                audio = utterance.samples.data();
+                audioSize = utterance.samples.size();
+            } else {
+                // Convert the audio that follows the overlap straight out of the ring.
+                if (!held && !assembleChunk()) {
+                    waitForAudio();
+                    continue;  // not enough new data yet
+                }
+                held = false;
+                if (ringGap) {
+                    // Nothing may be aligned or streamed across the lost audio.
+                    discontinuous = true;
+                    ringGap = false;
+                }
+                audioSize = assembler.size();
+                windowEnd = assembler.position() / deviceRate;
+                if (config.mode == "fixed") {
+                    if (!chunkHasSpeech() && overload.active(Degradation::SkipSilence)) {
+                        double end = windowEnd;
+                        overload.drop(end - (chunkFrames - keepFrames) / deviceRate, end, "no speech");
+                        discontinuous = true;
+                        assembler.advance();
+                        continue;
+                    }
+                    if (overload.active(Degradation::Coalesce)) {
+                        // One window over the whole backlog instead of one per chunk.
+                        coalesced.assign(assembler.data(), assembler.data() + assembler.size());
+                        size_t chunkSamples = assembler.size() - assembler.overlapSize();
+                        while (coalesced.size() + chunkSamples <= maxCoalesced) {
+                            assembler.advance();
+                            if (!assembleChunk())
+                                break;
+                            if (ringGap) {
+                                // The window ends at the gap; the chunk after it
+                                // starts the next one.
+                                held = true;
+                                break;
+                            }
+                            chunkHasSpeech();   // keeps the detector's noise floor current
+                            coalesced.insert(coalesced.end(), assembler.data() + assembler.overlapSize(),
+                                             assembler.data() + assembler.size());
+                            windowEnd = assembler.position() / deviceRate;
+                        }
+                        audio = coalesced.data();
+                        audioSize = coalesced.size();
+                    }
+                }
+            }
+
+            // Capture time of the last sample handed to Whisper. An utterance
+            // ends before the newest chunk by however much was segmented since.
+            job.captured = chunkCaptured;
+            if (config.mode == "vad") {
+                double behind = static_cast<double>(segmentedSamples - std::min(segmentedSamples, utteranceEnd)) / config.whisperRate;
+                job.captured -= std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(behind));
+            }
+            job.audio.assign(audio, audio + audioSize);
+            // A fixed chunk has to finish before the next one's new audio is in;
+            // an utterance before the next utterance can end.
+            job.newSamples = (config.mode == "fixed") ? audioSize - std::min(audioSize, assembler.overlapSize()) : audioSize;
+            if (config.mode == "vad")
+                job.startSeconds = job.pieces.front().seconds;
+            else
+                job.startSeconds = windowEnd - static_cast<double>(audioSize) / config.whisperRate;
+            job.overlapSeconds = static_cast<double>(assembler.overlapSize()) / config.whisperRate;
+            job.discontinuous = discontinuous;
+            discontinuous = false;
+            // Keep the tail of this chunk as overlap for the next one.
+            if (config.mode != "vad" && !held)
+                assembler.advance();
+
+            if (config.mode != "stream" && debugWriter.running()) {
+                if (debugWriter.write(job.audio.data(), job.audio.size()))
+                    std::cout << "[Debug] Queued chunk for WAV (" << job.audio.size() << " samples)" << std::endl;
+                else
+                    std::cerr << "[Debug] WAV writer busy, chunk not saved" << std::endl;
             }
+            job.queued = Clock::now();
+            while (!jobs.push(job, kStageWait) && !stopRequested) {}
         }
-        
-        // Downmix & resample the full chunk.
-        std::vector<float> mono16k = downsample_mono_16k(
-            fullChunk.data(),
-            fullChunk.size() / channels,
-            channels,
-            dInf->defaultSampleRate,
-            whisperRate
-        );
-
-        
-        if (debug == true) {
-            std::string fname = "chunk_" + std::to_string(chunkCounter++) + ".wav";
-            if (!save_wav_16bit(fname, mono16k.data(), static_cast<int>(mono16k.size()), whisperRate)) {
-                std::cerr << "Failed to save WAV: " << fname << std::endl;
+        jobs.close();
+    };
+
+    // Stage 3, output: printing, the transcript writers and the debug
+    // transcript file stay off the inference thread. Lines end in '\n' and
+    // stdout and the writers are flushed once the queue is drained, not
+    // after every line.
+    const bool printText = !sink.writesStdout();
+    auto output = [&]() {
+        TranscriptLine line;
+        // Debug: the stitched transcript, created once and appended to.
+        std::ofstream debugText;
+        if (config.debug == true && config.mode != "stream") {
+            debugText.open("transcription.txt", std::ios::out | std::ios::trunc);
+            if (!debugText.is_open())
+                std::cerr << "Failed to open transcription.txt for writing." << std::endl;
+        }
+        for (;;) {
+            if (!lines.pop(line, kStageWait)) {
+                if (lines.closed() && lines.size() == 0)
+                    break;
+                continue;
+            }
+            std::string_view text = line.text;
+            for (const TimedSpan &span : line.spans)
+                sink.publish(-1, span.start, span.end, text.substr(span.offset, span.length));
+            if (config.mode == "stream") {
+                if (printText && !line.text.empty())
+                    std::cout << "[Transcription] " << line.text << '\n';
+                if (config.debug == true && line.hasTentative)
+                    std::cout << "[Debug] Tentative: " << line.tentative << '\n';
             } else {
-                std::cout << "[Debug] Wrote " << fname << " (" << mono16k.size() << " samples)";
+                if (config.debug == true) {
+                    std::cout << "[Debug] Current: " << line.current << '\n';
+                    std::cout << "[Debug] Stitched: " << line.text << " (" << line.skipped << " overlap tokens skipped)\n";
+                    if (debugText.is_open() && !line.text.empty())
+                        debugText << line.text << '\n';
+                }
+                if (printText && !line.text.empty())
+                    std::cout << "[Transcription] " << line.text << '\n';
+            }
+            if (lines.size() == 0) {
+                std::cout.flush();
+                sink.flush();
+                debugText.flush();
             }
         }
+        std::cout.flush();
+        sink.flush();
+    };
+    // Hands a line to the output stage, which never stops draining.
+    TranscriptLine line;
+    auto addSpan = [&](double start, double end, size_t offset, size_t length) {
+        TimedSpan span;
+        span.start = start;
+        span.end = end;
+        span.offset = offset;
+        span.length = length;
+        line.spans.push_back(span);
+    };
+    auto emit = [&]() {
+        while (!lines.push(line, kStageWait)) {}
+        line.text.clear();
+        line.spans.clear();
+        line.current.clear();
+        line.tentative.clear();
+        line.hasTentative = false;
+        line.skipped = 0;
+    };
+
+    // Started before this thread is pinned so they do not inherit its CPUs.
+    std::thread preprocessThread(preprocess);
+    std::thread outputThread(output);
+
+    // Stage 2, inference: Whisper runs on this thread (and the ggml threads
+    // it spawns).
+    threadScheduler.pinCurrentThread();
+
+    std::cout << "Audio callback running asynchronously. Processing chunks..." << std::endl;
+
+    // Streaming mode: decodes and commits the rest of the window.
+    auto flushStreamer = [&]() {
+        uint64_t committedFrom = streamer.windowStart();
+        if (!streamer.flush(line.text)) {
+            line.text.clear();
+            return;
+        }
+        addSpan(streamerOffset + static_cast<double>(committedFrom) / config.whisperRate,
+                streamerOffset + static_cast<double>(streamerSamples) / config.whisperRate, 0, line.text.size());
+        emit();
+    };
+
+    // Fixed mode: joins overlapping windows on their tokens; the text
+    // buffers are reused chunk to chunk.
+    TranscriptStitcher stitcher;
+    InferenceJob job;
+    // Runs until the preprocessing stage has closed the queue and every
+    // job it queued is decoded.
+    for (;;) {
+        if (!jobs.pop(job, kStageWait)) {
+            if (jobs.closed() && jobs.size() == 0)
+                break;
+            continue;
+        }
+        queueHist.record(Clock::now() - job.queued);
+        const float* audio = job.audio.data();
+        size_t audioSize = job.audio.size();
+
+        // Streaming mode: feed the rolling window and print committed text only.
+        if (config.mode == "stream") {
+            // The window before a gap is committed as it is; the audio after
+            // it starts a new one.
+            if (job.discontinuous)
+                flushStreamer();
+            streamerOffset = job.startSeconds - static_cast<double>(streamerSamples) / config.whisperRate;
+            streamer.push(audio, audioSize);
+            streamedSamples += audioSize;
+            streamerSamples += audioSize;
+            if (!streamer.ready())
+                continue;
+            int threads = threadScheduler.begin(threadSlot);
+            streamer.setThreads(threads);
+            uint64_t committedFrom = streamer.windowStart();
+            Clock::time_point t0 = Clock::now();
+            if (!streamer.step(line.text)) {
+                recordFailure(threads);
+                line.text.clear();
+                continue;
+            }
+            recordDecode(t0, streamedSamples, job.captured, threads, streamedSamples);
+            decodeRatio.set(streamer.decodeRatio());
+            streamedSamples = 0;
+            // Committing cuts the committed audio off the window.
+            addSpan(streamerOffset + static_cast<double>(committedFrom) / config.whisperRate,
+                    streamerOffset + static_cast<double>(streamer.windowStart()) / config.whisperRate,
+                    0, line.text.size());
+            line.tentative = streamer.tentative();
+            line.hasTentative = true;
+            emit();
+            continue;
+        }
+
         // Transcribe with Whisper.
-        whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
-        wparams.print_progress   = false;
-        wparams.print_special    = false;
-        wparams.print_realtime   = false;
-        wparams.print_timestamps = false;
-        wparams.translate        = false; 
-        wparams.language         = "en";
-        wparams.n_threads        = std::min(4, static_cast<int>(std::thread::hardware_concurrency()));
-
-        int ret = whisper_full(wctx, wparams, mono16k.data(), static_cast<int>(mono16k.size()));
-        if (ret != 0) {
+        WhisperSession& session = overload.active(Degradation::SmallModel) ? *fallbackSession : mainSession;
+        whisper_full_params& wparams = session.prepare(threadScheduler.begin(threadSlot));
+        overload.tune(wparams, audioSize, config.whisperRate);
+
+        Clock::time_point decodeStart = Clock::now();
+        if (!session.decode(audio, audioSize)) {
+            recordFailure(wparams.n_threads);
             std::cerr << "whisper_full() failed!" << std::endl;
-        } else {
-            std::string currentTranscript = "";
-            int n_segments = whisper_full_n_segments(wctx);
-            for (int i = 0; i < n_segments; i++) {
-                const char* text = whisper_full_get_segment_text(wctx, i);
-                if (text)
-                    currentTranscript += text;
-            }
+            continue;
+        }
+        recordDecode(decodeStart, audioSize, job.captured, wparams.n_threads, job.newSamples);
+        // Copied into the line's recycled buffers: the session's views only
+        // last until its next decode, and the output stage runs behind it.
+        if (config.debug == true)
+            line.current.assign(session.text());
 
-            // Deduplicate with the previous transcript.
-            std::string deduped = deduplicateTranscription(previousTranscript, currentTranscript);
-            if (debug == true) {
-                std::cout << "[Debug] Previous: " << previousTranscript << std::endl;
-                std::cout << "[Debug] Current: " << currentTranscript << std::endl;
-                std::cout << "[Debug] Deduped: " << deduped << std::endl;
-                // Save the deduplicated transcription to a file.
-                // This will overwrite the file each time.
-                std::ofstream outFile("transcription.txt", std::ios::out | std::ios::trunc);
-                if (outFile.is_open()) {
-                    outFile << deduped << std::endl;
-                } else {
-                    std::cerr << "Failed to open transcription.txt for writing." << std::endl;
-                }
+        // Stitch onto the previous window (utterances do not overlap).
+        if (config.mode == "fixed") {
+            if (job.discontinuous)
+                stitcher.reset();
+            stitcher.beginWindow(job.startSeconds, job.overlapSeconds);
+            stitcher.addTokens(session);
+            line.skipped = stitcher.commit(line.text);
+            double start = 0.0, end = 0.0;
+            if (stitcher.committedSpan(start, end))
+                addSpan(start, end, 0, line.text.size());
+        } else {
+            // One span per Whisper segment; their texts are consecutive
+            // views of the session's transcript. Segment times are mapped
+            // back to the utterances they fall in.
+            line.text.assign(session.text());
+            std::string_view text = session.text();
+            for (const SessionSegment &segment : session.segments()) {
+                uint64_t t0 = static_cast<uint64_t>(std::max<int64_t>(0, segment.t0)) * config.whisperRate / 100;
+                uint64_t t1 = static_cast<uint64_t>(std::max<int64_t>(0, segment.t1)) * config.whisperRate / 100;
+                addSpan(clockSeconds(job.pieces, t0, config.whisperRate),
+                        clockSeconds(job.pieces, t1, config.whisperRate, true),
+                        static_cast<size_t>(segment.text.data() - text.data()), segment.text.size());
             }
-            std::cout << "[Transcription] " << deduped << std::endl;
-            previousTranscript = currentTranscript; // update for future deduplication
         }
-
-        // Update the overlap buffer to keep the last keepSamples of the full chunk.
-        if (fullChunk.size() >= static_cast<size_t>(keepSamples))
-            overlapBuffer.assign(fullChunk.end() - keepSamples, fullChunk.end());
+        emit();
     }
+    preprocessThread.join();
 
-    running = false;
-    if (inputThread.joinable())
-        inputThread.join();
+    if (config.mode == "stream")
+        flushStreamer();
+    lines.close();
+    outputThread.join();
+    sink.close();
 
     std::cout << "Terminating... cleaning up resources." << std::endl;
-    whisper_free(wctx);
-    Pa_StopStream(stream);
-    Pa_CloseStream(stream);
+    overload.flush();
+    if (overload.droppedSpans() > 0)
+        std::cerr << "[Overload] Not transcribed: " << overload.droppedSeconds("ring overrun")
+                  << " s lost to ring overruns, " << overload.droppedSeconds("no speech")
+                  << " s of non-speech skipped (" << overload.droppedSpans() << " spans)" << std::endl;
+    droppedSpans.set(overload.droppedSpans());
+    if (config.mode == "stream")
+        std::cerr << "[Stream] Decoded " << streamer.decodeRatio() << "x the audio" << std::endl;
+    reporter.stop();
+    if (config.metrics.intervalSeconds > 0.0)
+        std::cerr << metrics.toJson() << std::endl;
+    debugWriter.stop();
+    if (config.debug == true)
+        std::cout << "[Debug] WAV chunks written: " << debugWriter.chunksWritten()
+                  << ", dropped: " << debugWriter.chunksDropped() << std::endl;
+    if (config.debug == true)
+        std::cout << "[Debug] Capture overflows: " << captureSink.overflows()
+                  << ", ring overruns: " << audioData.ringBuffer.overruns() << std::endl;
+    stopCapture(capture.get(), virtualDevice);
     Pa_Terminate();
     return 0;
 }
@@ -0,0 +1,11 @@
+#ifndef ALLOCATIONCOUNTER_HPP
+#define ALLOCATIONCOUNTER_HPP
+
+#include <cstdint>
+
+// Link test/AllocationCounter.cpp into a test to replace the global
+// operator new and delete with versions that count every allocation made
+// by any thread. Tests take the count before and after the code under test.
+uint64_t allocationCount();
+
+#endif // ALLOCATIONCOUNTER_HPP
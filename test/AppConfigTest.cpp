@@ -0,0 +1,67 @@
+// AppConfig: a configuration file given as -c <path>, --config <path> or
+// --config=<path> is read before the rest of the command line, which
+// overrides it.
+
+#include "TestHarness.hpp"
+
+#include "AppConfig.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static const char *kConfigPath = "app_config_test.conf";
+
+static void writeConfig() {
+    std::ofstream file(kConfigPath, std::ios::out | std::ios::trunc);
+    file << "# test configuration\n"
+         << "mode = vad\n"
+         << "chunk-ms = 50\n";
+}
+
+static bool parse(AppConfig &config, std::vector<std::string> args) {
+    args.insert(args.begin(), "AudioTranscriptionTool");
+    std::vector<char *> argv;
+    for (std::string &arg : args)
+        argv.push_back(&arg[0]);
+    return config.parse(static_cast<int>(argv.size()), argv.data());
+}
+
+TEST_CASE(configFileIsReadInEveryForm) {
+    writeConfig();
+    const std::vector<std::vector<std::string>> forms = {
+        {"-c", kConfigPath}, {"--config", kConfigPath}, {std::string("--config=") + kConfigPath}};
+    for (const std::vector<std::string> &form : forms) {
+        AppConfig config;
+        CHECK(parse(config, form));
+        CHECK(config.mode == "vad");
+        CHECK(config.chunkMs == 50);
+    }
+    std::remove(kConfigPath);
+}
+
+TEST_CASE(commandLineOverridesFile) {
+    writeConfig();
+    AppConfig before;
+    CHECK(parse(before, {"--mode", "stream", std::string("--config=") + kConfigPath}));
+    CHECK(before.mode == "stream");
+    CHECK(before.chunkMs == 50);
+
+    AppConfig after;
+    CHECK(parse(after, {"-c", kConfigPath, "--chunk-ms=80"}));
+    CHECK(after.mode == "vad");
+    CHECK(after.chunkMs == 80);
+    std::remove(kConfigPath);
+}
+
+TEST_CASE(missingFileFails) {
+    AppConfig inlineForm;
+    CHECK(!parse(inlineForm, {"--config=does/not/exist.conf"}));
+    AppConfig separateForm;
+    CHECK(!parse(separateForm, {"--config", "does/not/exist.conf"}));
+}
+
+int main(int argc, char *argv[]) {
+    return runTests(argc, argv);
+}
@@ -0,0 +1,142 @@
+// Capture path without copies: VirtualCaptureDevice lends each period to
+// the AudioSink as a view of its own buffer, the sink pushes it into the
+// ring, and the recording is popped straight into a CaptureBuffer that is
+// then moved, not copied, to its owner. An instrumented sink checks the
+// blocks it is handed; the allocation counter catches any hidden copy of
+// a buffer, and the data pointers show the samples never moved.
+
+#include "TestHarness.hpp"
+#include "AllocationCounter.hpp"
+
+#include "AudioSink.hpp"
+#include "CaptureBuffer.hpp"
+#include "VirtualCaptureDevice.hpp"
+#include "WavReader.hpp"
+
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#ifndef TEST_DATA_DIR
+#define TEST_DATA_DIR "test/data"
+#endif
+
+static const char *kFixture = TEST_DATA_DIR "/vad/quiet_room.wav";
+
+// Forwards to a RingBufferSink and records what each onAudio() saw. Only
+// read after the device thread has been joined.
+class InstrumentedSink : public AudioSink {
+    public:
+        explicit InstrumentedSink(RingBuffer &ring) : inner_(ring) {}
+
+        void onAudio(const CaptureBlock &block) override {
+            uint64_t before = allocationCount();
+            if (blocks == 0)
+                buffer = block.audio.data;
+            else if (block.audio.data != buffer)
+                bufferChanges++;
+            if (block.frameIndex != frames)
+                indexErrors++;
+            frames += block.audio.frames;
+            blocks++;
+            inner_.onAudio(block);
+            allocations += allocationCount() - before;
+        }
+
+        const uint8_t *buffer = nullptr;
+        uint64_t blocks = 0;
+        uint64_t frames = 0;
+        uint64_t bufferChanges = 0;     // Blocks lent from a different buffer than the first.
+        uint64_t indexErrors = 0;
+        uint64_t allocations = 0;       // Made inside onAudio().
+    private:
+        RingBufferSink inner_;
+};
+
+TEST_CASE(captureBufferMovesWithoutCopying) {
+    CaptureBuffer recording(16000.0, 2, SampleFormat::Int16);
+    recording.resize(4000);
+    for (size_t i = 0; i < recording.frames(); i++)
+        reinterpret_cast<int16_t *>(recording.frame(i))[1] = static_cast<int16_t>(i);
+    const uint8_t *data = recording.view().data;
+
+    uint64_t before = allocationCount();
+    CaptureBuffer moved(std::move(recording));
+    CaptureBuffer owner;
+    owner = std::move(moved);
+    CHECK(allocationCount() - before == 0);
+    CHECK(owner.view().data == data);
+    CHECK(owner.frames() == 4000);
+    CHECK(owner.channels() == 2);
+    CHECK(recording.empty());
+    CHECK(moved.empty());
+
+    // Trimming to what was captured keeps the storage too.
+    owner.resize(3000);
+    CHECK(owner.view().data == data);
+    CHECK(reinterpret_cast<const int16_t *>(owner.view().data)[2999 * 2 + 1] == 2999);
+}
+
+TEST_CASE(recordingIsLentAndWrittenOnce) {
+    WavReader reader;
+    CHECK(reader.open(kFixture));
+    const size_t fileFrames = static_cast<size_t>(reader.totalFrames());
+    AudioView file = reader.read(fileFrames);
+    CHECK(file.format == SampleFormat::Int16 && file.frames == fileFrames);
+    std::vector<int16_t> expected(reinterpret_cast<const int16_t *>(file.data),
+                                  reinterpret_cast<const int16_t *>(file.data) + fileFrames * file.channels);
+
+    VirtualCaptureDevice device;
+    VirtualDeviceConfig config;
+    config.source = kFixture;
+    config.framesPerBuffer = 160;
+    config.speed = 0.0;
+    config.tailSeconds = 0.0;
+    CHECK(device.open(config));
+    // Room for the whole file, so nothing is overwritten however the
+    // threads are scheduled.
+    RingBuffer ring(fileFrames + 2 * config.framesPerBuffer, device.channels());
+    InstrumentedSink sink(ring);
+
+    // As AudioDeviceManager::record_device: pop straight into the
+    // recording's storage, then move it to its owner.
+    CaptureBuffer recording(device.sampleRate(), device.channels(), SampleFormat::Int16);
+    recording.resize(fileFrames + config.framesPerBuffer);
+    const uint8_t *storage = recording.view().data;
+    CHECK(device.start(&sink));
+    size_t captured = 0;
+    while (!device.finished() || ring.available() > 0) {
+        size_t frames = std::min(ring.available(), recording.frames() - captured);
+        if (frames == 0) {
+            ring.waitFor(1, std::chrono::milliseconds(5));
+            continue;
+        }
+        CHECK(ring.pop(frames, reinterpret_cast<int16_t *>(recording.frame(captured))));
+        captured += frames;
+    }
+    device.stop();
+    recording.resize(captured);
+    CaptureBuffer owner(std::move(recording));
+
+    std::printf("  %llu blocks, %llu frames, %llu allocations in onAudio\n",
+                static_cast<unsigned long long>(sink.blocks), static_cast<unsigned long long>(sink.frames),
+                static_cast<unsigned long long>(sink.allocations));
+    CHECK(sink.blocks == (fileFrames + config.framesPerBuffer - 1) / config.framesPerBuffer);
+    CHECK(sink.bufferChanges == 0);
+    CHECK(sink.indexErrors == 0);
+    CHECK(sink.allocations == 0);
+    CHECK(ring.droppedFrames() == 0);
+
+    // The last period is padded with silence.
+    CHECK(captured == sink.frames);
+    CHECK(owner.view().data == storage);
+    const int16_t *samples = reinterpret_cast<const int16_t *>(owner.view().data);
+    bool same = captured >= fileFrames;
+    for (size_t i = 0; same && i < expected.size(); i++)
+        same = samples[i] == expected[i];
+    CHECK(same);
+}
+
+int main(int argc, char *argv[]) {
+    return runTests(argc, argv);
+}
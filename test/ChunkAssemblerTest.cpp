@@ -0,0 +1,125 @@
+// ChunkAssembler: chunks come out of the ring with the overlap carried
+// over (silenced after overwritten audio), and once warmed up the capture
+// loop (push, assemble, advance) makes no heap allocation at all, wrapped
+// views and overwritten audio included.
+
+#include "TestHarness.hpp"
+#include "AllocationCounter.hpp"
+
+#include "ChunkAssembler.hpp"
+
+#include <vector>
+
+static const int kChannels = 2;
+static const size_t kPeriod = 256;          // Frames per PortAudio callback.
+
+static std::vector<int16_t> ramp(size_t frames) {
+    std::vector<int16_t> out(frames * kChannels);
+    for (size_t i = 0; i < out.size(); i++)
+        out[i] = static_cast<int16_t>((i * 37) % 2000 - 1000);
+    return out;
+}
+
+TEST_CASE(counterSeesAllocations) {
+    uint64_t before = allocationCount();
+    RingBuffer ring(64, kChannels);     // its storage
+    CHECK(allocationCount() - before == 1);
+}
+
+TEST_CASE(overlapIsCarriedOver) {
+    RingBuffer ring(48000, kChannels);
+    ChunkAssembler assembler(9600, 1600, kChannels, 48000, 16000);
+    CHECK(assembler.overlapSize() == 533);
+    CHECK(!assembler.assemble(ring));   // nothing buffered yet
+
+    std::vector<int16_t> in = ramp(8000);
+    ring.push(in.data(), 8000);
+    CHECK(assembler.assemble(ring));
+    CHECK(assembler.size() == 533 + 2666 || assembler.size() == 533 + 2667);
+    CHECK(assembler.position() == 8000);
+    std::vector<float> tail(assembler.data() + assembler.size() - 533, assembler.data() + assembler.size());
+    assembler.advance();
+    CHECK(assembler.size() == 533);
+    bool same = true;
+    for (size_t i = 0; i < tail.size(); i++)
+        same = same && assembler.data()[i] == tail[i];
+    CHECK(same);
+}
+
+TEST_CASE(overlapIsSilencedAfterGap) {
+    RingBuffer ring(16384, kChannels);
+    ChunkAssembler assembler(9600, 1600, kChannels, 48000, 16000);
+    std::vector<int16_t> in = ramp(8000);   // the new frames of one chunk
+    ring.push(in.data(), 8000);
+    CHECK(assembler.assemble(ring));
+    assembler.advance();
+
+    // Four chunks pushed into a ring with room for two.
+    for (int i = 0; i < 4; i++)
+        ring.push(in.data(), 8000);
+    CHECK(assembler.assemble(ring));
+    uint64_t gapStart = 0;
+    uint64_t gapEnd = 0;
+    CHECK(assembler.takeGap(gapStart, gapEnd));
+    CHECK(gapStart == 8000 && gapEnd == 40000 - 16384);
+    bool silent = true;
+    for (size_t i = 0; i < assembler.overlapSize(); i++)
+        silent = silent && assembler.data()[i] == 0.0f;
+    CHECK(silent);
+    CHECK(!assembler.takeGap(gapStart, gapEnd));
+}
+
+// The capture loop at 48 kHz stereo (and 44.1 kHz) with 100 ms chunks:
+// callbacks push periods, the consumer assembles whenever a chunk is ready.
+static void steadyState(double deviceRate, OverflowPolicy policy, bool overflow) {
+    const size_t chunk = static_cast<size_t>(deviceRate / 10);
+    RingBuffer ring(static_cast<size_t>(deviceRate), kChannels, policy);
+    ChunkAssembler assembler(chunk, chunk / 4, kChannels, deviceRate, 16000);
+    std::vector<int16_t> in = ramp(kPeriod);
+    uint64_t gapStart = 0;
+    uint64_t gapEnd = 0;
+    size_t chunks = 0;
+    size_t gaps = 0;
+    auto cycle = [&](int periods) {
+        for (int i = 0; i < periods; i++) {
+            ring.push(in.data(), kPeriod);
+            // Overflowing runs let the ring fill up before reading.
+            if (overflow && i % 400 != 399)
+                continue;
+            while (assembler.assemble(ring)) {
+                assembler.advance();
+                chunks++;
+            }
+            while (assembler.takeGap(gapStart, gapEnd))
+                gaps++;
+        }
+    };
+
+    cycle(200);
+    uint64_t before = allocationCount();
+    cycle(20000);
+    uint64_t allocated = allocationCount() - before;
+    std::printf("  %.0f Hz: %zu chunks, %zu gaps, %llu allocations\n", deviceRate, chunks, gaps,
+                static_cast<unsigned long long>(allocated));
+    CHECK(chunks > 100);
+    CHECK(allocated == 0);
+    if (overflow && policy == OverflowPolicy::OverwriteOldest)
+        CHECK(gaps > 0);
+}
+
+TEST_CASE(steadyStateDoesNotAllocate48k) {
+    steadyState(48000, OverflowPolicy::OverwriteOldest, false);
+}
+
+TEST_CASE(steadyStateDoesNotAllocate44k) {
+    steadyState(44100, OverflowPolicy::OverwriteOldest, false);
+}
+
+TEST_CASE(overwrittenAudioDoesNotAllocate) {
+    steadyState(48000, OverflowPolicy::OverwriteOldest, true);
+    steadyState(48000, OverflowPolicy::DropNewest, true);
+}
+
+int main(int argc, char *argv[]) {
+    return runTests(argc, argv);
+}
@@ -0,0 +1,265 @@
+#include "FakeWhisper.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+static const whisper_token kEot = 50257;
+static const int kVocabulary = kFakePartialToken + 10000;
+static const int kMaxSegments = 64;
+static const size_t kMaxText = kFakeMaxTokens * 8;
+
+// Results of the last whisper_full on a state, in fixed buffers so decoding
+// never allocates.
+struct whisper_state {
+    int tokens = 0;
+    whisper_token ids[kFakeMaxTokens];
+    int64_t t0[kFakeMaxTokens];
+    int64_t t1[kFakeMaxTokens];
+    int segments = 0;
+    int segmentEnd[kMaxSegments];      // One past the segment's last token.
+    size_t textBegin[kMaxSegments + 1];
+    char text[kMaxText];
+};
+
+struct whisper_context {
+    whisper_state state;
+};
+
+static char vocabulary[kVocabulary][8];
+
+static bool fillVocabulary() {
+    for (int id = 0; id < kVocabulary; id++) {
+        if (id < kFakePartialToken)
+            std::snprintf(vocabulary[id], sizeof(vocabulary[id]), " w%d", id);
+        else
+            std::snprintf(vocabulary[id], sizeof(vocabulary[id]), " w%d~", id - kFakePartialToken);
+    }
+    return true;
+}
+static const bool vocabularyFilled = fillVocabulary();
+
+static std::atomic<int> defaultParamsCalls(0);
+static std::atomic<int> decodeCalls(0);
+static std::atomic<uint64_t> decodedSamples(0);
+static std::atomic<bool> failDecodes(false);
+static std::mutex lastMutex;
+static whisper_full_params lastParams;
+static whisper_token lastPrompt[kFakeMaxTokens];
+
+whisper_context *fakeWhisperContext() {
+    static whisper_context context;
+    return &context;
+}
+
+float fakeWordLevel(whisper_token id) {
+    return static_cast<float>(id) / 16384.0f;
+}
+
+int fakeDefaultParamsCalls() {
+    return defaultParamsCalls.load();
+}
+
+int fakeDecodeCalls() {
+    return decodeCalls.load();
+}
+
+uint64_t fakeDecodedSamples() {
+    return decodedSamples.load();
+}
+
+const whisper_full_params &fakeLastParams() {
+    return lastParams;
+}
+
+const whisper_token *fakeLastPrompt() {
+    return lastPrompt;
+}
+
+void fakeFailDecodes(bool fail) {
+    failDecodes = fail;
+}
+
+static int64_t centiseconds(int sample) {
+    return static_cast<int64_t>(sample) * 100 / 16000;
+}
+
+static void endSegment(whisper_state *state, size_t &textSize) {
+    const int first = state->segments > 0 ? state->segmentEnd[state->segments - 1] : 0;
+    if (state->tokens == first || state->segments == kMaxSegments)
+        return;
+    state->segmentEnd[state->segments] = state->tokens;
+    state->textBegin[++state->segments] = textSize;
+}
+
+static int fakeFull(whisper_state *state, const whisper_full_params &params, const float *samples, int count) {
+    decodeCalls++;
+    decodedSamples += static_cast<uint64_t>(count);
+    {
+        std::lock_guard<std::mutex> lock(lastMutex);
+        lastParams = params;
+        int prompt = std::min(params.prompt_n_tokens, kFakeMaxTokens);
+        for (int i = 0; i < prompt; i++)
+            lastPrompt[i] = params.prompt_tokens[i];
+    }
+    state->tokens = 0;
+    state->segments = 0;
+    state->textBegin[0] = 0;
+    if (failDecodes)
+        return -1;
+
+    const int gap = kFakeSegmentGapMs * 16;
+    size_t textSize = 0;
+    int silence = 0;
+    int i = 0;
+    while (i < count) {
+        if (samples[i] == 0.0f) {
+            if (++silence == gap)
+                endSegment(state, textSize);
+            i++;
+            continue;
+        }
+        silence = 0;
+        int start = i;
+        while (i < count && samples[i] == samples[start])
+            i++;
+        if (state->tokens == kFakeMaxTokens)
+            continue;
+        whisper_token id = static_cast<whisper_token>(std::lround(samples[start] * 16384.0f));
+        id = std::max(1, std::min(id, kFakePartialToken - 1));
+        if (i == count)
+            id += kFakePartialToken;
+        const int n = state->tokens++;
+        state->ids[n] = id;
+        state->t0[n] = centiseconds(start);
+        state->t1[n] = centiseconds(i);
+        size_t length = std::strlen(vocabulary[id]);
+        if (textSize + length < kMaxText) {
+            std::memcpy(state->text + textSize, vocabulary[id], length);
+            textSize += length;
+        }
+    }
+    endSegment(state, textSize);
+    return 0;
+}
+
+static int firstToken(const whisper_state *state, int segment) {
+    return segment == 0 ? 0 : state->segmentEnd[segment - 1];
+}
+
+// Segment texts are NUL-terminated copies of their part of the text.
+static const char *segmentText(whisper_state *state, int segment) {
+    static thread_local char buffer[kMaxText];
+    if (segment < 0 || segment >= state->segments)
+        return nullptr;
+    size_t begin = state->textBegin[segment];
+    size_t end = state->textBegin[segment + 1];
+    std::memcpy(buffer, state->text + begin, end - begin);
+    buffer[end - begin] = '\0';
+    return buffer;
+}
+
+//---------------------------------------------------------------------------
+// whisper.h
+//---------------------------------------------------------------------------
+struct whisper_full_params whisper_full_default_params(enum whisper_sampling_strategy strategy) {
+    defaultParamsCalls++;
+    whisper_full_params params;
+    std::memset(&params, 0, sizeof(params));
+    params.strategy = strategy;
+    params.n_threads = 4;
+    params.language = "en";
+    return params;
+}
+
+struct whisper_state *whisper_init_state(struct whisper_context *) {
+    return new whisper_state();
+}
+
+void whisper_free_state(struct whisper_state *state) {
+    delete state;
+}
+
+int whisper_full(struct whisper_context *ctx, struct whisper_full_params params, const float *samples, int n_samples) {
+    return fakeFull(&ctx->state, params, samples, n_samples);
+}
+
+int whisper_full_with_state(struct whisper_context *, struct whisper_state *state, struct whisper_full_params params,
+                            const float *samples, int n_samples) {
+    return fakeFull(state, params, samples, n_samples);
+}
+
+int whisper_full_n_segments_from_state(struct whisper_state *state) {
+    return state->segments;
+}
+
+int whisper_full_n_segments(struct whisper_context *ctx) {
+    return whisper_full_n_segments_from_state(&ctx->state);
+}
+
+const char *whisper_full_get_segment_text_from_state(struct whisper_state *state, int i_segment) {
+    return segmentText(state, i_segment);
+}
+
+const char *whisper_full_get_segment_text(struct whisper_context *ctx, int i_segment) {
+    return segmentText(&ctx->state, i_segment);
+}
+
+int64_t whisper_full_get_segment_t0_from_state(struct whisper_state *state, int i_segment) {
+    return state->t0[firstToken(state, i_segment)];
+}
+
+int64_t whisper_full_get_segment_t0(struct whisper_context *ctx, int i_segment) {
+    return whisper_full_get_segment_t0_from_state(&ctx->state, i_segment);
+}
+
+int64_t whisper_full_get_segment_t1_from_state(struct whisper_state *state, int i_segment) {
+    return state->t1[state->segmentEnd[i_segment] - 1];
+}
+
+int64_t whisper_full_get_segment_t1(struct whisper_context *ctx, int i_segment) {
+    return whisper_full_get_segment_t1_from_state(&ctx->state, i_segment);
+}
+
+int whisper_full_n_tokens_from_state(struct whisper_state *state, int i_segment) {
+    return state->segmentEnd[i_segment] - firstToken(state, i_segment);
+}
+
+int whisper_full_n_tokens(struct whisper_context *ctx, int i_segment) {
+    return whisper_full_n_tokens_from_state(&ctx->state, i_segment);
+}
+
+whisper_token whisper_full_get_token_id_from_state(struct whisper_state *state, int i_segment, int i_token) {
+    return state->ids[firstToken(state, i_segment) + i_token];
+}
+
+whisper_token whisper_full_get_token_id(struct whisper_context *ctx, int i_segment, int i_token) {
+    return whisper_full_get_token_id_from_state(&ctx->state, i_segment, i_token);
+}
+
+whisper_token_data whisper_full_get_token_data_from_state(struct whisper_state *state, int i_segment, int i_token) {
+    const int token = firstToken(state, i_segment) + i_token;
+    whisper_token_data data;
+    std::memset(&data, 0, sizeof(data));
+    data.id = state->ids[token];
+    data.tid = data.id;
+    data.p = 1.0f;
+    data.t0 = state->t0[token];
+    data.t1 = state->t1[token];
+    return data;
+}
+
+whisper_token_data whisper_full_get_token_data(struct whisper_context *ctx, int i_segment, int i_token) {
+    return whisper_full_get_token_data_from_state(&ctx->state, i_segment, i_token);
+}
+
+whisper_token whisper_token_eot(struct whisper_context *) {
+    return kEot;
+}
+
+const char *whisper_token_to_str(struct whisper_context *, whisper_token token) {
+    return token >= 0 && token < kVocabulary ? vocabulary[token] : "";
+}
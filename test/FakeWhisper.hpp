@@ -0,0 +1,41 @@
+#ifndef FAKEWHISPER_HPP
+#define FAKEWHISPER_HPP
+
+#include <cstdint>
+
+#include "whisper.h"
+
+// Link test/FakeWhisper.cpp instead of whisper.cpp to run the decode paths
+// without a model. It implements the part of the whisper.h API the project
+// uses, deterministically and without allocating in whisper_full.
+//
+// Audio is read as "words": each run of one constant non-zero level is a
+// token, fakeToken(level), with the text " w<id>" and the run's times.
+// A run that reaches the end of the input is a word cut off and comes out
+// as kFakePartialToken + id instead. A silence of kFakeSegmentGapMs or more
+// starts a new segment.
+
+static const whisper_token kFakePartialToken = 20000;
+static const int kFakeSegmentGapMs = 500;
+static const int kFakeMaxTokens = 1024;
+
+// Context for the session under test; shared, never freed.
+whisper_context *fakeWhisperContext();
+
+// Sample level that decodes to token `id` (1 to 9999).
+float fakeWordLevel(whisper_token id);
+
+// Calls so far to whisper_full_default_params.
+int fakeDefaultParamsCalls();
+// Calls so far to whisper_full and whisper_full_with_state, and the samples
+// they were given.
+int fakeDecodeCalls();
+uint64_t fakeDecodedSamples();
+// Parameters of the last decode, and a copy of its prompt tokens
+// (fakeLastParams().prompt_n_tokens of them, up to kFakeMaxTokens).
+const whisper_full_params &fakeLastParams();
+const whisper_token *fakeLastPrompt();
+// Makes the following decodes fail (return non-zero) until called again.
+void fakeFailDecodes(bool fail);
+
+#endif // FAKEWHISPER_HPP
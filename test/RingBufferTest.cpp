@@ -0,0 +1,208 @@
+// RingBuffer: wrap-around, views, and a producer/consumer stress run per
+// overflow policy that checks every frame arrives in order and that the
+// overrun counters add up to exactly the frames that went missing.
+
+#include "TestHarness.hpp"
+
+#include "RingBuffer.hpp"
+
+#include <algorithm>
+#include <thread>
+
+static const int kChannels = 2;
+
+// Frames carry their 32-bit sequence number split over the two channels.
+static void writeFrame(int16_t *frame, uint32_t sequence) {
+    frame[0] = static_cast<int16_t>(static_cast<uint16_t>(sequence & 0xFFFF));
+    frame[1] = static_cast<int16_t>(static_cast<uint16_t>(sequence >> 16));
+}
+
+static uint32_t readFrame(const int16_t *frame) {
+    return static_cast<uint32_t>(static_cast<uint16_t>(frame[0])) |
+           static_cast<uint32_t>(static_cast<uint16_t>(frame[1])) << 16;
+}
+
+static uint32_t nextRandom(uint32_t &seed) {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+TEST_CASE(capacityIsRoundedToPowerOfTwo) {
+    RingBuffer ring(1000, kChannels);
+    CHECK(ring.capacity() == 1024);
+    CHECK(ring.channels() == kChannels);
+    CHECK(ring.available() == 0);
+}
+
+TEST_CASE(viewSplitsAtWrapPoint) {
+    RingBuffer ring(16, kChannels, OverflowPolicy::DropNewest);
+    int16_t frames[12 * kChannels];
+    for (uint32_t i = 0; i < 12; i++)
+        writeFrame(frames + i * kChannels, i);
+    int16_t out[12 * kChannels];
+    CHECK(ring.push(frames, 12) == 12);
+    CHECK(ring.pop(10, out));
+    CHECK(ring.push(frames, 12) == 12);     // 2 left + 12 new, wraps after 6
+
+    RingBufferView view;
+    CHECK(ring.peek(14, view));
+    CHECK(view.frames() == 14);
+    CHECK(view.firstFrames == 6);
+    CHECK(view.secondFrames == 8);
+    CHECK(view.position == 10);
+    CHECK(readFrame(view.first) == 10);
+    CHECK(readFrame(view.second) == 4);
+    CHECK(ring.consume(view));
+    CHECK(ring.available() == 0);
+}
+
+TEST_CASE(dropNewestCountsRejectedFrames) {
+    RingBuffer ring(8, kChannels, OverflowPolicy::DropNewest);
+    int16_t frames[12 * kChannels] = {};
+    CHECK(ring.push(frames, 6) == 6);
+    CHECK(ring.push(frames, 6) == 2);
+    CHECK(ring.push(frames, 1) == 0);
+    CHECK(ring.overruns() == 2);
+    CHECK(ring.droppedFrames() == 5);
+    CHECK(ring.available() == 8);
+}
+
+TEST_CASE(overwriteOldestKeepsNewest) {
+    RingBuffer ring(8, kChannels, OverflowPolicy::OverwriteOldest);
+    int16_t frames[20 * kChannels];
+    for (uint32_t i = 0; i < 20; i++)
+        writeFrame(frames + i * kChannels, i);
+    CHECK(ring.push(frames, 20) == 8);
+    int16_t out[4 * kChannels];
+    CHECK(ring.pop(4, out));
+    CHECK(readFrame(out) == 12);
+    CHECK(ring.overruns() == 1);
+    CHECK(ring.droppedFrames() == 12);
+}
+
+TEST_CASE(waitForTimesOutAndWakes) {
+    RingBuffer ring(1024, kChannels);
+    auto start = std::chrono::steady_clock::now();
+    CHECK(!ring.waitFor(64, std::chrono::milliseconds(20)));
+    CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(15));
+
+    int16_t frames[64 * kChannels] = {};
+    std::thread producer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ring.push(frames, 32);
+        ring.push(frames, 32);
+    });
+    CHECK(ring.waitFor(64, std::chrono::seconds(5)));
+    producer.join();
+    CHECK(ring.available() == 64);
+    CHECK(!ring.waitFor(2048, std::chrono::milliseconds(1)));  // more than the capacity
+}
+
+// Pushes `total` numbered frames in random block sizes while the consumer
+// reads random amounts through pop() and peek()/consume(). The producer
+// waits a little for space, like a capture callback that runs at a steady
+// rate, but the consumer now and then stalls for longer and the ring
+// overflows. Frames are numbered by device position, so a lost frame shows
+// up as a gap in the sequence.
+static void stress(OverflowPolicy policy) {
+    const uint32_t total = 2000000;
+    RingBuffer ring(4096, kChannels, policy);
+
+    uint64_t shortPushes = 0;
+    uint64_t rejected = 0;
+    std::atomic<bool> done(false);
+    std::thread producer([&]() {
+        std::vector<int16_t> block(600 * kChannels);
+        uint32_t seed = 7;
+        for (uint32_t next = 0; next < total;) {
+            uint32_t frames = std::min<uint32_t>(1 + nextRandom(seed) % 600, total - next);
+            for (uint32_t i = 0; i < frames; i++)
+                writeFrame(&block[i * kChannels], next + i);
+            for (int spins = 0; spins < 100 && ring.capacity() - ring.available() < frames; spins++)
+                std::this_thread::yield();
+            size_t stored = ring.push(block.data(), frames);
+            if (policy == OverflowPolicy::DropNewest && stored < frames) {
+                shortPushes++;
+                rejected += frames - stored;
+            }
+            next += frames;
+        }
+        done.store(true);
+    });
+
+    uint64_t received = 0;
+    uint64_t gaps = 0;
+    uint64_t tornBlocks = 0;
+    int64_t last = -1;
+    auto accept = [&](const int16_t *frames, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            int64_t sequence = readFrame(frames + i * kChannels);
+            if (sequence <= last)
+                tornBlocks++;
+            else
+                gaps += static_cast<uint64_t>(sequence - last - 1);
+            last = sequence;
+        }
+        received += count;
+    };
+
+    std::vector<int16_t> out(1024 * kChannels);
+    uint32_t seed = 11;
+    for (;;) {
+        bool finished = done.load();
+        size_t available = ring.available();
+        if (finished && available == 0)
+            break;
+        size_t frames = std::min<size_t>(1 + nextRandom(seed) % 1024, available);
+        if (frames == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (nextRandom(seed) % 2 == 0) {
+            if (ring.pop(frames, out.data()))
+                accept(out.data(), frames);
+        } else {
+            RingBufferView view;
+            if (ring.peek(frames, view)) {
+                std::memcpy(out.data(), view.first, view.firstFrames * kChannels * sizeof(int16_t));
+                if (view.secondFrames > 0)
+                    std::memcpy(out.data() + view.firstFrames * kChannels, view.second,
+                                view.secondFrames * kChannels * sizeof(int16_t));
+                // With OverwriteOldest a frame's number is its position in the ring.
+                bool inPlace = policy != OverflowPolicy::OverwriteOldest || readFrame(out.data()) == view.position;
+                if (ring.consume(view)) {
+                    CHECK(inPlace);
+                    accept(out.data(), frames);
+                }
+            }
+        }
+        if (nextRandom(seed) % 256 == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    producer.join();
+
+    std::printf("  %llu received, %llu dropped in %llu overruns\n", static_cast<unsigned long long>(received),
+                static_cast<unsigned long long>(ring.droppedFrames()),
+                static_cast<unsigned long long>(ring.overruns()));
+    CHECK(tornBlocks == 0);
+    CHECK(gaps + (total - 1 - static_cast<uint64_t>(last)) == ring.droppedFrames());
+    CHECK(received + ring.droppedFrames() == total);
+    CHECK(ring.overruns() <= ring.droppedFrames());
+    CHECK(ring.droppedFrames() > 0);   // the stalls must have overflowed the ring
+    if (policy == OverflowPolicy::DropNewest) {
+        CHECK(ring.overruns() == shortPushes);
+        CHECK(ring.droppedFrames() == rejected);
+    }
+}
+
+TEST_CASE(stressDropNewest) {
+    stress(OverflowPolicy::DropNewest);
+}
+
+TEST_CASE(stressOverwriteOldest) {
+    stress(OverflowPolicy::OverwriteOldest);
+}
+
+int main(int argc, char *argv[]) {
+    return runTests(argc, argv);
+}
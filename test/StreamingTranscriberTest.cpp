@@ -0,0 +1,152 @@
+// StreamingTranscriber against the fake whisper.h in FakeWhisper.cpp: a
+// minute of synthetic speech pushed in 100 ms blocks, as the capture
+// thread does, must come out as the same words in order, continuous speech
+// must be decoded about 1 + holdback/step times over, and the decode
+// parameters are built once for the streamer rather than on every pass.
+
+#include "TestHarness.hpp"
+#include "FakeWhisper.hpp"
+
+#include "StreamingTranscriber.hpp"
+
+#include <string>
+#include <vector>
+
+static const int kRate = 16000;
+
+struct Speech {
+    std::vector<float> audio;
+    std::string text;
+    std::vector<whisper_token> words;
+    std::vector<size_t> starts;     // First sample of each word.
+};
+
+// `seconds` of 300 ms words 100 ms apart, with a pause long enough to end
+// a segment after every `phrase` words.
+static Speech speech(double seconds, int phrase) {
+    Speech out;
+    whisper_token id = 1;
+    while (out.audio.size() < seconds * kRate) {
+        out.starts.push_back(out.audio.size());
+        out.audio.insert(out.audio.end(), kRate * 3 / 10, fakeWordLevel(id));
+        out.audio.insert(out.audio.end(), kRate / 10, 0.0f);
+        if (id % phrase == 0)
+            out.audio.insert(out.audio.end(), static_cast<size_t>(kFakeSegmentGapMs + 100) * kRate / 1000, 0.0f);
+        out.text += " w" + std::to_string(id);
+        out.words.push_back(id);
+        id++;
+    }
+    out.audio.insert(out.audio.end(), kRate, 0.0f);
+    return out;
+}
+
+// Streams `speech` through `streamer` and returns everything committed.
+static std::string stream(StreamingTranscriber &streamer, const Speech &speech) {
+    std::string committed;
+    std::string text;
+    const size_t block = kRate / 10;
+    for (size_t offset = 0; offset < speech.audio.size(); offset += block) {
+        streamer.push(speech.audio.data() + offset, std::min(block, speech.audio.size() - offset));
+        if (!streamer.ready())
+            continue;
+        text.clear();
+        CHECK(streamer.step(text));
+        committed += text;
+    }
+    text.clear();
+    CHECK(streamer.flush(text));
+    committed += text;
+    return committed;
+}
+
+TEST_CASE(phrasesComeOutInOrder) {
+    Speech input = speech(60.0, 5);
+    StreamingConfig config;
+    StreamingTranscriber streamer(fakeWhisperContext(), config);
+    CHECK(streamer.init());
+    std::string committed = stream(streamer, input);
+    CHECK(committed == input.text);
+    if (committed != input.text)
+        std::printf("  expected:%s\n  got:     %s\n", input.text.c_str(), committed.c_str());
+}
+
+// One segment that never pauses: with whole-segment commits every 2 s step
+// re-decoded the window until it reached maxWindowMs (about 4.5x the audio).
+// Committing word by word keeps it at holdback plus one step, so only the
+// held-back tail is decoded twice.
+TEST_CASE(continuousSpeechIsDecodedAboutOnce) {
+    Speech input = speech(60.0, 1000);
+    StreamingConfig config;
+    StreamingTranscriber streamer(fakeWhisperContext(), config);
+    CHECK(streamer.init());
+    uint64_t before = fakeDecodedSamples();
+    std::string committed = stream(streamer, input);
+    double ratio = static_cast<double>(fakeDecodedSamples() - before) / input.audio.size();
+    const double target = 1.0 + static_cast<double>(config.holdbackMs) / config.stepMs;
+    std::printf("  decoded %.2fx the audio (target %.2fx)\n", ratio, target);
+    CHECK(ratio <= target + 0.05);
+    CHECK_NEAR(streamer.decodeRatio(), ratio, 1e-9);
+    CHECK(streamer.windowStart() == input.audio.size());
+    CHECK(committed == input.text);
+    if (committed != input.text)
+        std::printf("  expected:%s\n  got:     %s\n", input.text.c_str(), committed.c_str());
+}
+
+TEST_CASE(pushWithoutSteppingKeepsTheLatestAudio) {
+    Speech input = speech(40.0, 1000);
+    StreamingConfig config;
+    StreamingTranscriber streamer(fakeWhisperContext(), config);
+    CHECK(streamer.init());
+    for (size_t offset = 0; offset < input.audio.size(); offset += 1600)
+        streamer.push(input.audio.data() + offset, std::min<size_t>(1600, input.audio.size() - offset));
+    const size_t window = static_cast<size_t>(config.maxWindowMs + config.stepMs) * kRate / 1000;
+    const uint64_t start = streamer.windowStart();
+    CHECK(start == input.audio.size() - window);
+
+    // Every word inside the window comes out, after at most the one it
+    // starts in.
+    std::string committed;
+    CHECK(streamer.flush(committed));
+    std::string inside;
+    std::string before;
+    for (size_t i = 0; i < input.words.size(); i++) {
+        if (input.starts[i] >= start)
+            inside += " w" + std::to_string(input.words[i]);
+        else
+            before = " w" + std::to_string(input.words[i]);
+    }
+    CHECK(committed == inside || committed == before + inside);
+}
+
+TEST_CASE(paramsAreBuiltOnce) {
+    Speech input = speech(60.0, 5);
+    StreamingConfig config;
+    config.language = "de";
+    config.threads = 3;
+    StreamingTranscriber streamer(fakeWhisperContext(), config);
+    int before = fakeDefaultParamsCalls();
+    CHECK(streamer.init());
+    int decodes = fakeDecodeCalls();
+    stream(streamer, input);
+    std::printf("  %d passes\n", fakeDecodeCalls() - decodes);
+    CHECK(fakeDecodeCalls() - decodes > 20);
+    CHECK(fakeDefaultParamsCalls() - before == 1);
+
+    const whisper_full_params &params = fakeLastParams();
+    CHECK(std::string(params.language) == "de");
+    CHECK(params.n_threads == 3);
+    CHECK(params.no_context);
+    CHECK(params.audio_ctx > 0 && params.audio_ctx < 1500);
+    // The prompt is the committed words, most recent last; word ids count
+    // up from 1, so it must be a run of consecutive ids.
+    const int prompt = params.prompt_n_tokens;
+    CHECK(prompt > 0 && prompt <= config.maxPromptTokens);
+    bool consecutive = prompt > 0;
+    for (int i = 1; consecutive && i < prompt; i++)
+        consecutive = fakeLastPrompt()[i] == fakeLastPrompt()[i - 1] + 1;
+    CHECK(consecutive);
+}
+
+int main(int argc, char *argv[]) {
+    return runTests(argc, argv);
+}
@@ -0,0 +1,101 @@
+#ifndef TESTHARNESS_HPP
+#define TESTHARNESS_HPP
+
+// Minimal test harness in the style of bench/BenchHarness.hpp, so the tests
+// build with nothing but the project's own sources.
+//
+//   TEST_CASE(ringKeepsOrder) {
+//       ...
+//       CHECK(ring.available() == 0);
+//       CHECK_NEAR(gain, 1.0, 1e-3);
+//   }
+//   int main(int argc, char *argv[]) { return runTests(argc, argv); }
+//
+// A failed CHECK prints its location and the test carries on; the process
+// exits non-zero if any check failed, which is what CTest looks at.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using TestFunction = void (*)();
+
+struct TestEntry {
+    const char *name;
+    TestFunction fn;
+};
+
+inline std::vector<TestEntry> &testRegistry() {
+    static std::vector<TestEntry> entries;
+    return entries;
+}
+
+inline int &testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+struct TestRegistrar {
+    TestRegistrar(const char *name, TestFunction fn) { testRegistry().push_back({name, fn}); }
+};
+
+#define TEST_CASE(fn)                                          \
+    static void fn();                                          \
+    static TestRegistrar fn##_registrar(#fn, fn);              \
+    static void fn()
+
+inline void testFailed(const char *file, int line, const std::string &what) {
+    testFailures()++;
+    std::printf("  %s:%d: FAILED %s\n", file, line, what.c_str());
+}
+
+#define CHECK(cond)                                            \
+    do {                                                       \
+        if (!(cond))                                           \
+            testFailed(__FILE__, __LINE__, #cond);             \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                                     \
+    do {                                                                                            \
+        double actual_ = static_cast<double>(actual);                                               \
+        double expected_ = static_cast<double>(expected);                                           \
+        if (!(std::fabs(actual_ - expected_) <= static_cast<double>(tolerance)))                    \
+            testFailed(__FILE__, __LINE__, std::string(#actual " = ") + std::to_string(actual_) +   \
+                                               ", expected " + std::to_string(expected_) + " +- " + \
+                                               std::to_string(static_cast<double>(tolerance)));     \
+    } while (0)
+
+inline int runTests(int argc, char *argv[]) {
+    std::string filter;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc)
+            filter = argv[++i];
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter <substring>]" << std::endl;
+            return 1;
+        }
+    }
+
+    int failedTests = 0;
+    int run = 0;
+    for (const TestEntry &entry : testRegistry()) {
+        if (!filter.empty() && std::strstr(entry.name, filter.c_str()) == nullptr)
+            continue;
+        int before = testFailures();
+        std::printf("[ RUN  ] %s\n", entry.name);
+        std::fflush(stdout);
+        entry.fn();
+        bool ok = testFailures() == before;
+        std::printf("[ %s ] %s\n", ok ? " OK " : "FAIL", entry.name);
+        failedTests += ok ? 0 : 1;
+        run++;
+    }
+    std::printf("%d tests, %d failed\n", run, failedTests);
+    return failedTests == 0 ? 0 : 1;
+}
+
+#endif // TESTHARNESS_HPP
@@ -0,0 +1,155 @@
+// TranscriptStitcher: the tail of one window and the head of the next are
+// aligned over token IDs. Windows here are 3 s long every 2 s, so each new
+// window repeats the last second of the previous one; the cases cover a
+// head that repeats the whole tail, one that lost the first repeated word,
+// one with no token in common, one with a single token in common by
+// chance, and repeated words where only the KMP failure function finds the
+// right suffix.
+
+#include "TestHarness.hpp"
+
+#include "TranscriptStitcher.hpp"
+
+#include <string>
+#include <vector>
+
+// Token text is " w<id>", kept alive for the whole run.
+static const char *word(whisper_token id) {
+    static std::vector<std::string> words;
+    if (words.empty()) {
+        for (int i = 0; i < 64; i++)
+            words.push_back(" w" + std::to_string(i));
+    }
+    return words[static_cast<size_t>(id)].c_str();
+}
+
+// Adds `ids` as back-to-back 200 ms tokens from `t0` (centiseconds from the
+// window start).
+static void addWords(TranscriptStitcher &stitcher, const std::vector<whisper_token> &ids, int64_t t0) {
+    for (whisper_token id : ids) {
+        stitcher.addToken(id, t0, t0 + 20, word(id));
+        t0 += 20;
+    }
+}
+
+static std::string text(const std::vector<whisper_token> &ids) {
+    std::string out;
+    for (whisper_token id : ids)
+        out += word(id);
+    return out;
+}
+
+// Window [0, 3) s: two early words, then `tail` from 2 s. Window [2, 5) s:
+// `head` from `headStart`, then two words well after the overlap. Returns
+// the tokens commit() skipped and appends the second window's text.
+static size_t stitch(const std::vector<whisper_token> &tail, const std::vector<whisper_token> &head,
+                     int64_t headStart, std::string &committed) {
+    TranscriptStitcher stitcher;
+    stitcher.beginWindow(0.0, 0.0);
+    addWords(stitcher, {1, 2}, 0);
+    addWords(stitcher, tail, 200);
+    std::string first;
+    CHECK(stitcher.commit(first) == 0);
+    CHECK(first == text({1, 2}) + text(tail));
+
+    stitcher.beginWindow(2.0, 1.0);
+    addWords(stitcher, head, headStart);
+    addWords(stitcher, {40, 41}, 150);
+    return stitcher.commit(committed);
+}
+
+TEST_CASE(fullOverlap) {
+    std::string committed;
+    CHECK(stitch({10, 11, 12}, {10, 11, 12}, 0, committed) == 3);
+    CHECK(committed == text({40, 41}));
+}
+
+TEST_CASE(partialOverlap) {
+    // The new window starts mid-word and Whisper dropped the first one.
+    std::string committed;
+    CHECK(stitch({10, 11, 12}, {11, 12}, 20, committed) == 2);
+    CHECK(committed == text({40, 41}));
+
+    // The tail has words before the repeated ones.
+    committed.clear();
+    CHECK(stitch({9, 10, 11}, {10, 11, 13}, 0, committed) == 2);
+    CHECK(committed == text({13, 40, 41}));
+}
+
+TEST_CASE(noOverlap) {
+    // Nothing in common: the words centred before the end of the previous
+    // window's last word (2.6 s) are dropped by time instead.
+    std::string committed;
+    CHECK(stitch({10, 11, 12}, {20, 21, 22, 23}, 0, committed) == 3);
+    CHECK(committed == text({23, 40, 41}));
+
+    // Windows that do not overlap at all keep everything.
+    TranscriptStitcher stitcher;
+    stitcher.beginWindow(0.0, 0.0);
+    addWords(stitcher, {10, 11}, 0);
+    committed.clear();
+    stitcher.commit(committed);
+    stitcher.beginWindow(3.0, 0.0);
+    addWords(stitcher, {10, 11}, 0);
+    committed.clear();
+    CHECK(stitcher.commit(committed) == 0);
+    CHECK(committed == text({10, 11}));
+    double start = 0.0;
+    double end = 0.0;
+    CHECK(stitcher.committedSpan(start, end));
+    CHECK_NEAR(start, 3.0, 1e-9);
+    CHECK_NEAR(end, 3.4, 1e-9);
+}
+
+TEST_CASE(singleTokenIsNotAnAlignment) {
+    // The head starts with the tail's last word, but 0.4 s earlier than it
+    // was spoken: a common word lining up by chance. Trusting it would
+    // repeat 20 and 21, which the previous window already covered; the
+    // timestamp fallback drops everything centred before 2.6 s.
+    std::string committed;
+    CHECK(stitch({10, 11, 12}, {12, 20, 21, 22}, 0, committed) == 3);
+    CHECK(committed == text({22, 40, 41}));
+}
+
+TEST_CASE(repeatedTokens) {
+    // Tail "a b a b a", head "a b a b c": the longest suffix of the tail
+    // that is a prefix of the head is "a b a". The last "a" of the tail
+    // fails against "c"; a matcher that then starts over instead of
+    // following the failure function finds only "a".
+    std::string committed;
+    CHECK(stitch({10, 11, 10, 11, 10}, {10, 11, 10, 11, 12}, 0, committed) == 3);
+    CHECK(committed == text({11, 12, 40, 41}));
+
+    // Tail "a b a b", head "a b": the whole head matches in the middle of
+    // the tail first, and must match again at its end.
+    committed.clear();
+    CHECK(stitch({10, 11, 10, 11}, {10, 11}, 0, committed) == 2);
+    CHECK(committed == text({40, 41}));
+
+    // Tail "a a a", head "a a b": two.
+    committed.clear();
+    CHECK(stitch({10, 10, 10}, {10, 10, 12}, 0, committed) == 2);
+    CHECK(committed == text({12, 40, 41}));
+}
+
+TEST_CASE(resetForgetsPreviousWindow) {
+    TranscriptStitcher stitcher;
+    stitcher.beginWindow(0.0, 0.0);
+    addWords(stitcher, {10, 11}, 200);
+    std::string committed;
+    stitcher.commit(committed);
+    stitcher.reset();
+    stitcher.beginWindow(2.0, 1.0);
+    addWords(stitcher, {10, 11}, 0);
+    committed.clear();
+    CHECK(stitcher.commit(committed) == 0);
+    CHECK(committed == text({10, 11}));
+    double start = 0.0;
+    double end = 0.0;
+    CHECK(stitcher.committedSpan(start, end));
+    CHECK_NEAR(start, 2.0, 1e-9);
+}
+
+int main(int argc, char *argv[]) {
+    return runTests(argc, argv);
+}
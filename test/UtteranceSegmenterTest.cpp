@@ -0,0 +1,184 @@
+// UtteranceSegmenter on synthetic audio: a harmonic tone stands in for
+// voiced speech over a faint noise background. The cases cover short
+// bursts being dropped, long speech being split at its quietest point,
+// short pauses being merged into one utterance, and the silence timeout
+// counting from the last speech frame rather than from the end of the VAD
+// hangover.
+
+#include "TestHarness.hpp"
+
+#include "UtteranceSegmenter.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+static const int kRate = 16000;
+static const size_t kBlock = 160;           // 10 ms, as the capture path delivers it.
+
+static size_t ms(int milliseconds) {
+    return static_cast<size_t>(milliseconds) * kRate / 1000;
+}
+
+// Builds the test signal: background noise at about -66 dBFS, with tones
+// (150 Hz and its harmonics) added where speech is wanted.
+class Signal {
+    public:
+        Signal() : seed_(12345) {}
+
+        void silence(int milliseconds) {
+            add(milliseconds, 0.0f);
+        }
+
+        void speech(int milliseconds, float amplitude = 0.1f) {
+            add(milliseconds, amplitude);
+        }
+
+        size_t size() const {
+            return samples_.size();
+        }
+
+        const std::vector<float> &samples() const {
+            return samples_;
+        }
+    private:
+        void add(int milliseconds, float amplitude) {
+            for (size_t i = 0; i < ms(milliseconds); i++) {
+                seed_ = seed_ * 1664525u + 1013904223u;
+                float noise = (static_cast<float>(seed_ >> 8) / 16777216.0f - 0.5f) * 0.002f;
+                double t = static_cast<double>(samples_.size()) / kRate;
+                double tone = 0.0;
+                for (int harmonic = 1; harmonic <= 5; harmonic++)
+                    tone += std::sin(2.0 * M_PI * 150.0 * harmonic * t) / harmonic;
+                samples_.push_back(noise + amplitude * static_cast<float>(tone) / 2.0f);
+            }
+        }
+
+        uint32_t seed_;
+        std::vector<float> samples_;
+};
+
+struct Result {
+    std::vector<Utterance> utterances;
+    std::vector<size_t> readyAt;            // Samples pushed when each utterance became ready.
+    uint64_t droppedShort = 0;
+};
+
+static Result run(const Signal &signal, const SegmenterConfig &config, const VadConfig &vadConfig = VadConfig()) {
+    UtteranceSegmenter segmenter(config, vadConfig);
+    Result result;
+    Utterance utterance;
+    for (size_t offset = 0; offset < signal.size(); offset += kBlock) {
+        segmenter.push(signal.samples().data() + offset, std::min(kBlock, signal.size() - offset));
+        while (segmenter.pop(utterance)) {
+            result.utterances.push_back(utterance);
+            result.readyAt.push_back(offset + kBlock);
+        }
+    }
+    segmenter.flush();
+    while (segmenter.pop(utterance)) {
+        result.utterances.push_back(utterance);
+        result.readyAt.push_back(signal.size());
+    }
+    result.droppedShort = segmenter.droppedShort();
+    return result;
+}
+
+TEST_CASE(shortBurstIsDropped) {
+    SegmenterConfig config;
+    config.minUtteranceMs = 800;            // Padding and tail make 100 ms of speech about 550 ms long.
+    Signal signal;
+    signal.silence(1000);
+    signal.speech(100);
+    signal.silence(1500);
+    signal.speech(1000);
+    signal.silence(1500);
+
+    Result result = run(signal, config);
+    CHECK(result.droppedShort == 1);
+    CHECK(result.utterances.size() == 1);
+    if (!result.utterances.empty())
+        CHECK(result.utterances[0].start > ms(2600) - ms(config.paddingMs) - ms(50));
+}
+
+TEST_CASE(longSpeechIsSplitAtQuietestPoint) {
+    SegmenterConfig config;
+    config.maxUtteranceMs = 3000;
+    config.splitSearchMs = 1000;
+    Signal signal;
+    signal.silence(1000);
+    signal.speech(2400);                    // The limit falls 2850 ms into the speech...
+    signal.speech(160, 0.03f);              // ...and this dip is inside the search window.
+    signal.speech(2400);
+    signal.silence(1500);
+    const size_t dipStart = ms(1000 + 2400);
+    const size_t dipEnd = dipStart + ms(160);
+
+    Result result = run(signal, config);
+    CHECK(result.utterances.size() == 2);
+    if (result.utterances.size() != 2)
+        return;
+    const Utterance &first = result.utterances[0];
+    const Utterance &second = result.utterances[1];
+    size_t cut = static_cast<size_t>(first.start) + first.samples.size();
+    std::printf("  cut at %.3f s, dip %.3f-%.3f s\n", cut / double(kRate), dipStart / double(kRate),
+                dipEnd / double(kRate));
+    CHECK(first.forced);
+    CHECK(!second.forced);
+    CHECK(cut >= dipStart && cut <= dipEnd);
+    CHECK(second.start == cut);
+    CHECK(first.samples.size() <= ms(config.maxUtteranceMs));
+}
+
+TEST_CASE(shortPausesAreMerged) {
+    SegmenterConfig config;
+    VadConfig vadConfig;
+    vadConfig.hangoverFrames = 5;           // 80 ms, so pauses close the VAD segment.
+    Signal signal;
+    signal.silence(1000);
+    signal.speech(1000);
+    signal.silence(160);                    // Under the 300 ms timeout: merged.
+    signal.speech(1000);
+    signal.silence(700);                    // Over it: a new utterance.
+    signal.speech(1000);
+    signal.silence(1500);
+
+    Result result = run(signal, config, vadConfig);
+    CHECK(result.utterances.size() == 2);
+    if (result.utterances.size() != 2)
+        return;
+    const Utterance &first = result.utterances[0];
+    const Utterance &second = result.utterances[1];
+    size_t firstEnd = static_cast<size_t>(first.start) + first.samples.size();
+    CHECK(first.start + ms(config.paddingMs) <= ms(1000) + ms(vadConfig.frameMs));
+    CHECK(firstEnd >= ms(1000 + 1000 + 160 + 1000));
+    CHECK(firstEnd < ms(1000 + 1000 + 160 + 1000 + 700));
+    CHECK(second.start >= firstEnd && second.start < ms(1000 + 1000 + 160 + 1000 + 700));
+}
+
+// With the default 320 ms hangover, an utterance is ready about one
+// timeout after the speech ends, not a timeout after the hangover.
+TEST_CASE(flushedOneTimeoutAfterSpeech) {
+    SegmenterConfig config;
+    VadConfig vadConfig;
+    Signal signal;
+    signal.silence(1000);
+    signal.speech(1500);
+    signal.silence(2000);
+    const size_t speechEnd = ms(2500);
+
+    Result result = run(signal, config, vadConfig);
+    CHECK(result.utterances.size() == 1);
+    if (result.utterances.empty())
+        return;
+    size_t latency = result.readyAt[0] - speechEnd;
+    size_t frame = ms(vadConfig.frameMs);
+    std::printf("  ready %.0f ms after the speech ended\n", latency * 1000.0 / kRate);
+    CHECK(latency >= ms(config.silenceTimeoutMs));
+    CHECK(latency <= ms(config.silenceTimeoutMs) + 2 * frame + kBlock);
+    CHECK(latency < ms(config.silenceTimeoutMs) + vadConfig.hangoverFrames * frame);
+}
+
+int main(int argc, char *argv[]) {
+    return runTests(argc, argv);
+}
@@ -0,0 +1,123 @@
+// VoiceActivityDetector against the labeled fixtures in test/data/vad
+// (see generate.py there). Every 16 ms frame is scored against the labels:
+// a frame is speech if its centre lies in a labeled region. The smoothed
+// decision must reach the precision and recall below on each file. The
+// hangover deliberately keeps the detector open after each utterance, so
+// frames within one hangover after a labeled end are not scored (the usual
+// collar of VAD evaluations); noise bursts and background still are.
+
+#include "TestHarness.hpp"
+
+#include "Resampler.hpp"
+#include "VoiceActivityDetector.hpp"
+#include "WavReader.hpp"
+
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#ifndef TEST_DATA_DIR
+#define TEST_DATA_DIR "test/data"
+#endif
+
+static const double kMinPrecision = 0.85;
+static const double kMinRecall = 0.88;
+
+struct Fixture {
+    std::vector<float> audio;
+    std::vector<std::pair<double, double>> labels;  // seconds
+};
+
+static bool load(const std::string &name, Fixture &out) {
+    const std::string base = std::string(TEST_DATA_DIR) + "/vad/" + name;
+    WavReader reader;
+    if (!reader.open(base + ".wav") || reader.sampleRate() != 16000) {
+        std::printf("  cannot read %s.wav\n", base.c_str());
+        return false;
+    }
+    Resampler resampler(reader.sampleRate(), 16000, reader.channels());
+    out.audio.resize(resampler.maxOutput(static_cast<size_t>(reader.totalFrames())));
+    out.audio.resize(resampler.process(reader.read(static_cast<size_t>(reader.totalFrames())), out.audio.data()));
+
+    std::ifstream labels(base + ".txt");
+    double start = 0.0;
+    double end = 0.0;
+    while (labels >> start >> end)
+        out.labels.emplace_back(start, end);
+    return !out.labels.empty();
+}
+
+static bool labeled(const Fixture &fixture, double seconds) {
+    for (const auto &label : fixture.labels) {
+        if (seconds >= label.first && seconds < label.second)
+            return true;
+    }
+    return false;
+}
+
+static bool inCollar(const Fixture &fixture, double seconds, double collar) {
+    for (const auto &label : fixture.labels) {
+        if (seconds >= label.second && seconds < label.second + collar)
+            return true;
+    }
+    return false;
+}
+
+static void score(const std::string &name) {
+    Fixture fixture;
+    CHECK(load(name, fixture));
+    if (fixture.audio.empty())
+        return;
+
+    VadConfig config;
+    VoiceActivityDetector vad(config);
+    const double collar = config.hangoverFrames * config.frameMs / 1000.0;
+    std::vector<VadFrame> frames;
+    std::vector<SpeechSegment> segments;
+    frames.reserve(fixture.audio.size() / vad.frameSize() + 1);
+    // 10 ms blocks, as the capture path delivers them.
+    for (size_t offset = 0; offset < fixture.audio.size(); offset += 160)
+        vad.process(fixture.audio.data() + offset, std::min<size_t>(160, fixture.audio.size() - offset), frames,
+                    segments);
+    vad.finish(segments);
+
+    size_t truePositive = 0;
+    size_t falsePositive = 0;
+    size_t falseNegative = 0;
+    for (const VadFrame &frame : frames) {
+        double centre = (static_cast<double>(frame.start) + vad.frameSize() / 2.0) / 16000.0;
+        bool expected = labeled(fixture, centre);
+        if (!expected && inCollar(fixture, centre, collar))
+            continue;
+        truePositive += frame.speech && expected;
+        falsePositive += frame.speech && !expected;
+        falseNegative += !frame.speech && expected;
+    }
+    double precision = truePositive ? static_cast<double>(truePositive) / (truePositive + falsePositive) : 0.0;
+    double recall = truePositive ? static_cast<double>(truePositive) / (truePositive + falseNegative) : 0.0;
+    std::printf("  %-14s %zu frames, %zu segments for %zu labels, precision %.3f, recall %.3f\n", name.c_str(),
+                frames.size(), segments.size(), fixture.labels.size(), precision, recall);
+    CHECK(precision >= kMinPrecision);
+    CHECK(recall >= kMinRecall);
+    CHECK(segments.size() >= fixture.labels.size() / 2 && segments.size() <= fixture.labels.size() * 2);
+}
+
+TEST_CASE(quietRoom) {
+    score("quiet_room");
+}
+
+TEST_CASE(quietSpeaker) {
+    score("quiet_speaker");
+}
+
+TEST_CASE(fanNoise) {
+    score("fan_noise");
+}
+
+TEST_CASE(noiseBursts) {
+    score("noise_bursts");
+}
+
+int main(int argc, char *argv[]) {
+    return runTests(argc, argv);
+}
@@ -0,0 +1,139 @@
+// WhisperSession against the fake whisper.h in FakeWhisper.cpp: the decode
+// parameters are built once per session and restored by prepare(), and
+// once the result buffers have grown to the longest result, decoding and
+// collecting the transcript, segments and tokens allocate nothing.
+
+#include "TestHarness.hpp"
+#include "AllocationCounter.hpp"
+#include "FakeWhisper.hpp"
+
+#include "WhisperSession.hpp"
+
+#include <string>
+#include <vector>
+
+static const int kRate = 16000;
+
+// `words` words of 300 ms from `first` on, 100 ms apart, then a pause long
+// enough to start a new segment and `words` more.
+static std::vector<float> speech(whisper_token first, int words) {
+    std::vector<float> out;
+    for (int segment = 0; segment < 2; segment++) {
+        for (int i = 0; i < words; i++) {
+            out.insert(out.end(), kRate * 3 / 10, fakeWordLevel(first + segment * words + i));
+            out.insert(out.end(), kRate / 10, 0.0f);
+        }
+        out.insert(out.end(), static_cast<size_t>(kFakeSegmentGapMs) * kRate / 1000, 0.0f);
+    }
+    return out;
+}
+
+TEST_CASE(paramsAreBuiltOnce) {
+    int before = fakeDefaultParamsCalls();
+    WhisperSessionConfig config;
+    config.language = "de";
+    config.tokenTimestamps = true;
+    WhisperSession session(fakeWhisperContext(), nullptr, config);
+    CHECK(fakeDefaultParamsCalls() - before == 1);
+
+    std::vector<float> audio = speech(1, 4);
+    for (int i = 0; i < 50; i++) {
+        whisper_full_params &params = session.prepare(1 + i % 4);
+        // Per-call changes, as the overload controller makes them.
+        params.audio_ctx = 768;
+        params.no_timestamps = true;
+        CHECK(session.decode(audio.data(), audio.size()));
+        CHECK(fakeLastParams().n_threads == 1 + i % 4);
+        CHECK(fakeLastParams().audio_ctx == 768);
+    }
+    CHECK(fakeDefaultParamsCalls() - before == 1);
+
+    // prepare() drops them again.
+    whisper_full_params &params = session.prepare(2);
+    CHECK(params.audio_ctx == 0);
+    CHECK(!params.no_timestamps);
+    CHECK(params.token_timestamps);
+    CHECK(std::string(params.language) == "de");
+    CHECK(params.n_threads == 2);
+}
+
+TEST_CASE(collectsSegmentsAndTokens) {
+    WhisperSessionConfig config;
+    config.collectTokens = true;
+    WhisperSession session(fakeWhisperContext(), nullptr, config);
+    std::vector<float> audio = speech(7, 3);
+    session.prepare(1);
+    CHECK(session.decode(audio.data(), audio.size()));
+
+    CHECK(session.text() == " w7 w8 w9 w10 w11 w12");
+    CHECK(session.segments().size() == 2);
+    if (session.segments().size() == 2) {
+        CHECK(session.segments()[0].text == " w7 w8 w9");
+        CHECK(session.segments()[1].text == " w10 w11 w12");
+        CHECK(session.segments()[0].t0 == 0);
+        CHECK(session.segments()[0].t1 == 110);
+        CHECK(session.segments()[1].t0 == 170);
+    }
+    CHECK(session.tokens().size() == 6);
+    if (session.tokens().size() == 6) {
+        CHECK(session.tokens()[3].id == 10);
+        CHECK(session.tokens()[3].t0 == 170);
+        CHECK(session.tokens()[3].t1 == 200);
+        CHECK(std::string(session.tokens()[3].text) == " w10");
+    }
+
+    // A failed decode leaves an empty result.
+    fakeFailDecodes(true);
+    CHECK(!session.decode(audio.data(), audio.size()));
+    fakeFailDecodes(false);
+    CHECK(session.text().empty());
+    CHECK(session.segments().empty());
+    CHECK(session.tokens().empty());
+}
+
+static void steadyState(whisper_state *state) {
+    WhisperSessionConfig config;
+    config.collectTokens = true;
+    config.tokenTimestamps = true;
+    // Deliberately small, so the warm-up has to grow every buffer.
+    config.reserveText = 8;
+    config.reserveSegments = 1;
+    config.reserveTokens = 1;
+    WhisperSession session(fakeWhisperContext(), state, config);
+
+    std::vector<std::vector<float>> inputs;
+    for (int words = 1; words <= 40; words += 3)
+        inputs.push_back(speech(static_cast<whisper_token>(100 * words), words));
+    // Warm up on the longest result.
+    session.prepare(4);
+    CHECK(session.decode(inputs.back().data(), inputs.back().size()));
+
+    size_t tokens = 0;
+    uint64_t before = allocationCount();
+    for (int round = 0; round < 20; round++) {
+        for (const std::vector<float> &input : inputs) {
+            whisper_full_params &params = session.prepare(1 + round % 4);
+            params.audio_ctx = 512;
+            CHECK(session.decode(input.data(), input.size()));
+            tokens += session.tokens().size();
+        }
+    }
+    uint64_t allocations = allocationCount() - before;
+    std::printf("  %zu tokens collected, %llu allocations\n", tokens, static_cast<unsigned long long>(allocations));
+    CHECK(tokens == 20 * 2 * (1 + 4 + 7 + 10 + 13 + 16 + 19 + 22 + 25 + 28 + 31 + 34 + 37 + 40));
+    CHECK(allocations == 0);
+}
+
+TEST_CASE(steadyStateOnContext) {
+    steadyState(nullptr);
+}
+
+TEST_CASE(steadyStateOnState) {
+    whisper_state *state = whisper_init_state(fakeWhisperContext());
+    steadyState(state);
+    whisper_free_state(state);
+}
+
+int main(int argc, char *argv[]) {
+    return runTests(argc, argv);
+}
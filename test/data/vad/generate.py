@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""Generates the labeled VAD fixtures in this directory.
+
+Each fixture is 6 s of 16 kHz mono 16-bit PCM with synthetic speech:
+syllables of a formant-filtered glottal pulse train with a jittered pitch,
+some with a fricative onset, grouped into words and utterances. The
+utterances are mixed into a background that differs per file. The speech
+regions go to <name>.txt, one "start end" pair in seconds per line.
+Distractors (noise bursts) are not labeled.
+
+Only the standard library is used, and the output is deterministic:
+
+    python3 test/data/vad/generate.py
+"""
+
+import math
+import os
+import random
+import struct
+import wave
+
+RATE = 16000
+SECONDS = 6.0
+
+# First three formants (Hz) of a few vowels.
+VOWELS = [(730, 1090, 2440), (270, 2290, 3010), (530, 1840, 2480), (570, 840, 2410), (300, 870, 2240)]
+
+
+def resonator(signal, freq, bandwidth):
+    r = math.exp(-math.pi * bandwidth / RATE)
+    a1 = 2.0 * r * math.cos(2.0 * math.pi * freq / RATE)
+    a2 = -r * r
+    gain = 1.0 - r
+    y1 = y2 = 0.0
+    out = []
+    for x in signal:
+        y = gain * x + a1 * y1 + a2 * y2
+        out.append(y)
+        y2, y1 = y1, y
+    return out
+
+
+def normalise(signal, peak):
+    top = max(abs(x) for x in signal) or 1.0
+    return [x * peak / top for x in signal]
+
+
+def vowel(rng, seconds, f0):
+    n = int(seconds * RATE)
+    pulses = []
+    phase = 0.0
+    for i in range(n):
+        pitch = f0 * (1.0 + 0.08 * math.sin(2.0 * math.pi * 3.0 * i / RATE)) * (1.0 + rng.uniform(-0.01, 0.01))
+        phase += pitch / RATE
+        if phase >= 1.0:
+            phase -= 1.0
+            pulses.append(1.0)
+        else:
+            pulses.append(0.0)
+    signal = pulses
+    for freq, bandwidth in zip(rng.choice(VOWELS), (80, 100, 120)):
+        signal = resonator(signal, freq, bandwidth)
+    envelope = [math.sin(math.pi * i / n) ** 0.5 for i in range(n)]
+    return normalise([s * e for s, e in zip(signal, envelope)], 1.0)
+
+
+def fricative(rng, seconds):
+    n = int(seconds * RATE)
+    noise = [rng.gauss(0.0, 1.0) for _ in range(n)]
+    # Crude high-pass: first difference, twice.
+    noise = [noise[i] - noise[i - 1] if i else 0.0 for i in range(n)]
+    noise = [noise[i] - noise[i - 1] if i else 0.0 for i in range(n)]
+    envelope = [math.sin(math.pi * i / n) for i in range(n)]
+    return normalise([s * e for s, e in zip(noise, envelope)], 0.35)
+
+
+def utterance(rng, f0):
+    """Returns the samples of one utterance of 1-3 words."""
+    out = []
+    for word in range(rng.randint(1, 3)):
+        if word:
+            out += [0.0] * int(rng.uniform(0.08, 0.15) * RATE)
+        for syllable in range(rng.randint(1, 3)):
+            if syllable:
+                out += [0.0] * int(rng.uniform(0.02, 0.06) * RATE)
+            if rng.random() < 0.4:
+                out += fricative(rng, rng.uniform(0.05, 0.1))
+            out += vowel(rng, rng.uniform(0.12, 0.25), f0)
+    return out
+
+
+def white(rng, n, rms):
+    return [rng.gauss(0.0, rms) for _ in range(n)]
+
+
+def fan(rng, n, rms):
+    """Low-pass (brown-ish) noise with a 100 Hz hum."""
+    out = []
+    y = 0.0
+    for i in range(n):
+        y = 0.98 * y + rng.gauss(0.0, 1.0)
+        out.append(y)
+    out = normalise(out, rms * 3.0)
+    return [x + rms * 0.5 * math.sin(2.0 * math.pi * 100.0 * i / RATE) for i, x in enumerate(out)]
+
+
+def db(value):
+    return 10.0 ** (value / 20.0)
+
+
+def build(name, seed, speech_peak_db, background, bursts=0):
+    rng = random.Random(seed)
+    n = int(SECONDS * RATE)
+    mix = background(rng, n)
+    labels = []
+    f0 = rng.uniform(95.0, 210.0)
+    position = rng.uniform(0.6, 0.9)
+    while True:
+        speech = utterance(rng, f0)
+        start = int(position * RATE)
+        if start + len(speech) > n - int(0.4 * RATE):
+            break
+        peak = db(speech_peak_db + rng.uniform(-4.0, 2.0))
+        for i, s in enumerate(speech):
+            mix[start + i] += s * peak
+        labels.append((start / RATE, (start + len(speech)) / RATE))
+        position = (start + len(speech)) / RATE + rng.uniform(0.6, 1.3)
+
+    # Broadband noise bursts in the gaps, not speech.
+    for _ in range(bursts):
+        for _attempt in range(50):
+            length = rng.uniform(0.15, 0.35)
+            at = rng.uniform(0.5, SECONDS - length - 0.1)
+            if all(at + length + 0.4 < s or at > e + 0.4 for s, e in labels):
+                burst = white(rng, int(length * RATE), db(-24.0))
+                k = len(burst)
+                for i, b in enumerate(burst):
+                    mix[int(at * RATE) + i] += b * math.sin(math.pi * i / k)
+                break
+
+    directory = os.path.dirname(os.path.abspath(__file__))
+    with wave.open(os.path.join(directory, name + ".wav"), "wb") as out:
+        out.setnchannels(1)
+        out.setsampwidth(2)
+        out.setframerate(RATE)
+        out.writeframes(b"".join(struct.pack("<h", max(-32768, min(32767, int(round(x * 32767.0))))) for x in mix))
+    with open(os.path.join(directory, name + ".txt"), "w") as out:
+        for start, end in labels:
+            out.write("%.3f %.3f\n" % (start, end))
+
+
+if __name__ == "__main__":
+    build("quiet_room", 1, -10.0, lambda rng, n: white(rng, n, db(-62.0)))
+    build("quiet_speaker", 2, -30.0, lambda rng, n: white(rng, n, db(-62.0)))
+    build("fan_noise", 3, -12.0, lambda rng, n: fan(rng, n, db(-42.0)))
+    build("noise_bursts", 4, -12.0, lambda rng, n: white(rng, n, db(-56.0)), bursts=3)